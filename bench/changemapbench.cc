@@ -0,0 +1,100 @@
+/** @file changemapbench.cc
+ * Microbenchmark of the change map. Builds a series of images, each one a copy of its predecessor
+ * with some bytes modified, and reports the time needed to accumulate the change counts of the
+ * entire series using every kernel supported by the CPU. */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <cstring>
+
+#include "changemap.hh"
+#include "image.hh"
+#include "devicestatistics.hh"
+
+
+int
+main(int argc, char *argv[])
+{
+  QTextStream out(stdout);
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("anytone-emu-changemapbench");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+        "Change map benchmark. Reports the time needed to count the changes across a series of "
+        "images.");
+  parser.addHelpOption();
+  parser.addOption({"images", "Number of images. Default: 100.", "n", "100"});
+  parser.addOption({"size", "Size of each image in bytes. Default: 1048576.",
+                    "bytes", "1048576"});
+  parser.addOption({"changes", "Number of bytes modified per image. Default: 1000.",
+                    "n", "1000"});
+  parser.process(app);
+
+  unsigned int count = std::max(2u, parser.value("images").toUInt());
+  qsizetype size = std::max(qsizetype(1), qsizetype(parser.value("size").toLongLong()));
+  unsigned int changes = parser.value("changes").toUInt();
+
+  // Like received images, the unmodified pages are shared by the collection
+  Collection collection;
+  QByteArray content(size, '\0');
+  QRandomGenerator rng(1);
+  rng.fillRange((quint32 *)content.data(), content.size()/sizeof(quint32));
+  for (unsigned int i=0; i<count; i++) {
+    for (unsigned int c=0; (i>0) && (c<changes); c++)
+      content[rng.bounded(int(size))] = char(rng.generate());
+    Image *image = new Image(QString("Image %1").arg(i));
+    image->append(0, content);
+    collection.append(image);
+  }
+
+  out << "Selected kernel: " << ChangeMap::kernelName(ChangeMap::kernel()) << "\n";
+
+  // Series, using the selected kernel
+  int64_t start = DeviceStatistics::now();
+  ChangeMap map(&collection);
+  int64_t time = DeviceStatistics::now() - start;
+  out << "  " << count << " x " << size << " bytes: " << QString::number(double(time)/1e6, 'f', 3)
+      << " ms, " << map.changedBytes() << " bytes changed, max. count " << map.maxCount() << "\n";
+
+  // Kernels on the raw content of the first and last image
+  const Image *first = collection.image(0), *last = collection.image(count-1);
+  QByteArray left(size, '\0'), right(size, '\0');
+  for (unsigned int p=0; p<first->element(0)->pageCount(); p++) {
+    QByteArrayView a = first->element(0)->page(p), b = last->element(0)->page(p);
+    std::memcpy(left.data() + p*Element::PageSize, a.data(), a.size());
+    std::memcpy(right.data() + p*Element::PageSize, b.data(), b.size());
+  }
+
+  bool ok = true;
+  QVector<uint16_t> expected(size, 0);
+  ChangeMap::accumulate(left.constData(), right.constData(), size, expected.data(),
+                        ChangeMap::Kernel::Scalar);
+  // Each kernel compares the same content count-1 times, counters saturate
+  for (uint16_t &c: expected)
+    c = c ? uint16_t(std::min(count-1, 0xffffu)) : 0;
+  const ChangeMap::Kernel kernels[] = {
+    ChangeMap::Kernel::Scalar, ChangeMap::Kernel::SSE2, ChangeMap::Kernel::AVX2 };
+  for (auto kernel: kernels) {
+    if (! ChangeMap::supported(kernel))
+      continue;
+    QVector<uint16_t> counters(size, 0);
+    start = DeviceStatistics::now();
+    for (unsigned int i=1; i<count; i++)
+      ChangeMap::accumulate(left.constData(), right.constData(), size, counters.data(), kernel);
+    time = DeviceStatistics::now() - start;
+    if (counters != expected) {
+      out << "  " << ChangeMap::kernelName(kernel) << ": result mismatch!\n";
+      ok = false;
+      continue;
+    }
+    out << "  " << qSetFieldWidth(8) << Qt::left << ChangeMap::kernelName(kernel)
+        << qSetFieldWidth(0) << Qt::right << " "
+        << QString::number(double(size)*(count-1)/std::max(time, int64_t(1)), 'f', 3)
+        << " GB/s\n";
+  }
+
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,91 @@
+/** @file checksumbench.cc
+ * Microbenchmark of the checksum kernels. Sums typical protocol frames with every kernel supported
+ * by the CPU, verifies the results against the scalar kernel and reports the throughput. */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "checksum.hh"
+#include "devicestatistics.hh"
+
+
+/** Runs the given kernel over @c buffer in frames of @c frame bytes. Returns the duration in ns. */
+template <class Func>
+static int64_t
+run(Func func, const QByteArray &buffer, qsizetype frame, unsigned int rounds, uint8_t &result) {
+  qsizetype frames = buffer.size()/frame;
+  uint8_t acc = 0;
+  int64_t start = DeviceStatistics::now();
+  for (unsigned int r=0; r<rounds; r++)
+    for (qsizetype i=0; i<frames; i++)
+      acc += func(buffer.constData() + i*frame, frame);
+  result = acc;
+  return DeviceStatistics::now() - start;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QTextStream out(stdout);
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("anytone-emu-checksumbench");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+        "Checksum kernel benchmark. Reports the throughput of the sum and XOR kernels for "
+        "typical frame sizes.");
+  parser.addHelpOption();
+  parser.addOption({"frames", "Comma separated list of frame sizes in bytes. "
+                    "Default: '21,1027,4096'.", "bytes", "21,1027,4096"});
+  parser.addOption({"size", "Amount of data per round in bytes. Default: 1048576.",
+                    "bytes", "1048576"});
+  parser.addOption({"rounds", "Number of rounds. Default: 100.", "n", "100"});
+  parser.process(app);
+
+  qsizetype size = std::max(qsizetype(1), qsizetype(parser.value("size").toLongLong()));
+  unsigned int rounds = std::max(1u, parser.value("rounds").toUInt());
+
+  QByteArray buffer(size + 3, '\0');
+  QRandomGenerator rng(1);
+  rng.fillRange((quint32 *)buffer.data(), buffer.size()/sizeof(quint32));
+
+  out << "Selected kernel: " << Checksum::kernelName(Checksum::kernel()) << "\n";
+
+  bool ok = true;
+  const Checksum::Kernel kernels[] = {
+    Checksum::Kernel::Scalar, Checksum::Kernel::SSE2, Checksum::Kernel::AVX2 };
+  for (const QString &f: parser.value("frames").split(',', Qt::SkipEmptyParts)) {
+    qsizetype frame = std::max(qsizetype(1), std::min(size, qsizetype(f.toLongLong())));
+    qsizetype bytes = (size/frame)*frame*rounds;
+    out << "Frame size " << frame << " bytes:\n";
+
+    uint8_t sumRef = 0, xorRef = 0;
+    for (auto kernel: kernels) {
+      if (! Checksum::supported(kernel))
+        continue;
+      uint8_t sumRes, xorRes;
+      int64_t sumTime = run([kernel](const char *d, qsizetype n) {
+        return Checksum::sum8(d, n, kernel); }, buffer, frame, rounds, sumRes);
+      int64_t xorTime = run([kernel](const char *d, qsizetype n) {
+        return Checksum::xor8(d, n, kernel); }, buffer, frame, rounds, xorRes);
+      if (Checksum::Kernel::Scalar == kernel) {
+        sumRef = sumRes; xorRef = xorRes;
+      } else if ((sumRef != sumRes) || (xorRef != xorRes)) {
+        out << "  " << Checksum::kernelName(kernel) << ": result mismatch!\n";
+        ok = false;
+        continue;
+      }
+      out << "  " << qSetFieldWidth(8) << Qt::left << Checksum::kernelName(kernel)
+          << qSetFieldWidth(0) << Qt::right
+          << " sum " << QString::number(double(bytes)/std::max(sumTime, int64_t(1))*1e3, 'f', 1)
+          << " MB/s, xor "
+          << QString::number(double(bytes)/std::max(xorTime, int64_t(1))*1e3, 'f', 1)
+          << " MB/s\n";
+    }
+  }
+
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,265 @@
+#include "cpsdriver.hh"
+#include "device.hh"
+#include "checksum.hh"
+#include <QtEndian>
+
+
+/* ********************************************************************************************* *
+ * Implementation of CpsFrame
+ * ********************************************************************************************* */
+bool
+CpsFrame::complete(const QByteArray &bytes) const {
+  if (bytes.size() < response)
+    return false;
+  if (terminator < 0)
+    return true;
+  return bytes.size() && (uint8_t(bytes.back()) == terminator);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of CpsDriver
+ * ********************************************************************************************* */
+CpsDriver::CpsDriver()
+{
+  // pass...
+}
+
+CpsDriver::~CpsDriver() {
+  // pass...
+}
+
+bool
+CpsDriver::fixedFrameSize() const {
+  return false;
+}
+
+uint32_t
+CpsDriver::baseAddress() const {
+  return 0;
+}
+
+CpsDriver *
+CpsDriver::forDevice(const Device *device) {
+  if (device->inherits("AnyToneDevice"))
+    return new AnytoneCpsDriver();
+  if (device->inherits("MD32UVDevice"))
+    return new MD32UVCpsDriver();
+  if (device->inherits("OpenGD77Device"))
+    return new OpenGD77CpsDriver();
+  if (device->inherits("RadtelDevice"))
+    return new RadtelCpsDriver();
+  return nullptr;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of AnytoneCpsDriver
+ * ********************************************************************************************* */
+const char *
+AnytoneCpsDriver::name() const {
+  return "AnyTone";
+}
+
+qsizetype
+AnytoneCpsDriver::defaultFrameSize() const {
+  return 16;
+}
+
+qsizetype
+AnytoneCpsDriver::maxFrameSize() const {
+  return 255;
+}
+
+uint32_t
+AnytoneCpsDriver::baseAddress() const {
+  return 0x02000000;
+}
+
+void
+AnytoneCpsDriver::begin(QVector<CpsFrame> &frames) const {
+  frames.append({"PROGRAM", 3});
+  // Device info, response has a variable length but ends with ACK.
+  frames.append({"\x02", 4, 0x06});
+}
+
+void
+AnytoneCpsDriver::write(uint32_t address, const char *data, qsizetype len,
+                        QVector<CpsFrame> &frames) const
+{
+  QByteArray request;
+  request.reserve(len+8);
+  request.append('W');
+  uint32_t addr = qToBigEndian(address);
+  request.append((const char *)&addr, 4);
+  request.append(char(len));
+  request.append(data, len);
+  request.append(char(Checksum::sum8(request.constData()+1, request.size()-1)));
+  request.append('\x06');
+  frames.append({request, 1});
+}
+
+void
+AnytoneCpsDriver::end(QVector<CpsFrame> &frames) const {
+  frames.append({"END", 1});
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of MD32UVCpsDriver
+ * ********************************************************************************************* */
+const char *
+MD32UVCpsDriver::name() const {
+  return "MD-32UV";
+}
+
+qsizetype
+MD32UVCpsDriver::defaultFrameSize() const {
+  return 1024;
+}
+
+qsizetype
+MD32UVCpsDriver::maxFrameSize() const {
+  return 0xffff;
+}
+
+void
+MD32UVCpsDriver::begin(QVector<CpsFrame> &frames) const {
+  frames.append({"PSEARCH", 8});
+  frames.append({"PASSSTA", 3});
+  frames.append({"PROGRAM", 1});
+}
+
+void
+MD32UVCpsDriver::write(uint32_t address, const char *data, qsizetype len,
+                       QVector<CpsFrame> &frames) const
+{
+  QByteArray request;
+  request.reserve(len+6);
+  request.append('W');
+  request.append(char(0xff & (address >>  0)));
+  request.append(char(0xff & (address >>  8)));
+  request.append(char(0xff & (address >> 16)));
+  uint16_t length = qToLittleEndian(uint16_t(len));
+  request.append((const char *)&length, 2);
+  request.append(data, len);
+  frames.append({request, 1});
+}
+
+void
+MD32UVCpsDriver::end(QVector<CpsFrame> &frames) const {
+  Q_UNUSED(frames);
+  // The device detects the end of the programming by a timeout.
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of OpenGD77CpsDriver
+ * ********************************************************************************************* */
+const char *
+OpenGD77CpsDriver::name() const {
+  return "OpenGD77";
+}
+
+qsizetype
+OpenGD77CpsDriver::defaultFrameSize() const {
+  return 32;
+}
+
+qsizetype
+OpenGD77CpsDriver::maxFrameSize() const {
+  return 0xffff;
+}
+
+void
+OpenGD77CpsDriver::begin(QVector<CpsFrame> &frames) const {
+  // Show CPS screen
+  frames.append({QByteArray("C\x00", 2), 1});
+}
+
+void
+OpenGD77CpsDriver::write(uint32_t address, const char *data, qsizetype len,
+                         QVector<CpsFrame> &frames) const
+{
+  QByteArray request;
+  request.reserve(len+8);
+  request.append('W');
+  request.append('\x04'); // EEPROM
+  uint32_t addr = qToBigEndian(address);
+  request.append((const char *)&addr, 4);
+  uint16_t length = qToBigEndian(uint16_t(len));
+  request.append((const char *)&length, 2);
+  request.append(data, len);
+  frames.append({request, 2});
+}
+
+void
+OpenGD77CpsDriver::end(QVector<CpsFrame> &frames) const {
+  // Save settings
+  frames.append({QByteArray("C\x06\x00", 3), 1});
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of RadtelCpsDriver
+ * ********************************************************************************************* */
+const char *
+RadtelCpsDriver::name() const {
+  return "Radtel";
+}
+
+qsizetype
+RadtelCpsDriver::defaultFrameSize() const {
+  return 1024;
+}
+
+qsizetype
+RadtelCpsDriver::maxFrameSize() const {
+  return 1024;
+}
+
+bool
+RadtelCpsDriver::fixedFrameSize() const {
+  return true;
+}
+
+uint32_t
+RadtelCpsDriver::baseAddress() const {
+  // Segment 9 maps linearly.
+  return 0x09000000;
+}
+
+static QByteArray
+radtelCommand(uint8_t f1, uint8_t f2) {
+  QByteArray request("\x34\x52", 2);
+  request.append(char(f1));
+  request.append(char(f2));
+  request.append(char(Checksum::sum8(request.constData(), request.size())));
+  return request;
+}
+
+void
+RadtelCpsDriver::begin(QVector<CpsFrame> &frames) const {
+  frames.append({radtelCommand(0x05, 0x10), 1});
+}
+
+void
+RadtelCpsDriver::write(uint32_t address, const char *data, qsizetype len,
+                       QVector<CpsFrame> &frames) const
+{
+  uint16_t page = qToBigEndian(uint16_t((address - baseAddress()) >> 10));
+  QByteArray request;
+  request.reserve(1028);
+  request.append(char(0x90 | ((address >> 24) & 0x0f)));
+  request.append((const char *)&page, 2);
+  request.append(data, len);
+  if (len < 1024)
+    request.append(1024-len, '\xff');
+  request.append(char(Checksum::sum8(request.constData(), request.size())));
+  frames.append({request, 1});
+}
+
+void
+RadtelCpsDriver::end(QVector<CpsFrame> &frames) const {
+  frames.append({radtelCommand(0x05, 0xee), 1});
+}
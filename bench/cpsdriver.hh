@@ -0,0 +1,119 @@
+#ifndef CPSDRIVER_HH
+#define CPSDRIVER_HH
+
+#include <QByteArray>
+#include <QVector>
+
+class Device;
+
+
+/** A single request of the CPS and the expected response. */
+struct CpsFrame
+{
+  /** The request. */
+  QByteArray request;
+  /** The minimum size of the response. */
+  qsizetype response;
+  /** If non-negative, the response ends with this byte. */
+  int terminator = -1;
+
+  /** Returns @c true if the given bytes form a complete response. */
+  bool complete(const QByteArray &bytes) const;
+};
+
+
+/** Generates the requests a manufacturer CPS would send to write a codeplug.
+ *
+ * Each protocol plugin has its own driver. The codeplug is written in chunks of the frame
+ * size to addresses relative to the base address of the driver. */
+class CpsDriver
+{
+protected:
+  /** Hidden constructor. */
+  CpsDriver();
+
+public:
+  /** Destructor. */
+  virtual ~CpsDriver();
+
+  /** Returns the name of the protocol. */
+  virtual const char *name() const = 0;
+  /** Returns the default frame size. */
+  virtual qsizetype defaultFrameSize() const = 0;
+  /** Returns the maximum frame size supported by the protocol. */
+  virtual qsizetype maxFrameSize() const = 0;
+  /** Returns @c true if the protocol only supports frames of exactly the maximum size. */
+  virtual bool fixedFrameSize() const;
+  /** Returns the first address to write to. */
+  virtual uint32_t baseAddress() const;
+
+  /** Appends the requests to enter the programming mode. */
+  virtual void begin(QVector<CpsFrame> &frames) const = 0;
+  /** Appends the requests to write the given data to the specified address. */
+  virtual void write(uint32_t address, const char *data, qsizetype len,
+                     QVector<CpsFrame> &frames) const = 0;
+  /** Appends the requests to leave the programming mode. */
+  virtual void end(QVector<CpsFrame> &frames) const = 0;
+
+  /** Creates a driver matching the protocol of the given device.
+   * Returns @c nullptr if there is none. */
+  static CpsDriver *forDevice(const Device *device);
+};
+
+
+/** Drives AnyTone devices: @c PROGRAM, device info, @c W frames, @c END. */
+class AnytoneCpsDriver: public CpsDriver
+{
+public:
+  const char *name() const override;
+  qsizetype defaultFrameSize() const override;
+  qsizetype maxFrameSize() const override;
+  uint32_t baseAddress() const override;
+  void begin(QVector<CpsFrame> &frames) const override;
+  void write(uint32_t address, const char *data, qsizetype len, QVector<CpsFrame> &frames) const override;
+  void end(QVector<CpsFrame> &frames) const override;
+};
+
+
+/** Drives MD-32UV devices: @c PSEARCH, @c PASSSTA, @c PROGRAM, @c W frames. The end of the
+ * programming is detected by the device through a timeout. */
+class MD32UVCpsDriver: public CpsDriver
+{
+public:
+  const char *name() const override;
+  qsizetype defaultFrameSize() const override;
+  qsizetype maxFrameSize() const override;
+  void begin(QVector<CpsFrame> &frames) const override;
+  void write(uint32_t address, const char *data, qsizetype len, QVector<CpsFrame> &frames) const override;
+  void end(QVector<CpsFrame> &frames) const override;
+};
+
+
+/** Drives OpenGD77 devices: Show CPS screen, EEPROM writes, save settings. */
+class OpenGD77CpsDriver: public CpsDriver
+{
+public:
+  const char *name() const override;
+  qsizetype defaultFrameSize() const override;
+  qsizetype maxFrameSize() const override;
+  void begin(QVector<CpsFrame> &frames) const override;
+  void write(uint32_t address, const char *data, qsizetype len, QVector<CpsFrame> &frames) const override;
+  void end(QVector<CpsFrame> &frames) const override;
+};
+
+
+/** Drives Radtel devices: Enter programming mode, 1k page writes, leave programming mode. */
+class RadtelCpsDriver: public CpsDriver
+{
+public:
+  const char *name() const override;
+  qsizetype defaultFrameSize() const override;
+  qsizetype maxFrameSize() const override;
+  bool fixedFrameSize() const override;
+  uint32_t baseAddress() const override;
+  void begin(QVector<CpsFrame> &frames) const override;
+  void write(uint32_t address, const char *data, qsizetype len, QVector<CpsFrame> &frames) const override;
+  void end(QVector<CpsFrame> &frames) const override;
+};
+
+#endif // CPSDRIVER_HH
@@ -0,0 +1,112 @@
+/** @file hexformatbench.cc
+ * Microbenchmark of the hex formatting kernels. Formats random lines of 16 bytes using the former
+ * per-value @c QString::arg formatting and every kernel supported by the CPU, verifies the results
+ * and reports the number of lines formatted per second. */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "hexformat.hh"
+#include "devicestatistics.hh"
+
+
+/** Formats a line like the hex documents and dumps did before, one value at a time. */
+static QString
+formatArg(const uint8_t *bytes) {
+  QString line;
+  for (int i=0; i<HexFormat::LineSize; i++)
+    line.append(QString("%1 ").arg(bytes[i], 2, 16, QChar('0')));
+  for (int i=0; i<HexFormat::LineSize; i++) {
+    if (HexFormat::printable(bytes[i]))
+      line.append(QString("%1").arg((char)bytes[i]));
+    else
+      line.append(".");
+  }
+  return line;
+}
+
+/** Runs the given formatter over all lines in @c buffer. Returns the duration in ns. */
+template <class Func>
+static int64_t
+run(Func func, const QByteArray &buffer, unsigned int rounds) {
+  qsizetype lines = buffer.size()/HexFormat::LineSize;
+  int64_t start = DeviceStatistics::now();
+  for (unsigned int r=0; r<rounds; r++)
+    for (qsizetype i=0; i<lines; i++)
+      func((const uint8_t *)buffer.constData() + i*HexFormat::LineSize);
+  return DeviceStatistics::now() - start;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QTextStream out(stdout);
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("anytone-emu-hexformatbench");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+        "Hex formatting benchmark. Reports the number of formatted lines per second for the "
+        "QString::arg based formatting and the formatting kernels.");
+  parser.addHelpOption();
+  parser.addOption({"size", "Amount of data per round in bytes. Default: 1048576.",
+                    "bytes", "1048576"});
+  parser.addOption({"rounds", "Number of rounds. Default: 10.", "n", "10"});
+  parser.process(app);
+
+  qsizetype size = std::max(qsizetype(HexFormat::LineSize),
+                            qsizetype(parser.value("size").toLongLong()));
+  unsigned int rounds = std::max(1u, parser.value("rounds").toUInt());
+
+  QByteArray buffer((size/HexFormat::LineSize)*HexFormat::LineSize, '\0');
+  QRandomGenerator rng(1);
+  rng.fillRange((quint32 *)buffer.data(), buffer.size()/sizeof(quint32));
+  qsizetype lines = (buffer.size()/HexFormat::LineSize)*rounds;
+
+  out << "Selected kernel: " << HexFormat::kernelName(HexFormat::kernel()) << "\n";
+
+  // Reference, one QString per value
+  qsizetype total = 0;
+  int64_t argTime = run([&total](const uint8_t *bytes) {
+    total += formatArg(bytes).size(); }, buffer, rounds);
+  out << "  " << qSetFieldWidth(8) << Qt::left << "arg" << qSetFieldWidth(0) << Qt::right
+      << " " << QString::number(double(lines)/std::max(argTime, int64_t(1))*1e3, 'f', 3)
+      << " Mlines/s\n";
+
+  bool ok = true;
+  const HexFormat::Kernel kernels[] = {
+    HexFormat::Kernel::Scalar, HexFormat::Kernel::SSSE3, HexFormat::Kernel::AVX2 };
+  for (auto kernel: kernels) {
+    if (! HexFormat::supported(kernel))
+      continue;
+    // Verify against the reference
+    for (qsizetype i=0; i<buffer.size(); i+=HexFormat::LineSize) {
+      const uint8_t *bytes = (const uint8_t *)buffer.constData() + i;
+      char text[HexFormat::ValuesLength + HexFormat::CharsLength];
+      HexFormat::formatLine(bytes, text, text + HexFormat::ValuesLength, '.', kernel);
+      if (formatArg(bytes) != QLatin1String(text, sizeof(text))) {
+        ok = false;
+        break;
+      }
+    }
+    if (! ok) {
+      out << "  " << HexFormat::kernelName(kernel) << ": result mismatch!\n";
+      continue;
+    }
+
+    char text[HexFormat::ValuesLength + HexFormat::CharsLength];
+    int64_t time = run([&text, kernel](const uint8_t *bytes) {
+      HexFormat::formatLine(bytes, text, text + HexFormat::ValuesLength, '.', kernel);
+    }, buffer, rounds);
+    out << "  " << qSetFieldWidth(8) << Qt::left << HexFormat::kernelName(kernel)
+        << qSetFieldWidth(0) << Qt::right
+        << " " << QString::number(double(lines)/std::max(time, int64_t(1))*1e3, 'f', 3)
+        << " Mlines/s, " << QString::number(double(argTime)/std::max(time, int64_t(1)), 'f', 1)
+        << "x\n";
+  }
+
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,82 @@
+/** @file imagebench.cc
+ * Image append benchmark. Replays a synthetic write trace, as received from the CPS, into an
+ * image and reports the time spent per frame. */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <algorithm>
+#include <limits>
+
+#include "image.hh"
+#include "devicestatistics.hh"
+
+
+int
+main(int argc, char *argv[])
+{
+  QTextStream out(stdout);
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("anytone-emu-imagebench");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+        "Image append benchmark. Replays a write trace into an image and reports the time "
+        "spent per frame.");
+  parser.addHelpOption();
+  parser.addOption({"frames", "Number of write frames. Default: 100000.", "n", "100000"});
+  parser.addOption({"frame", "Payload size of each frame. Default: 16.", "bytes", "16"});
+  parser.addOption({"pattern", "Write order, one of 'sequential', 'sparse' or 'random'. "
+                    "Default: 'sequential'.", "pattern", "sequential"});
+  parser.addOption({"rounds", "Number of images to write. Default: 5.", "n", "5"});
+  parser.process(app);
+
+  unsigned int frames = std::max(1u, parser.value("frames").toUInt());
+  uint32_t frame = std::max(1u, parser.value("frame").toUInt());
+  unsigned int rounds = std::max(1u, parser.value("rounds").toUInt());
+  QString pattern = parser.value("pattern");
+
+  // Generate trace: sequential writes, sparse writes leave a gap after every 256 frames and
+  // random writes shuffle the sequential trace.
+  QVector<uint32_t> addresses;
+  addresses.reserve(frames);
+  for (unsigned int i=0; i<frames; i++) {
+    uint32_t address = i*frame;
+    if ("sparse" == pattern)
+      address += (i/256)*frame;
+    addresses.append(address);
+  }
+  if ("random" == pattern) {
+    QRandomGenerator rng(1);
+    std::shuffle(addresses.begin(), addresses.end(), rng);
+  }
+  QByteArray payload(frame, '\xaa');
+
+  out << "Trace: " << frames << " frames of " << frame << " bytes, " << pattern << " order\n";
+
+  int64_t best = std::numeric_limits<int64_t>::max();
+  unsigned int elements = 0;
+  for (unsigned int round=0; round<rounds; round++) {
+    Image image;
+    int64_t start = DeviceStatistics::now();
+    for (uint32_t address: addresses)
+      image.append(address, payload);
+    int64_t duration = DeviceStatistics::now() - start;
+    // Include flattening of the element storage
+    start = DeviceStatistics::now();
+    for (const Element *el: image)
+      el->data();
+    duration += DeviceStatistics::now() - start;
+    best = std::min(best, duration);
+    elements = image.count();
+  }
+
+  out << "Elements: " << elements << "\n"
+      << "Best of " << rounds << ": " << QString::number(double(best)/1e6, 'f', 3) << " ms, "
+      << QString::number(double(best)/frames, 'f', 1) << " ns/frame, "
+      << QString::number(double(frames)*frame/std::max(best, int64_t(1))*1e3, 'f', 1)
+      << " MB/s\n";
+
+  return 0;
+}
@@ -0,0 +1,369 @@
+/** @file loadgen.cc
+ * Synthetic CPS load generator. Writes generated codeplugs to an emulated device, either through
+ * an in-memory pipe or a PTY, reports the sustained throughput and verifies the received image. */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QXmlStreamReader>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QEventLoop>
+#include <QTimer>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+#include "logger.hh"
+#include "model.hh"
+#include "image.hh"
+#include "device.hh"
+#include "modeldefinition.hh"
+#include "modelparser.hh"
+#include "sessionreplay.hh"
+#include "devicestatistics.hh"
+#include "emulationthread.hh"
+#include "pseudoterminal.hh"
+#include "cpsdriver.hh"
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+
+/** A chunk of the generated codeplug. */
+struct Chunk {
+  /** Target address. */
+  uint32_t address;
+  /** Offset into the generated data. */
+  qsizetype offset;
+  /** Size of the chunk. */
+  qsizetype size;
+};
+
+
+static QVector<Chunk>
+generateChunks(const QString &pattern, uint32_t base, qsizetype size, qsizetype frame,
+               QRandomGenerator &rng)
+{
+  QVector<Chunk> chunks;
+  // Sparse: blocks of ~4k, separated by gaps of the same size.
+  qsizetype block = frame * std::max(qsizetype(1), qsizetype(4096)/frame);
+  for (qsizetype offset=0; offset<size; offset+=frame) {
+    uint32_t address = base + offset;
+    if ("sparse" == pattern)
+      address = base + (offset/block)*2*block + (offset%block);
+    chunks.append({address, offset, std::min(frame, size-offset)});
+  }
+  if ("random" == pattern)
+    std::shuffle(chunks.begin(), chunks.end(), rng);
+  return chunks;
+}
+
+
+static bool
+verify(const Image *image, const QVector<Chunk> &chunks, const QByteArray &data) {
+  if (nullptr == image) {
+    logError() << "No image received.";
+    return false;
+  }
+  for (const auto &chunk: chunks) {
+    Element *el = image->find(Address::fromByte(chunk.address));
+    if ((nullptr == el) || (! el->contains(chunk.address, chunk.size))) {
+      logError() << "Chunk at " << Qt::hex << chunk.address << "h not found in image.";
+      return false;
+    }
+    if (0 != std::memcmp(el->data(chunk.address), data.constData()+chunk.offset, chunk.size)) {
+      logError() << "Chunk at " << Qt::hex << chunk.address << "h differs.";
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/** Runs all frames through an in-memory interface. Returns the number of response bytes. */
+static qint64
+runPipe(ReplayInterface *interface, const QVector<CpsFrame> &frames, bool &ok) {
+  qint64 received = 0;
+  ok = true;
+  for (const auto &frame: frames) {
+    interface->feed(frame.request);
+    QByteArray response = interface->take();
+    received += response.size();
+    if (! frame.complete(response)) {
+      logError() << "Incomplete response to " << frame.request.left(8).toHex(' ') << ": "
+                 << response.toHex(' ') << ".";
+      ok = false;
+      return received;
+    }
+  }
+  return received;
+}
+
+
+#ifdef Q_OS_UNIX
+/** Runs all frames through a PTY. Returns the number of response bytes. */
+static qint64
+runPty(int fd, const QVector<CpsFrame> &frames, bool &ok) {
+  qint64 received = 0;
+  QByteArray response; response.reserve(0x10000);
+  ok = true;
+  for (const auto &frame: frames) {
+    const char *ptr = frame.request.constData();
+    qsizetype left = frame.request.size();
+    while (left) {
+      ssize_t n = ::write(fd, ptr, left);
+      if ((n < 0) && (EAGAIN == errno)) {
+        struct pollfd pfd = {fd, POLLOUT, 0};
+        ::poll(&pfd, 1, 1000);
+        continue;
+      } else if (n < 0) {
+        logError() << "Cannot write to PTY: " << strerror(errno) << ".";
+        ok = false;
+        return received;
+      }
+      ptr += n; left -= n;
+    }
+
+    response.resize(0);
+    while (! frame.complete(response)) {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      if (0 >= ::poll(&pfd, 1, 1000)) {
+        logError() << "Timeout waiting for response to " << frame.request.left(8).toHex(' ')
+                   << ", got " << response.toHex(' ') << ".";
+        ok = false;
+        return received;
+      }
+      char buffer[4096];
+      ssize_t n = ::read(fd, buffer, sizeof(buffer));
+      if (n > 0)
+        response.append(buffer, n);
+    }
+    received += response.size();
+  }
+  return received;
+}
+
+static int
+openPty(const QString &path) {
+  int fd = ::open(QFileInfo(path).canonicalFilePath().toLocal8Bit().constData(),
+                  O_RDWR|O_NOCTTY|O_NONBLOCK);
+  if (fd < 0)
+    return -1;
+  struct termios tio;
+  ::tcgetattr(fd, &tio);
+  ::cfmakeraw(&tio);
+  ::tcsetattr(fd, TCSANOW, &tio);
+  return fd;
+}
+#endif
+
+
+/** Waits for the given image collector to receive the given number of images. */
+static bool
+waitForImages(ImageCollector *handler, unsigned int count, int timeout) {
+  if (handler->count() >= count)
+    return true;
+  QEventLoop loop;
+  QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+  QObject::connect(handler, &ImageCollector::imageReceived, &loop, [&loop, handler, count]() {
+    if (handler->count() >= count)
+      loop.quit();
+  }, Qt::QueuedConnection);
+  loop.exec();
+  return handler->count() >= count;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QTextStream err(stderr), out(stdout);
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("anytone-emu-loadgen");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+        "Synthetic CPS load generator. Writes generated codeplugs to an emulated device and "
+        "reports the sustained throughput.");
+  parser.addHelpOption();
+  parser.addOption({"loglevel", "Sets the log-level. Default: 'warning'.", "loglevel", "warning"});
+  parser.addOption({"firmware", "Firmware version to emulate. Default: latest.", "firmware"});
+  parser.addOption({"size", "Size of the generated codeplug in bytes. Default: 1048576.",
+                    "bytes", "1048576"});
+  parser.addOption({"frame", "Payload size of each write request. Default: protocol specific.",
+                    "bytes"});
+  parser.addOption({"pattern", "Access pattern, one of 'sequential', 'random' or 'sparse'. "
+                    "Default: 'sequential'.", "pattern", "sequential"});
+  parser.addOption({"rounds", "Number of codeplugs to write. Default: 1.", "n", "1"});
+  parser.addOption({"seed", "Seed of the random generator. Default: 1.", "seed", "1"});
+  parser.addOption({"pty", "Use a PTY pair instead of an in-memory pipe. The device is run on "
+                    "its own thread."});
+  parser.addPositionalArgument("catalog", "Specifies the catalog file to use.");
+  parser.addPositionalArgument("device", "Specifies the device to emulate.");
+  parser.process(app);
+
+  if ("debug" == parser.value("loglevel"))
+    Logger::get().addHandler(new StreamLogHandler(err, LogMessage::DEBUG, true));
+  else if ("info" == parser.value("loglevel"))
+    Logger::get().addHandler(new StreamLogHandler(err, LogMessage::INFO, true));
+  else
+    Logger::get().addHandler(new StreamLogHandler(err, LogMessage::WARNING, true));
+
+  if (2 > parser.positionalArguments().size())
+    parser.showHelp(-1);
+
+  ModelCatalog catalog;
+  ModelDefinitionParser modelParser(&catalog);
+  QFile catalogFile(parser.positionalArguments().at(0));
+  if (! catalogFile.open(QIODevice::ReadOnly)) {
+    logError() << "Cannot open catalog file '" << catalogFile.fileName()
+               << "': " << catalogFile.errorString() << ".";
+    return -1;
+  }
+  QXmlStreamReader reader(&catalogFile);
+  if (! modelParser.parse(reader, QFileInfo(catalogFile))) {
+    logError() << "Cannot parse catalog file '" << catalogFile.fileName()
+               << "': " << modelParser.errorMessage() << ".";
+    return -1;
+  }
+
+  ModelDefinition *modelDef = catalog.model(parser.positionalArguments().at(1));
+  if (nullptr == modelDef) {
+    logError() << "Model '" << parser.positionalArguments().at(1) << "' not found in catalog.";
+    return -1;
+  }
+  ModelFirmwareDefinition *firmwareDef = parser.isSet("firmware") ?
+        modelDef->firmware(parser.value("firmware")) : modelDef->latestFirmware();
+  if (nullptr == firmwareDef) {
+    logError() << "Firmware not found for model " << modelDef->name() << ".";
+    return -1;
+  }
+
+  // Create interface and device
+  bool usePty = parser.isSet("pty");
+#ifndef Q_OS_UNIX
+  if (usePty) {
+    logError() << "PTY mode is not supported on this platform.";
+    return -1;
+  }
+#endif
+  QTemporaryDir tmpDir;
+  QString ptyPath = tmpDir.filePath("loadgen");
+  ReplayInterface *pipe = nullptr;
+  QIODevice *interface = nullptr;
+  if (usePty)
+    interface = new PseudoTerminal(ptyPath);
+  else
+    interface = pipe = new ReplayInterface();
+
+  ErrorStack errStack;
+  Device *device = firmwareDef->createDevice(interface, errStack);
+  if (nullptr == device) {
+    logError() << "Cannot create device: " << errStack.format();
+    return -1;
+  }
+  auto handler = new ImageCollector();
+  device->setHandler(handler);
+
+  QScopedPointer<CpsDriver> driver(CpsDriver::forDevice(device));
+  if (nullptr == driver) {
+    logError() << "No CPS driver for device " << device->metaObject()->className() << ".";
+    delete device;
+    return -1;
+  }
+
+  qsizetype size = parser.value("size").toLongLong();
+  qsizetype frame = parser.isSet("frame") ? parser.value("frame").toLongLong()
+                                          : driver->defaultFrameSize();
+  if (driver->fixedFrameSize())
+    frame = driver->maxFrameSize();
+  frame = std::max(qsizetype(1), std::min(frame, driver->maxFrameSize()));
+
+  QRandomGenerator rng(parser.value("seed").toUInt());
+  QByteArray data(size, '\0');
+  rng.fillRange((quint32 *)data.data(), size/sizeof(quint32));
+  QVector<Chunk> chunks = generateChunks(parser.value("pattern"), driver->baseAddress(), size,
+                                         frame, rng);
+
+  QVector<CpsFrame> frames;
+  driver->begin(frames);
+  for (const auto &chunk: chunks)
+    driver->write(chunk.address, data.constData()+chunk.offset, chunk.size, frames);
+  driver->end(frames);
+
+  qint64 requestBytes = 0;
+  for (const auto &f: frames)
+    requestBytes += f.request.size();
+
+#ifdef Q_OS_UNIX
+  int fd = -1;
+#endif
+  EmulationThread *thread = nullptr;
+  if (usePty) {
+#ifdef Q_OS_UNIX
+    thread = new EmulationThread(device);
+    thread->start();
+    if (0 > (fd = openPty(ptyPath))) {
+      logError() << "Cannot open PTY '" << ptyPath << "': " << strerror(errno) << ".";
+      delete thread;
+      return -1;
+    }
+#endif
+  }
+
+  out << "Protocol: " << driver->name() << ", model " << modelDef->name() << " ("
+      << firmwareDef->name() << "), " << (usePty ? "PTY" : "in-memory pipe") << "\n"
+      << "Codeplug: " << size << " bytes in " << chunks.size() << " frames of " << frame
+      << " bytes, " << parser.value("pattern") << " access\n";
+  out.flush();
+
+  bool ok = true;
+  unsigned int rounds = std::max(1u, parser.value("rounds").toUInt());
+  int64_t duration = 0;
+  qint64 responseBytes = 0;
+  for (unsigned int round=0; ok && (round<rounds); round++) {
+    int64_t start = DeviceStatistics::now();
+#ifdef Q_OS_UNIX
+    if (usePty)
+      responseBytes += runPty(fd, frames, ok);
+    else
+#endif
+      responseBytes += runPipe(pipe, frames, ok);
+    duration += DeviceStatistics::now() - start;
+
+    // MD-32UV detects the end of the programming by a timeout.
+    if (ok && (! waitForImages(handler, round+1, 5000))) {
+      logError() << "Device did not finish image " << round << ".";
+      ok = false;
+    }
+    if (ok && (! verify(handler->last(), chunks, data)))
+      ok = false;
+  }
+
+  double seconds = double(duration)/1e9;
+  qint64 totalFrames = qint64(frames.size())*rounds;
+  out << QString("Frames:     %1 in %2s, %3 frames/s\n")
+         .arg(totalFrames).arg(seconds, 0, 'f', 3).arg(totalFrames/seconds, 0, 'f', 0)
+      << QString("Requests:   %1 bytes, %2 kB/s\n")
+         .arg(requestBytes*rounds).arg(requestBytes*rounds/seconds/1024, 0, 'f', 1)
+      << QString("Responses:  %1 bytes, %2 kB/s\n")
+         .arg(responseBytes).arg(responseBytes/seconds/1024, 0, 'f', 1)
+      << QString("Payload:    %1 kB/s\n").arg(double(size)*rounds/seconds/1024, 0, 'f', 1)
+      << "Verify:     " << (ok ? "OK" : "FAILED") << "\n";
+  out.flush();
+
+#ifdef Q_OS_UNIX
+  if (fd >= 0)
+    ::close(fd);
+#endif
+  if (thread)
+    delete thread;
+  else
+    delete device;
+
+  return ok ? 0 : -1;
+}
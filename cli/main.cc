@@ -1,9 +1,14 @@
 #include <QCoreApplication>
 #include <QCommandLineParser>
 #include <QDir>
+#include <QFileInfo>
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QXmlStreamReader>
+#include <QMutex>
+#include <QSocketNotifier>
+#include <QThreadPool>
+#include <QSharedPointer>
 
 #include "pseudoterminal.hh"
 #include "logger.hh"
@@ -13,6 +18,308 @@
 #include "modelparser.hh"
 #include "hexdump.hh"
 #include "config.hh"
+#include "emulationserver.hh"
+#include "devicestatistics.hh"
+#include "sessiontrace.hh"
+#include "sessionreplay.hh"
+#include "imagearchive.hh"
+#include "changemap.hh"
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <unistd.h>
+#endif
+
+
+/** Serializes the output of handlers, these may run in different threads in server mode. */
+static QMutex outputMutex;
+
+static void
+printDump(const Image *image, QTextStream &stream, const QString &prefix) {
+  // The dump is formatted straight into the output, hold the lock until it is complete.
+  QMutexLocker locker(&outputMutex);
+  if (! prefix.isEmpty())
+    stream << prefix << ":\n";
+  hexdump(image, stream);
+  stream.flush();
+}
+
+static bool
+printDiff(const Image *left, const Image *right, QTextStream &stream, const QString &prefix) {
+  QMutexLocker locker(&outputMutex);
+  bool hasDiff = hexdiff(left, right, stream, prefix.isEmpty() ? QString() : (prefix + ":\n"),
+                         QThreadPool::globalInstance());
+  stream.flush();
+  return hasDiff;
+}
+
+static void
+connectHandler(ImageCollector *imageHandler, const QCommandLineParser &parser, QTextStream &stream,
+               const QString &prefix=QString())
+{
+  imageHandler->setJournaling(parser.isSet("journal"));
+
+  if (parser.isSet("archive")) {
+    QString filename = parser.value("archive");
+    if (! prefix.isEmpty()) {
+      QFileInfo info(filename);
+      filename = info.dir().filePath(prefix + "_" + info.fileName());
+    }
+    bool compress = parser.isSet("compress");
+    QObject::connect(imageHandler, &ImageCollector::imageReceived, imageHandler,
+                     [filename, compress, imageHandler]() {
+      QVector<const Image *> images;
+      for (unsigned int i=0; i<imageHandler->count(); i++)
+        images.append(imageHandler->image(i));
+      ErrorStack err;
+      if (! ImageArchive::save(filename, images, compress, err))
+        logError() << "Cannot archive received codeplugs: " << err.format();
+      else
+        logInfo() << "Archived " << images.size() << " codeplugs in '" << filename << "'.";
+    });
+  }
+
+  if (parser.isSet("heatmap")) {
+    QString filename = parser.value("heatmap");
+    if (! prefix.isEmpty()) {
+      QFileInfo info(filename);
+      filename = info.dir().filePath(prefix + "_" + info.fileName());
+    }
+    // Accumulated incrementally, each codeplug received is compared once.
+    bool first = ("first" == parser.value("diff"));
+    QSharedPointer<ChangeMap> map(new ChangeMap());
+    QObject::connect(imageHandler, &ImageCollector::imageReceived, imageHandler,
+                     [filename, first, map, imageHandler]() {
+      if (imageHandler->count() < 2)
+        return;
+      map->add(first ? imageHandler->first() : imageHandler->previous(), imageHandler->last());
+      ErrorStack err;
+      if (! map->save(filename, err))
+        logError() << "Cannot save heatmap: " << err.format();
+      else
+        logInfo() << "Saved heatmap of " << map->comparisons() << " comparisons ("
+                  << map->changedBytes() << " bytes changed) in '" << filename << "'.";
+    });
+  }
+
+  if (parser.isSet("dump")) {
+    QString pattern = parser.isSet("output") ? parser.value("output") : QString();
+    if (! prefix.isEmpty() && ! pattern.isEmpty()) {
+      // Each instance dumps into its own file sequence.
+      QFileInfo info(pattern);
+      pattern = info.dir().filePath(prefix + "_" + info.fileName());
+    }
+    if (! pattern.isEmpty())
+      logDebug() << "Use pattern '" << pattern << "' for dump files, e.g., "
+                 << QString::asprintf(pattern.toStdString().c_str(), 42) << ".";
+    QObject::connect(imageHandler, &ImageCollector::imageReceived, imageHandler,
+                     [pattern, prefix, &stream, imageHandler, count=0u]() mutable {
+      if (pattern.isEmpty()) {
+        printDump(imageHandler->last(), stream, prefix);
+      } else {
+        QString filename = QString::asprintf(pattern.toStdString().c_str(), count++);
+        QFile output(filename);
+        if (! output.open(QIODevice::WriteOnly)) {
+          logError() << "Cannot write received codeplug dump to file '" << filename
+                     << "': " << output.errorString() << ".";
+          return;
+        }
+        QTextStream outStream(&output);
+        logInfo() << "Write codeplug to '" << filename << "'.";
+        hexdump(imageHandler->last(), outStream);
+        outStream.flush();
+        output.close();
+      }
+    });
+  } else if ("first" == parser.value("diff")) {
+    QObject::connect(imageHandler, &ImageCollector::imageReceived, imageHandler,
+                     [prefix, &stream, imageHandler] {
+      if ((nullptr == imageHandler->first()) || (nullptr == imageHandler->last()))
+        return;
+      if (! printDiff(imageHandler->first(), imageHandler->last(), stream, prefix))
+        logInfo() << "No differences found.";
+    });
+  } else if ((!parser.isSet("diff")) || ("previous" == parser.value("diff"))) {
+    QObject::connect(imageHandler, &ImageCollector::imageReceived, imageHandler,
+                     [prefix, &stream, imageHandler] {
+      if ((nullptr == imageHandler->previous()) || (nullptr == imageHandler->last()))
+        return;
+      if (! printDiff(imageHandler->previous(), imageHandler->last(), stream, prefix))
+        logInfo() << "No differences found.";
+    });
+  }
+}
+
+static void
+logStatistics(const Device *dev, const QString &prefix) {
+  QString report;
+  QTextStream stream(&report);
+  dev->statistics().report(stream);
+  if (prefix.isEmpty())
+    logInfo() << "Statistics:\n" << report;
+  else
+    logInfo() << "Statistics of " << prefix << ":\n" << report;
+}
+
+static void
+connectStatistics(Device *dev, const QString &prefix=QString()) {
+  QObject::connect(dev, &Device::endProgram, dev, [dev, prefix]() {
+    logStatistics(dev, prefix);
+  });
+}
+
+#ifdef Q_OS_UNIX
+/** Self-pipe to forward SIGUSR1 into the event loop. */
+static int statisticsSignalPipe[2] = {-1, -1};
+
+static void
+onStatisticsSignal(int) {
+  char c = 1;
+  ssize_t n = ::write(statisticsSignalPipe[1], &c, 1);
+  Q_UNUSED(n);
+}
+#endif
+
+/** Logs the statistics of all devices on SIGUSR1. */
+static void
+installStatisticsSignal(QCoreApplication &app, const QList<QPair<Device *, QString>> &devices) {
+#ifdef Q_OS_UNIX
+  if (0 != ::pipe(statisticsSignalPipe)) {
+    logWarn() << "Cannot install statistics signal handler.";
+    return;
+  }
+  auto notifier = new QSocketNotifier(statisticsSignalPipe[0], QSocketNotifier::Read, &app);
+  QObject::connect(notifier, &QSocketNotifier::activated, [devices]() {
+    char c;
+    if (1 != ::read(statisticsSignalPipe[0], &c, 1))
+      return;
+    // Statistics must be accessed within the thread of the device.
+    for (const auto &device: devices) {
+      Device *dev = device.first; QString prefix = device.second;
+      QMetaObject::invokeMethod(dev, [dev, prefix]() { logStatistics(dev, prefix); });
+    }
+  });
+  std::signal(SIGUSR1, onStatisticsSignal);
+  logInfo() << "Send SIGUSR1 to process " << QCoreApplication::applicationPid()
+            << " to obtain statistics.";
+#else
+  Q_UNUSED(app); Q_UNUSED(devices);
+#endif
+}
+
+static ModelFirmwareDefinition *
+findFirmware(ModelDefinition *modelDef, const QString &firmware) {
+  if (firmware.isEmpty() || ("latest" == firmware))
+    return modelDef->latestFirmware();
+  return modelDef->firmware(firmware);
+}
+
+static int
+replay(const ModelCatalog &catalog, const QCommandLineParser &parser, QTextStream &stream) {
+  ErrorStack err;
+  SessionTrace trace;
+  if (! trace.load(parser.value("replay"), err)) {
+    logError() << err.format();
+    return -1;
+  }
+
+  ModelDefinition *modelDef = catalog.model(trace.model());
+  if (nullptr == modelDef) {
+    logError() << "Cannot replay trace: Model '" << trace.model() << "' not found in catalog.";
+    return -1;
+  }
+  ModelFirmwareDefinition *modelFirmwareDef = findFirmware(modelDef, trace.firmware());
+  if (nullptr == modelFirmwareDef) {
+    logError() << "Cannot replay trace: Firmware '" << trace.firmware() << "' not found for "
+               << modelDef->name() << ".";
+    return -1;
+  }
+
+  SessionReplay replay(trace);
+  Device *dev = modelFirmwareDef->createDevice(replay.interface(), err);
+  if (nullptr == dev) {
+    logError() << "Cannot replay trace: " << err.format();
+    return -1;
+  }
+  auto imageHandler = new ImageCollector();
+  dev->setHandler(imageHandler);
+  connectHandler(imageHandler, parser, stream);
+  if (parser.isSet("stats"))
+    connectStatistics(dev);
+
+  logInfo() << "Replay " << trace.count() << " records for " << modelDef->name() << " ("
+            << modelFirmwareDef->name() << ").";
+  bool ok = replay.run(parser.isSet("realtime"), err);
+  if (parser.isSet("stats"))
+    logStatistics(dev, QString());
+  delete dev;
+
+  if (! ok) {
+    logError() << "Replay failed: " << err.format();
+    return -1;
+  }
+
+  logInfo() << "Replay matches: " << replay.bytesFed() << " bytes fed, "
+            << replay.bytesCompared() << " bytes compared in "
+            << QString::number(double(replay.elapsed())/1e6, 'f', 3) << "ms.";
+  return 0;
+}
+
+static int
+serve(const ModelCatalog &catalog, const QCommandLineParser &parser, QCoreApplication &app,
+      QTextStream &stream)
+{
+  EmulationServer server(parser.value("workers").toUInt());
+
+  QList<QPair<Device *, QString>> devices;
+  unsigned int index = 0;
+  foreach (QString spec, parser.values("instance")) {
+    QStringList fields = spec.split(",");
+    QString modelId = fields.at(0).simplified();
+    QString firmware = (fields.size() > 1) ? fields.at(1).simplified() : QString();
+    QString name = QString("%1-%2").arg(modelId).arg(index++);
+    QString symlink = (fields.size() > 2) ? fields.at(2).simplified()
+                                          : QString("~/.local/share/anytone-emu/%1").arg(name);
+
+    ModelDefinition *modelDef = catalog.model(modelId);
+    if (nullptr == modelDef) {
+      logError() << "Cannot create instance '" << spec << "': Unknown model '" << modelId << "'.";
+      return -1;
+    }
+    ModelFirmwareDefinition *modelFirmwareDef = findFirmware(modelDef, firmware);
+    if (nullptr == modelFirmwareDef) {
+      logError() << "Cannot create instance '" << spec << "': Unknown firmware '" << firmware
+                 << "' for model " << modelDef->name() << ".";
+      return -1;
+    }
+
+    ErrorStack err;
+    Device *dev = modelFirmwareDef->createDevice(new PseudoTerminal(symlink), err);
+    if (nullptr == dev) {
+      logError() << "Cannot create instance '" << spec << "': " << err.format();
+      return -1;
+    }
+    auto imageHandler = new ImageCollector();
+    dev->setHandler(imageHandler);
+    connectHandler(imageHandler, parser, stream, name);
+    if (parser.isSet("stats")) {
+      connectStatistics(dev, name);
+      devices.append({dev, name});
+    }
+
+    logInfo() << "Serve " << modelDef->name() << " (" << modelFirmwareDef->name() << ") as '"
+              << name << "' at '" << symlink << "'.";
+    server.add(dev);
+  }
+
+  logInfo() << "Serve " << server.count() << " devices using " << server.workers() << " workers.";
+  if (parser.isSet("stats"))
+    installStatisticsSignal(app, devices);
+  server.start();
+
+  return app.exec();
+}
+
 
 
 int
@@ -48,6 +355,36 @@ main(int argc, char *argv[])
                     "This usually has no effect on the emulation. If no firmware is specified, "
                     "the latest found is used. If set to '?' all firmwares defined for the model are "
                     "shown.", "firmware", "latest"});
+  parser.addOption({"stats", "Logs latency and throughput statistics of the protocol at the end "
+                    "of each programming. Under Linux and MacOS, the statistics are also logged on "
+                    "SIGUSR1."});
+  parser.addOption({"journal", "Records the writes of each programming into a journal and "
+                    "assembles the codeplug at the end of the programming. This keeps the emulation "
+                    "responsive for large codeplugs."});
+  parser.addOption({"archive", "Saves all codeplugs received into the given binary archive. The "
+                    "archive is updated after each programming and can be opened in the GUI.",
+                    "file"});
+  parser.addOption({"compress", "Compresses the content of the archive."});
+  parser.addOption({"heatmap", "Counts how often each byte changed across all received codeplugs "
+                    "and saves these counts as CSV into the given file. The file is updated after "
+                    "each programming. The reference of each comparison is specified by --diff.",
+                    "file"});
+  parser.addOption({"record", "Records all bytes exchanged with the CPS into the given trace "
+                    "file.", "file"});
+  parser.addOption({"replay", "Replays the given trace file against the emulated device and "
+                    "verifies the responses. The model and firmware are taken from the trace, the "
+                    "device and interface arguments are omitted.", "file"});
+  parser.addOption({"realtime", "Replays with the original timing instead of as fast as "
+                    "possible. Without it, the replay still waits for the time-outs of the device "
+                    "once the trace is fed."});
+  parser.addOption({"instance", "Server mode: Adds a device to emulate. The instance is specified "
+                    "as 'model[,firmware[,symlink]]'. This option can be given several times to "
+                    "emulate many devices from a single process. Each device is served via its "
+                    "own pseudo terminal. If no symlink is given, "
+                    "'~/.local/share/anytone-emu/model-N' is used. In server mode, the device and "
+                    "interface arguments are omitted.", "instance"});
+  parser.addOption({"workers", "Server mode: Specifies the number of worker threads. Default: "
+                    "number of cores.", "workers", "0"});
 
   parser.addPositionalArgument("catalog", "Specifies the catalog file to use. "
                                "See http://github.com/dmr-tools/codeplugs/.");
@@ -94,6 +431,11 @@ main(int argc, char *argv[])
     return -1;
   }
 
+  if (parser.isSet("replay"))
+    return replay(catalog, parser, stream);
+  if (parser.isSet("instance"))
+    return serve(catalog, parser, app, stream);
+
   if ((2 > parser.positionalArguments().size()) ||
       (!catalog.hasModel(parser.positionalArguments().at(1)))) {
     if (2 <= parser.positionalArguments().size())
@@ -114,11 +456,8 @@ main(int argc, char *argv[])
     return -1;
   }
 
-  ModelFirmwareDefinition *modelFirmwareDef = nullptr;
-  if ((! parser.isSet("firmware")) || ("latest" == parser.value("firmware")))
-    modelFirmwareDef = modelDef->latestFirmware();
-  else
-    modelFirmwareDef = modelDef->firmware(parser.value("firmware"));
+  ModelFirmwareDefinition *modelFirmwareDef = findFirmware(
+        modelDef, parser.isSet("firmware") ? parser.value("firmware") : QString());
   if (nullptr == modelFirmwareDef) {
     if ((!parser.isSet("firmware")) || ("?" != parser.value("firmware")))
       logError() << "Cannot find firmware '" << parser.value("firmware")
@@ -156,53 +495,25 @@ main(int argc, char *argv[])
     interface = new QSerialPort(portInfo);
   }
 
+  if (parser.isSet("record")) {
+    QFile *trace = new QFile(parser.value("record"));
+    if (! trace->open(QIODevice::WriteOnly)) {
+      logError() << "Cannot open trace file '" << trace->fileName() << "': "
+                 << trace->errorString() << ".";
+      delete trace; delete interface;
+      return -1;
+    }
+    logInfo() << "Record session into '" << trace->fileName() << "'.";
+    interface = new SessionRecorder(interface, trace, modelDef->id(), modelFirmwareDef->name());
+  }
+
   Device *dev = modelFirmwareDef->createDevice(interface);
   auto imageHandler = new ImageCollector();
   dev->setHandler(imageHandler);
-
-  if (parser.isSet("dump")) {
-    if (parser.isSet("output"))
-      logDebug() << "Use pattern '" << parser.value("output") << "' for dump files, e.g., "
-                 << QString::asprintf(parser.value("output").toStdString().c_str(), 42) << ".";
-    QObject::connect(imageHandler, &ImageCollector::imageReceived, [&parser, &stream, imageHandler] {
-      static unsigned int count = 0;
-      HexImage hex(imageHandler->last());
-      if (! parser.isSet("output")) {
-        hexdump(hex, stream);
-      } else {
-        QString filename = QString::asprintf(parser.value("output").toStdString().c_str(), count++);
-        QFile output(filename);
-        if (! output.open(QIODevice::WriteOnly)) {
-          logError() << "Cannot write received codeplug dump to file '" << filename
-                     << "': " << output.errorString() << ".";
-          return;
-        }
-        QTextStream outStream(&output);
-        logInfo() << "Write codeplug to '" << filename << "'.";
-        hexdump(hex, outStream);
-        output.close();
-      }
-    });
-  } else if ("first" == parser.value("diff")) {
-    QObject::connect(imageHandler, &ImageCollector::imageReceived, [&stream, imageHandler] {
-      if ((nullptr == imageHandler->first()) || (nullptr == imageHandler->last()))
-        return;
-      HexImage hex(imageHandler->first(), imageHandler->last());
-      if (hex.hasDiff())
-        hexdump(hex, stream);
-      else
-        logInfo() << "No differences found.";
-    });
-  } else if ((!parser.isSet("diff")) || ("previous" == parser.value("diff"))) {
-    QObject::connect(imageHandler, &ImageCollector::imageReceived, [&stream, imageHandler] {
-      if ((nullptr == imageHandler->previous()) || (nullptr == imageHandler->last()))
-        return;
-      HexImage hex(imageHandler->previous(), imageHandler->last());
-      if (hex.hasDiff())
-        hexdump(hex, stream);
-      else
-        logInfo() << "No differences found.";
-    });
+  connectHandler(imageHandler, parser, stream);
+  if (parser.isSet("stats")) {
+    connectStatistics(dev);
+    installStatisticsSignal(app, {{dev, QString()}});
   }
 
   app.exec();
@@ -0,0 +1,176 @@
+#include "blockcompare.hh"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define BLOCKCOMPARE_HAVE_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 kernels are compiled for the target explicitly and selected at runtime.
+#define BLOCKCOMPARE_HAVE_AVX2 1
+#endif
+#endif
+
+
+/** Marks the blocks given by @c mask, starting with block @c first. The blocks must not cross a
+ * word of the bitmap. */
+static inline qsizetype
+mark(uint64_t *bitmap, qsizetype first, uint64_t mask) {
+  bitmap[first/64] |= mask << (first % 64);
+  return qPopulationCount(mask);
+}
+
+
+/* ********************************************************************************************* *
+ * Scalar kernel
+ * ********************************************************************************************* */
+/** Compares the blocks from offset @c start (a multiple of the block size) on. */
+static qsizetype
+compareScalar(const char *left, const char *right, qsizetype start, qsizetype len,
+              uint64_t *bitmap)
+{
+  qsizetype count = 0;
+  for (qsizetype i=start; i<len; i+=BlockCompare::BlockSize) {
+    qsizetype n = std::min(BlockCompare::BlockSize, len-i);
+    if (0 != std::memcmp(left+i, right+i, n))
+      count += mark(bitmap, i/BlockCompare::BlockSize, 1);
+  }
+  return count;
+}
+
+
+/* ********************************************************************************************* *
+ * SSE2 kernel
+ * ********************************************************************************************* */
+#ifdef BLOCKCOMPARE_HAVE_SSE2
+/** Returns @c true if the 16 bytes at both pointers differ. */
+static inline bool
+blockDiffersSSE2(const char *left, const char *right) {
+  __m128i a = _mm_loadu_si128((const __m128i *)left), b = _mm_loadu_si128((const __m128i *)right);
+  return 0xffff != _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+}
+
+/** Compares the blocks from offset @c start (a multiple of the block size) on. */
+static qsizetype
+compareSSE2(const char *left, const char *right, qsizetype start, qsizetype len,
+            uint64_t *bitmap)
+{
+  qsizetype count = 0, i = start;
+  // 4 blocks per iteration, aligned to 4 blocks, hence they never cross a word of the bitmap
+  for (; (i+4*BlockCompare::BlockSize)<=len; i+=4*BlockCompare::BlockSize) {
+    uint64_t mask = 0;
+    for (int k=0; k<4; k++) {
+      if (blockDiffersSSE2(left+i+16*k, right+i+16*k))
+        mask |= (1 << k);
+    }
+    if (mask)
+      count += mark(bitmap, i/BlockCompare::BlockSize, mask);
+  }
+  for (; (i+BlockCompare::BlockSize)<=len; i+=BlockCompare::BlockSize) {
+    if (blockDiffersSSE2(left+i, right+i))
+      count += mark(bitmap, i/BlockCompare::BlockSize, 1);
+  }
+  return count + compareScalar(left, right, i, len, bitmap);
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * AVX2 kernel
+ * ********************************************************************************************* */
+#ifdef BLOCKCOMPARE_HAVE_AVX2
+__attribute__((target("avx2"))) static qsizetype
+compareAVX2(const char *left, const char *right, qsizetype len, uint64_t *bitmap) {
+  qsizetype count = 0, i = 0;
+  // 4 blocks per iteration, each compare covers two of them
+  for (; (i+4*BlockCompare::BlockSize)<=len; i+=4*BlockCompare::BlockSize) {
+    __m256i a0 = _mm256_loadu_si256((const __m256i *)(left+i));
+    __m256i b0 = _mm256_loadu_si256((const __m256i *)(right+i));
+    __m256i a1 = _mm256_loadu_si256((const __m256i *)(left+i+32));
+    __m256i b1 = _mm256_loadu_si256((const __m256i *)(right+i+32));
+    uint32_t eq0 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(a0, b0));
+    uint32_t eq1 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(a1, b1));
+    if ((0xffffffff == eq0) && (0xffffffff == eq1))
+      continue;
+    uint64_t mask = ((0xffff != (eq0 & 0xffff)) ? 1 : 0) | ((0xffff != (eq0 >> 16)) ? 2 : 0)
+        | ((0xffff != (eq1 & 0xffff)) ? 4 : 0) | ((0xffff != (eq1 >> 16)) ? 8 : 0);
+    count += mark(bitmap, i/BlockCompare::BlockSize, mask);
+  }
+  return count + compareSSE2(left, right, i, len, bitmap);
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * Implementation of BlockCompare
+ * ********************************************************************************************* */
+qsizetype
+BlockCompare::compare(const char *left, const char *right, qsizetype len, uint64_t *bitmap) {
+  static const Kernel selected = kernel();
+  return compare(left, right, len, bitmap, selected);
+}
+
+qsizetype
+BlockCompare::compare(const char *left, const char *right, qsizetype len, uint64_t *bitmap,
+                      Kernel kernel)
+{
+  std::memset(bitmap, 0, bitmapSize(len)*sizeof(uint64_t));
+
+  switch (kernel) {
+#ifdef BLOCKCOMPARE_HAVE_AVX2
+  case Kernel::AVX2:
+    if (supported(Kernel::AVX2))
+      return compareAVX2(left, right, len, bitmap);
+    break;
+#endif
+#ifdef BLOCKCOMPARE_HAVE_SSE2
+  case Kernel::SSE2:
+    return compareSSE2(left, right, 0, len, bitmap);
+#endif
+  default:
+    break;
+  }
+  return compareScalar(left, right, 0, len, bitmap);
+}
+
+
+BlockCompare::Kernel
+BlockCompare::kernel() {
+  if (supported(Kernel::AVX2))
+    return Kernel::AVX2;
+  if (supported(Kernel::SSE2))
+    return Kernel::SSE2;
+  return Kernel::Scalar;
+}
+
+bool
+BlockCompare::supported(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar:
+    return true;
+  case Kernel::SSE2:
+#ifdef BLOCKCOMPARE_HAVE_SSE2
+    return true;
+#else
+    return false;
+#endif
+  case Kernel::AVX2:
+#ifdef BLOCKCOMPARE_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+const char *
+BlockCompare::kernelName(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar: return "scalar";
+  case Kernel::SSE2: return "SSE2";
+  case Kernel::AVX2: return "AVX2";
+  }
+  return "unknown";
+}
@@ -0,0 +1,53 @@
+#ifndef BLOCKCOMPARE_HH
+#define BLOCKCOMPARE_HH
+
+#include <QtGlobal>
+#include <cstdint>
+
+
+/** Compares two memory ranges in blocks of 16 bytes, the size of a line of a hex dump.
+ *
+ * The result is a compact bitmap, holding a bit for every block, which is set if the block differs.
+ * This way, the diff engine (see @c HexElement) only needs to create @c HexLine instances for the
+ * lines that actually differ. On x86 CPUs, vectorized (SSE2 and, if supported by the CPU, AVX2)
+ * kernels compare 64 bytes per iteration. On all other platforms, a portable scalar implementation
+ * is used. Like for @c Checksum, the kernel is selected once at runtime.
+ *
+ * @ingroup utils */
+class BlockCompare
+{
+public:
+  /** Possible compare kernels. */
+  enum class Kernel {
+    Scalar, ///< Portable implementation.
+    SSE2,   ///< 128bit vector implementation.
+    AVX2    ///< 256bit vector implementation.
+  };
+
+  /** Size of a block in bytes. */
+  static constexpr qsizetype BlockSize = 16;
+
+public:
+  /** Returns the number of 64bit words needed for the bitmap of @c len bytes. */
+  static constexpr qsizetype bitmapSize(qsizetype len) {
+    return (len + 64*BlockSize - 1)/(64*BlockSize);
+  }
+
+  /** Compares @c len bytes of @c left and @c right. Bit @c i of the @c bitmap is set, if block
+   * @c i differs. The last block may be shorter than @c BlockSize. The bitmap must hold at least
+   * @c bitmapSize(len) words, these get overridden. Returns the number of differing blocks. */
+  static qsizetype compare(const char *left, const char *right, qsizetype len, uint64_t *bitmap);
+  /** Same as above using the specified kernel.
+   * If the kernel is not supported, the scalar implementation is used. */
+  static qsizetype compare(const char *left, const char *right, qsizetype len, uint64_t *bitmap,
+                           Kernel kernel);
+
+  /** Returns the kernel selected for this CPU. */
+  static Kernel kernel();
+  /** Returns @c true if the given kernel is supported by this build and CPU. */
+  static bool supported(Kernel kernel);
+  /** Returns the name of the given kernel. */
+  static const char *kernelName(Kernel kernel);
+};
+
+#endif // BLOCKCOMPARE_HH
@@ -0,0 +1,350 @@
+#include "changemap.hh"
+#include "image.hh"
+#include <QSaveFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define CHANGEMAP_HAVE_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 kernels are compiled for the target explicitly and selected at runtime.
+#define CHANGEMAP_HAVE_AVX2 1
+#endif
+#endif
+
+
+/* ********************************************************************************************* *
+ * Scalar kernel
+ * ********************************************************************************************* */
+static inline void
+accumulateScalar(const char *left, const char *right, qsizetype len, uint16_t *counters) {
+  for (qsizetype i=0; i<len; i++) {
+    if ((left[i] != right[i]) && (0xffff != counters[i]))
+      counters[i]++;
+  }
+}
+
+
+/* ********************************************************************************************* *
+ * SSE2 kernel
+ * ********************************************************************************************* */
+#ifdef CHANGEMAP_HAVE_SSE2
+static void
+accumulateSSE2(const char *left, const char *right, qsizetype len, uint16_t *counters) {
+  const __m128i one = _mm_set1_epi16(1), ones = _mm_set1_epi8(-1);
+  qsizetype i = 0;
+  for (; (i+16)<=len; i+=16) {
+    __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(left+i)),
+                                _mm_loadu_si128((const __m128i *)(right+i)));
+    if (0xffff == _mm_movemask_epi8(eq))
+      continue;
+    // Widen the mask of differing bytes to 1 for each counter
+    __m128i ne = _mm_xor_si128(eq, ones);
+    __m128i lo = _mm_and_si128(_mm_unpacklo_epi8(ne, ne), one);
+    __m128i hi = _mm_and_si128(_mm_unpackhi_epi8(ne, ne), one);
+    __m128i *c = (__m128i *)(counters+i);
+    _mm_storeu_si128(c, _mm_adds_epu16(_mm_loadu_si128(c), lo));
+    _mm_storeu_si128(c+1, _mm_adds_epu16(_mm_loadu_si128(c+1), hi));
+  }
+  accumulateScalar(left+i, right+i, len-i, counters+i);
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * AVX2 kernel
+ * ********************************************************************************************* */
+#ifdef CHANGEMAP_HAVE_AVX2
+__attribute__((target("avx2"))) static void
+accumulateAVX2(const char *left, const char *right, qsizetype len, uint16_t *counters) {
+  const __m256i one = _mm256_set1_epi16(1), ones = _mm256_set1_epi8(-1);
+  qsizetype i = 0;
+  for (; (i+32)<=len; i+=32) {
+    __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(left+i)),
+                                   _mm256_loadu_si256((const __m256i *)(right+i)));
+    if (-1 == _mm256_movemask_epi8(eq))
+      continue;
+    __m256i ne = _mm256_xor_si256(eq, ones);
+    __m256i lo = _mm256_and_si256(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(ne)), one);
+    __m256i hi = _mm256_and_si256(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(ne, 1)), one);
+    __m256i *c = (__m256i *)(counters+i);
+    _mm256_storeu_si256(c, _mm256_adds_epu16(_mm256_loadu_si256(c), lo));
+    _mm256_storeu_si256(c+1, _mm256_adds_epu16(_mm256_loadu_si256(c+1), hi));
+  }
+  accumulateSSE2(left+i, right+i, len-i, counters+i);
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * Implementation of ChangeMap
+ * ********************************************************************************************* */
+ChangeMap::ChangeMap()
+  : _pages(), _comparisons(0)
+{
+  // pass...
+}
+
+ChangeMap::ChangeMap(const QVector<const Image *> &images, Mode mode)
+  : _pages(), _comparisons(0)
+{
+  for (int i=1; i<images.size(); i++)
+    add((Mode::First == mode) ? images.first() : images.at(i-1), images.at(i));
+}
+
+ChangeMap::ChangeMap(Collection *collection, Mode mode)
+  : _pages(), _comparisons(0)
+{
+  // Bytes read back at most since the budget was enforced last.
+  qsizetype pending = 0;
+  for (unsigned int i=1; i<collection->count(); i++) {
+    const Image *reference = (Mode::First == mode) ? collection->image(0) : collection->image(i-1);
+    add(reference, collection->image(i));
+    // Keeps the images needed next, the others are evicted once in a while.
+    collection->touch(reference, false);
+    collection->touch(collection->image(i), false);
+    for (const Element *element: *collection->image(i))
+      pending += element->size().byte();
+    if ((0 != collection->memoryBudget()) && ((4*pending) >= collection->memoryBudget())) {
+      collection->enforceBudget();
+      pending = 0;
+    }
+  }
+  if (0 != pending)
+    collection->enforceBudget();
+}
+
+
+void
+ChangeMap::add(const Image *reference, const Image *image) {
+  _comparisons++;
+
+  // Duplicates of the same image have no changes.
+  const Image *referenceOriginal = reference->duplicateOf() ? reference->duplicateOf() : reference;
+  const Image *imageOriginal = image->duplicateOf() ? image->duplicateOf() : image;
+  if (referenceOriginal == imageOriginal)
+    return;
+
+  for (unsigned int i=0,j=0; (i<reference->count()) || (j<image->count());) {
+    if ((i<reference->count()) && (j<image->count())) {
+      if (reference->element(i)->address() < image->element(j)->address())
+        addElements(reference->element(i++), nullptr);
+      else if (reference->element(i)->address() > image->element(j)->address())
+        addElements(nullptr, image->element(j++));
+      else
+        addElements(reference->element(i++), image->element(j++));
+    } else if (i<reference->count()) {
+      addElements(reference->element(i++), nullptr);
+    } else {
+      addElements(nullptr, image->element(j++));
+    }
+  }
+}
+
+void
+ChangeMap::clear() {
+  _pages.clear();
+  _comparisons = 0;
+}
+
+
+unsigned int
+ChangeMap::comparisons() const {
+  return _comparisons;
+}
+
+bool
+ChangeMap::isEmpty() const {
+  return 0 == changedBytes();
+}
+
+uint16_t
+ChangeMap::count(uint32_t address) const {
+  auto page = _pages.find(address - (address % PageSize));
+  if (_pages.end() == page)
+    return 0;
+  return page->at(address % PageSize);
+}
+
+uint16_t
+ChangeMap::maxCount() const {
+  uint16_t max = 0;
+  for (const QVector<uint16_t> &page: _pages)
+    max = std::max(max, *std::max_element(page.begin(), page.end()));
+  return max;
+}
+
+qsizetype
+ChangeMap::changedBytes() const {
+  qsizetype count = 0;
+  for (const QVector<uint16_t> &page: _pages)
+    count += page.size() - std::count(page.begin(), page.end(), 0);
+  return count;
+}
+
+
+void
+ChangeMap::write(QTextStream &stream) const {
+  stream << "address";
+  for (int k=0; k<16; k++)
+    stream << ",+" << Qt::hex << k;
+  stream << "\n";
+
+  for (auto page=_pages.begin(); page!=_pages.end(); page++) {
+    const uint16_t *counts = page->constData();
+    for (uint32_t offset=0; offset<PageSize; offset+=16) {
+      if (std::all_of(counts+offset, counts+offset+16, [](uint16_t c) { return 0 == c; }))
+        continue;
+      stream << Qt::hex << qSetFieldWidth(8) << qSetPadChar('0') << (page.key()+offset)
+             << qSetFieldWidth(0) << Qt::dec;
+      for (int k=0; k<16; k++)
+        stream << "," << counts[offset+k];
+      stream << "\n";
+    }
+  }
+  stream.reset();
+}
+
+bool
+ChangeMap::save(const QString &filename, const ErrorStack &err) const {
+  QSaveFile file(filename);
+  if (! file.open(QIODevice::WriteOnly)) {
+    errMsg(err) << "Cannot open heatmap '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+  QTextStream stream(&file);
+  write(stream);
+  stream.flush();
+  if (! file.commit()) {
+    errMsg(err) << "Cannot save heatmap '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+  return true;
+}
+
+
+uint16_t *
+ChangeMap::counters(uint32_t address) {
+  uint32_t page = address - (address % PageSize);
+  auto counters = _pages.find(page);
+  if (_pages.end() == counters)
+    counters = _pages.insert(page, QVector<uint16_t>(PageSize, 0));
+  return counters->data() + (address % PageSize);
+}
+
+void
+ChangeMap::addElements(const Element *left, const Element *right) {
+  if ((nullptr == left) || (nullptr == right)) {
+    const Element *element = left ? left : right;
+    addChanged(element->address().byte(), element->size().byte());
+    return;
+  }
+
+  uint32_t address = left->address().byte();
+  qsizetype leftSize = left->size().byte(), rightSize = right->size().byte();
+  qsizetype common = std::min(leftSize, rightSize);
+  for (qsizetype page=0; (page*Element::PageSize)<common; page++) {
+    if (left->samePage(right, page))
+      continue;
+    qsizetype start = page*Element::PageSize;
+    addRange(address+start, left->page(page).data(), right->page(page).data(),
+             std::min(Element::PageSize, common-start));
+  }
+  if (common < std::max(leftSize, rightSize))
+    addChanged(address+common, std::max(leftSize, rightSize)-common);
+}
+
+void
+ChangeMap::addRange(uint32_t address, const char *left, const char *right, qsizetype len) {
+  while (len > 0) {
+    qsizetype n = std::min(len, qsizetype(PageSize - (address % PageSize)));
+    // Counters are only allocated for pages with changes.
+    if (0 != std::memcmp(left, right, n))
+      accumulate(left, right, n, counters(address));
+    address += n; left += n; right += n; len -= n;
+  }
+}
+
+void
+ChangeMap::addChanged(uint32_t address, qsizetype len) {
+  while (len > 0) {
+    qsizetype n = std::min(len, qsizetype(PageSize - (address % PageSize)));
+    uint16_t *c = counters(address);
+    for (qsizetype i=0; i<n; i++) {
+      if (0xffff != c[i])
+        c[i]++;
+    }
+    address += n; len -= n;
+  }
+}
+
+
+void
+ChangeMap::accumulate(const char *left, const char *right, qsizetype len, uint16_t *counters) {
+  static const Kernel selected = kernel();
+  accumulate(left, right, len, counters, selected);
+}
+
+void
+ChangeMap::accumulate(const char *left, const char *right, qsizetype len, uint16_t *counters,
+                      Kernel kernel)
+{
+  switch (kernel) {
+#ifdef CHANGEMAP_HAVE_AVX2
+  case Kernel::AVX2:
+    if (supported(Kernel::AVX2))
+      return accumulateAVX2(left, right, len, counters);
+    break;
+#endif
+#ifdef CHANGEMAP_HAVE_SSE2
+  case Kernel::SSE2:
+    return accumulateSSE2(left, right, len, counters);
+#endif
+  default:
+    break;
+  }
+  accumulateScalar(left, right, len, counters);
+}
+
+
+ChangeMap::Kernel
+ChangeMap::kernel() {
+  if (supported(Kernel::AVX2))
+    return Kernel::AVX2;
+  if (supported(Kernel::SSE2))
+    return Kernel::SSE2;
+  return Kernel::Scalar;
+}
+
+bool
+ChangeMap::supported(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar:
+    return true;
+  case Kernel::SSE2:
+#ifdef CHANGEMAP_HAVE_SSE2
+    return true;
+#else
+    return false;
+#endif
+  case Kernel::AVX2:
+#ifdef CHANGEMAP_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+const char *
+ChangeMap::kernelName(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar: return "scalar";
+  case Kernel::SSE2: return "SSE2";
+  case Kernel::AVX2: return "AVX2";
+  }
+  return "unknown";
+}
@@ -0,0 +1,113 @@
+#ifndef CHANGEMAP_HH
+#define CHANGEMAP_HH
+
+#include <QMap>
+#include <QVector>
+#include "errorstack.hh"
+
+class Image;
+class Element;
+class Collection;
+class QTextStream;
+
+
+/** Counts how often each byte changed across a series of images (a heatmap).
+ *
+ * Each image of the series is compared either against the first image or against its predecessor
+ * (see @c Mode). For every address, the number of comparisons in which the byte differs is
+ * accumulated. Elements are paired by their address. Bytes present in only one of the compared
+ * images count as changed.
+ *
+ * Pages shared between the images or with identical content hashes (see @c Element::samePage)
+ * are skipped. The remaining pages are compared by vectorized kernels, which increment the
+ * counters of all differing bytes at once. Like for @c Checksum, the kernel is selected once at
+ * runtime. The counters are kept in pages of @c PageSize bytes, which are only allocated once a
+ * byte within them changed. Counters saturate at 65535.
+ *
+ * @ingroup codeplug */
+class ChangeMap
+{
+public:
+  /** Specifies the reference of each comparison. */
+  enum class Mode {
+    First,    ///< Compare every image with the first one.
+    Previous  ///< Compare every image with its predecessor.
+  };
+
+  /** Possible counting kernels. */
+  enum class Kernel {
+    Scalar, ///< Portable implementation.
+    SSE2,   ///< 128bit vector implementation.
+    AVX2    ///< 256bit vector implementation.
+  };
+
+  /** Number of addresses covered by a page of counters. */
+  static constexpr uint32_t PageSize = 0x1000;
+
+public:
+  /** Constructs an empty change map. */
+  ChangeMap();
+  /** Constructs the change map of the given series of images. */
+  explicit ChangeMap(const QVector<const Image *> &images, Mode mode=Mode::Previous);
+  /** Constructs the change map of all images of the collection. The compared images are marked as
+   * used (see @c Collection::touch) after each comparison. Hence, images read back for the
+   * analysis get evicted again, if the collection exceeds its memory budget. The memory budget is
+   * kept during the analysis. It is enforced once the images compared since the last time may
+   * have read back a quarter of the budget, hence it may be exceeded by that much in between. */
+  explicit ChangeMap(Collection *collection, Mode mode=Mode::Previous);
+
+  /** Accumulates the changes between the given images. */
+  void add(const Image *reference, const Image *image);
+  /** Resets all counters. */
+  void clear();
+
+  /** Returns the number of comparisons accumulated. */
+  unsigned int comparisons() const;
+  /** Returns @c true if no byte changed. */
+  bool isEmpty() const;
+  /** Returns how often the byte at the given address changed. */
+  uint16_t count(uint32_t address) const;
+  /** Returns the maximum count of all bytes. */
+  uint16_t maxCount() const;
+  /** Returns the number of bytes, that changed at least once. */
+  qsizetype changedBytes() const;
+
+  /** Writes the heatmap as CSV. There is a row for every line of 16 bytes containing any change,
+   * holding the address of the line and the counts of all 16 bytes. */
+  void write(QTextStream &stream) const;
+  /** Saves the heatmap as CSV into the given file (see @c write). */
+  bool save(const QString &filename, const ErrorStack &err=ErrorStack()) const;
+
+  /** Increments the @c counters of all bytes, that differ between @c left and @c right. */
+  static void accumulate(const char *left, const char *right, qsizetype len, uint16_t *counters);
+  /** Same as above using the specified kernel.
+   * If the kernel is not supported, the scalar implementation is used. */
+  static void accumulate(const char *left, const char *right, qsizetype len, uint16_t *counters,
+                         Kernel kernel);
+
+  /** Returns the kernel selected for this CPU. */
+  static Kernel kernel();
+  /** Returns @c true if the given kernel is supported by this build and CPU. */
+  static bool supported(Kernel kernel);
+  /** Returns the name of the given kernel. */
+  static const char *kernelName(Kernel kernel);
+
+protected:
+  /** Returns the counters of the page containing the address, allocates them if needed. */
+  uint16_t *counters(uint32_t address);
+  /** Accumulates the changes between two elements at the same address, either may be
+   * @c nullptr. */
+  void addElements(const Element *left, const Element *right);
+  /** Accumulates the changes between the content at the given address. */
+  void addRange(uint32_t address, const char *left, const char *right, qsizetype len);
+  /** Counts all bytes of the given range as changed. */
+  void addChanged(uint32_t address, qsizetype len);
+
+protected:
+  /** Pages of counters, indexed by the address of the page. */
+  QMap<uint32_t, QVector<uint16_t>> _pages;
+  /** The number of comparisons. */
+  unsigned int _comparisons;
+};
+
+#endif // CHANGEMAP_HH
@@ -0,0 +1,195 @@
+#include "checksum.hh"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define CHECKSUM_HAVE_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 kernels are compiled for the target explicitly and selected at runtime.
+#define CHECKSUM_HAVE_AVX2 1
+#endif
+#endif
+
+
+/* ********************************************************************************************* *
+ * Scalar kernels
+ * ********************************************************************************************* */
+static inline uint8_t
+sum8Scalar(const char *data, qsizetype len) {
+  uint8_t sum = 0;
+  for (qsizetype i=0; i<len; i++)
+    sum += (uint8_t)data[i];
+  return sum;
+}
+
+static inline uint8_t
+xor8Scalar(const char *data, qsizetype len) {
+  uint8_t x = 0;
+  for (qsizetype i=0; i<len; i++)
+    x ^= (uint8_t)data[i];
+  return x;
+}
+
+
+/* ********************************************************************************************* *
+ * SSE2 kernels
+ * ********************************************************************************************* */
+#ifdef CHECKSUM_HAVE_SSE2
+static uint8_t
+sum8SSE2(const char *data, qsizetype len) {
+  // Horizontal sums of 8 bytes each get accumulated into two 64bit lanes.
+  __m128i acc = _mm_setzero_si128(), zero = _mm_setzero_si128();
+  qsizetype i = 0;
+  for (; (i+16)<=len; i+=16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data+i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, acc);
+  return uint8_t(lanes[0] + lanes[1]) + sum8Scalar(data+i, len-i);
+}
+
+static uint8_t
+xor8SSE2(const char *data, qsizetype len) {
+  __m128i acc = _mm_setzero_si128();
+  qsizetype i = 0;
+  for (; (i+16)<=len; i+=16)
+    acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i *)(data+i)));
+  alignas(16) char bytes[16];
+  _mm_store_si128((__m128i *)bytes, acc);
+  return xor8Scalar(bytes, 16) ^ xor8Scalar(data+i, len-i);
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * AVX2 kernels
+ * ********************************************************************************************* */
+#ifdef CHECKSUM_HAVE_AVX2
+__attribute__((target("avx2"))) static uint8_t
+sum8AVX2(const char *data, qsizetype len) {
+  __m256i acc = _mm256_setzero_si256(), zero = _mm256_setzero_si256();
+  qsizetype i = 0;
+  for (; (i+32)<=len; i+=32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(data+i));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, acc);
+  return uint8_t(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + sum8SSE2(data+i, len-i);
+}
+
+__attribute__((target("avx2"))) static uint8_t
+xor8AVX2(const char *data, qsizetype len) {
+  __m256i acc = _mm256_setzero_si256();
+  qsizetype i = 0;
+  for (; (i+32)<=len; i+=32)
+    acc = _mm256_xor_si256(acc, _mm256_loadu_si256((const __m256i *)(data+i)));
+  alignas(32) char bytes[32];
+  _mm256_store_si256((__m256i *)bytes, acc);
+  return xor8Scalar(bytes, 32) ^ xor8SSE2(data+i, len-i);
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * Implementation of Checksum
+ * ********************************************************************************************* */
+/** Frames shorter than this are summed up by the scalar kernel, the setup of the vector kernels
+ * does not pay off. */
+static const qsizetype vectorThreshold = 32;
+
+uint8_t
+Checksum::sum8(const char *data, qsizetype len) {
+  if (len < vectorThreshold)
+    return sum8Scalar(data, len);
+  static const Kernel selected = kernel();
+  return sum8(data, len, selected);
+}
+
+uint8_t
+Checksum::xor8(const char *data, qsizetype len) {
+  if (len < vectorThreshold)
+    return xor8Scalar(data, len);
+  static const Kernel selected = kernel();
+  return xor8(data, len, selected);
+}
+
+
+uint8_t
+Checksum::sum8(const char *data, qsizetype len, Kernel kernel) {
+  switch (kernel) {
+#ifdef CHECKSUM_HAVE_AVX2
+  case Kernel::AVX2:
+    if (supported(Kernel::AVX2))
+      return sum8AVX2(data, len);
+    break;
+#endif
+#ifdef CHECKSUM_HAVE_SSE2
+  case Kernel::SSE2:
+    return sum8SSE2(data, len);
+#endif
+  default:
+    break;
+  }
+  return sum8Scalar(data, len);
+}
+
+uint8_t
+Checksum::xor8(const char *data, qsizetype len, Kernel kernel) {
+  switch (kernel) {
+#ifdef CHECKSUM_HAVE_AVX2
+  case Kernel::AVX2:
+    if (supported(Kernel::AVX2))
+      return xor8AVX2(data, len);
+    break;
+#endif
+#ifdef CHECKSUM_HAVE_SSE2
+  case Kernel::SSE2:
+    return xor8SSE2(data, len);
+#endif
+  default:
+    break;
+  }
+  return xor8Scalar(data, len);
+}
+
+
+Checksum::Kernel
+Checksum::kernel() {
+  if (supported(Kernel::AVX2))
+    return Kernel::AVX2;
+  if (supported(Kernel::SSE2))
+    return Kernel::SSE2;
+  return Kernel::Scalar;
+}
+
+bool
+Checksum::supported(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar:
+    return true;
+  case Kernel::SSE2:
+#ifdef CHECKSUM_HAVE_SSE2
+    return true;
+#else
+    return false;
+#endif
+  case Kernel::AVX2:
+#ifdef CHECKSUM_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+const char *
+Checksum::kernelName(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar: return "scalar";
+  case Kernel::SSE2: return "SSE2";
+  case Kernel::AVX2: return "AVX2";
+  }
+  return "unknown";
+}
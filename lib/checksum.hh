@@ -0,0 +1,47 @@
+#ifndef CHECKSUM_HH
+#define CHECKSUM_HH
+
+#include <QtGlobal>
+#include <cstdint>
+
+
+/** Byte-wise checksums used by the CPS protocols.
+ *
+ * The checksums are computed over raw memory ranges, hence no temporary copies of the framed
+ * data are needed. On x86 CPUs, vectorized (SSE2 and, if supported by the CPU, AVX2) kernels are
+ * used. On all other platforms, a portable scalar implementation is used. The kernel is selected
+ * once at runtime.
+ *
+ * @ingroup utils */
+class Checksum
+{
+public:
+  /** Possible checksum kernels. */
+  enum class Kernel {
+    Scalar, ///< Portable implementation.
+    SSE2,   ///< 128bit vector implementation.
+    AVX2    ///< 256bit vector implementation.
+  };
+
+public:
+  /** Returns the sum of all bytes modulo 256. */
+  static uint8_t sum8(const char *data, qsizetype len);
+  /** Returns the XOR of all bytes. */
+  static uint8_t xor8(const char *data, qsizetype len);
+
+  /** Returns the sum of all bytes modulo 256 using the specified kernel.
+   * If the kernel is not supported, the scalar implementation is used. */
+  static uint8_t sum8(const char *data, qsizetype len, Kernel kernel);
+  /** Returns the XOR of all bytes using the specified kernel.
+   * If the kernel is not supported, the scalar implementation is used. */
+  static uint8_t xor8(const char *data, qsizetype len, Kernel kernel);
+
+  /** Returns the kernel selected for this CPU. */
+  static Kernel kernel();
+  /** Returns @c true if the given kernel is supported by this build and CPU. */
+  static bool supported(Kernel kernel);
+  /** Returns the name of the given kernel. */
+  static const char *kernelName(Kernel kernel);
+};
+
+#endif // CHECKSUM_HH
@@ -11,12 +11,14 @@
  * Implementation of Device
  * ********************************************************************************************* */
 Device::Device(CodeplugPattern *pattern, ImageCollector *handler, QObject *parent)
-  : QObject{parent}, _pattern(pattern), _handler(handler), _rom()
+  : QObject{parent}, _pattern(pattern), _handler(handler), _rom(), _statistics()
 {
+  connect(this, &Device::startProgram, this, [this]() { _statistics.reset(); });
   if (_pattern)
     _pattern->setParent(this);
   if (_handler) {
     _handler->setParent(this);
+    _handler->setSizeHints(_pattern);
     connect(this, &Device::startProgram, _handler, &ImageCollector::startProgram);
     connect(this, &Device::endProgram, _handler, &ImageCollector::endProgram);
   }
@@ -56,6 +58,7 @@ Device::setHandler(ImageCollector *handler) {
 
   if (_handler) {
     _handler->setParent(this);
+    _handler->setSizeHints(_pattern);
     connect(this, &Device::startProgram, _handler, &ImageCollector::startProgram);
     connect(this, &Device::endProgram, _handler, &ImageCollector::endProgram);
   }
@@ -78,4 +81,10 @@ Device::rom() {
 }
 
 
+const DeviceStatistics &
+Device::statistics() const {
+  return _statistics;
+}
+
+
 
@@ -6,6 +6,7 @@
 #define DEVICE_HH
 
 #include "modelrom.hh"
+#include "devicestatistics.hh"
 #include <QObject>
 #include <QHash>
 #include <QPair>
@@ -38,6 +39,10 @@ public:
   const ModelRom &rom() const;
   ModelRom &rom();
 
+  /** Returns the protocol statistics of this device. These are reset at the start of each
+   * programming and must be accessed from the thread of the device only. */
+  const DeviceStatistics &statistics() const;
+
 signals:
   /** Gets emitted once the programming started. */
   void startProgram();
@@ -48,6 +53,8 @@ protected:
   CodeplugPattern *_pattern;
   ImageCollector *_handler;
   ModelRom _rom;
+  /** Protocol statistics. */
+  DeviceStatistics _statistics;
 };
 
 
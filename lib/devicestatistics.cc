@@ -0,0 +1,200 @@
+#include "devicestatistics.hh"
+#include <QTextStream>
+#include <QByteArray>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+
+/* ********************************************************************************************* *
+ * Implementation of DeviceStatistics::Histogram
+ * ********************************************************************************************* */
+DeviceStatistics::Histogram::Histogram()
+  : bins{}, count(0), total(0), max(0)
+{
+  // pass...
+}
+
+void
+DeviceStatistics::Histogram::add(int64_t ns) {
+  ns = std::max(ns, int64_t(0));
+  uint64_t us = uint64_t(ns)/1000;
+  unsigned int bin = 0;
+  while (us && (bin < (Bins-1))) {
+    us >>= 1; bin++;
+  }
+  bins[bin]++;
+  count++;
+  total += ns;
+  max = std::max(max, ns);
+}
+
+double
+DeviceStatistics::Histogram::mean() const {
+  if (0 == count)
+    return 0;
+  return double(total)/count/1000;
+}
+
+int64_t
+DeviceStatistics::Histogram::quantile(double q) const {
+  if (0 == count)
+    return 0;
+  uint64_t target = std::max(uint64_t(1), uint64_t(q*count + 0.5)), sum = 0;
+  for (unsigned int i=0; i<Bins; i++) {
+    sum += bins[i];
+    if (sum >= target)
+      return int64_t(1) << i;
+  }
+  return int64_t(1) << (Bins-1);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of DeviceStatistics
+ * ********************************************************************************************* */
+DeviceStatistics::DeviceStatistics()
+  : _start(now()), _bytesReceived(0), _bytesSent(0), _highWaterMark(0), _total(), _requests()
+{
+  // pass...
+}
+
+void
+DeviceStatistics::reset() {
+  _start = now();
+  _bytesReceived = _bytesSent = 0;
+  _highWaterMark = 0;
+  _total = Histogram();
+  _requests.clear();
+}
+
+void
+DeviceStatistics::received(int64_t bytes) {
+  if (bytes > 0)
+    _bytesReceived += bytes;
+}
+
+void
+DeviceStatistics::sent(int64_t bytes) {
+  if (bytes > 0)
+    _bytesSent += bytes;
+}
+
+void
+DeviceStatistics::buffered(int64_t bytes) {
+  _highWaterMark = std::max(_highWaterMark, bytes);
+}
+
+void
+DeviceStatistics::handled(const char *type, int64_t ns) {
+  _total.add(ns);
+
+  // There are only a handful of request types, a linear search is sufficient.
+  for (auto &request: _requests) {
+    if ((request.first == type) || (0 == std::strcmp(request.first, type))) {
+      request.second.add(ns);
+      return;
+    }
+  }
+  _requests.append({type, Histogram()});
+  _requests.back().second.add(ns);
+}
+
+uint64_t
+DeviceStatistics::bytesReceived() const {
+  return _bytesReceived;
+}
+
+uint64_t
+DeviceStatistics::bytesSent() const {
+  return _bytesSent;
+}
+
+uint64_t
+DeviceStatistics::frames() const {
+  return _total.count;
+}
+
+int64_t
+DeviceStatistics::highWaterMark() const {
+  return _highWaterMark;
+}
+
+int64_t
+DeviceStatistics::elapsed() const {
+  return now() - _start;
+}
+
+double
+DeviceStatistics::framesPerSecond() const {
+  int64_t dt = elapsed();
+  if (0 >= dt)
+    return 0;
+  return double(frames())*1e9/dt;
+}
+
+const DeviceStatistics::Histogram *
+DeviceStatistics::histogram(const char *type) const {
+  for (const auto &request: _requests) {
+    if ((request.first == type) || (0 == std::strcmp(request.first, type)))
+      return &request.second;
+  }
+  return nullptr;
+}
+
+const DeviceStatistics::Histogram &
+DeviceStatistics::histogram() const {
+  return _total;
+}
+
+void
+DeviceStatistics::report(QTextStream &stream) const {
+  double seconds = double(elapsed())/1e9;
+  stream << QString("Frames: %1 in %2s (%3 frames/s)\n")
+            .arg(frames()).arg(seconds, 0, 'f', 3).arg(framesPerSecond(), 0, 'f', 1)
+         << QString("Bytes: %1 received (%2 kB/s), %3 sent (%4 kB/s)\n")
+            .arg(_bytesReceived).arg((seconds > 0) ? _bytesReceived/seconds/1024 : 0., 0, 'f', 1)
+            .arg(_bytesSent).arg((seconds > 0) ? _bytesSent/seconds/1024 : 0., 0, 'f', 1)
+         << QString("Transmit buffer high-water mark: %1 bytes\n").arg(_highWaterMark);
+
+  stream << QString("%1 %2 %3 %4 %5 %6\n")
+            .arg(QString("Request"), -24).arg(QString("Count"), 8).arg(QString("Mean"), 10)
+            .arg(QString("p50"), 10).arg(QString("p99"), 10).arg(QString("Max"), 10);
+  auto row = [&stream](const QString &name, const Histogram &hist) {
+    stream << QString("%1 %2 %3 %4 %5 %6\n")
+              .arg(name, -24).arg(hist.count, 8)
+              .arg(QString("%1us").arg(hist.mean(), 0, 'f', 1), 10)
+              .arg(QString("<%1us").arg(hist.quantile(0.5)), 10)
+              .arg(QString("<%1us").arg(hist.quantile(0.99)), 10)
+              .arg(QString("%1us").arg(double(hist.max)/1000, 0, 'f', 1), 10);
+  };
+  for (const auto &request: _requests)
+    row(QString::fromLatin1(typeName(request.first)), request.second);
+  row("Total", _total);
+  stream.flush();
+}
+
+int64_t
+DeviceStatistics::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QByteArray
+DeviceStatistics::typeName(const char *name) {
+#if defined(__GNUG__)
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if ((0 == status) && demangled) {
+    QByteArray result(demangled);
+    std::free(demangled);
+    return result;
+  }
+  std::free(demangled);
+#endif
+  return QByteArray(name);
+}
@@ -0,0 +1,107 @@
+#ifndef DEVICESTATISTICS_HH
+#define DEVICESTATISTICS_HH
+
+#include <QVector>
+#include <QPair>
+#include <cstdint>
+
+class QTextStream;
+
+
+/** Collects latency and throughput figures of the protocol path of a device.
+ *
+ * The device records the time it takes from parsing a request, handling it and serializing the
+ * response until the response is handed to the interface. The latencies are collected per
+ * request type into histograms with logarithmic (power of two) microsecond bins. Additionally,
+ * the number of bytes received and sent, the number of frames handled and the high-water mark of
+ * the transmit buffer are recorded.
+ *
+ * The statistics are not thread-safe, they must be accessed from the thread of the device only.
+ *
+ * @ingroup device */
+class DeviceStatistics
+{
+public:
+  /** A latency histogram. */
+  struct Histogram {
+    /** Number of bins, the last bin covers everything above 2^22us (~4s). */
+    static constexpr unsigned int Bins = 24;
+
+    /** Default constructor. */
+    Histogram();
+    /** Adds a sample in nanoseconds. */
+    void add(int64_t ns);
+    /** Returns the mean latency in microseconds. */
+    double mean() const;
+    /** Returns the upper bound of the bin containing the given quantile in microseconds. */
+    int64_t quantile(double q) const;
+
+    /** Bin i counts latencies in [2^(i-1), 2^i) microseconds. */
+    uint64_t bins[Bins];
+    /** Number of samples. */
+    uint64_t count;
+    /** Sum of all samples in nanoseconds. */
+    int64_t total;
+    /** Maximum sample in nanoseconds. */
+    int64_t max;
+  };
+
+public:
+  /** Default constructor. */
+  DeviceStatistics();
+
+  /** Clears all figures and restarts the clock. */
+  void reset();
+
+  /** Records received bytes. */
+  void received(int64_t bytes);
+  /** Records sent bytes. */
+  void sent(int64_t bytes);
+  /** Records the current size of the transmit buffer. */
+  void buffered(int64_t bytes);
+  /** Records the latency of a handled request of the given type. The type name must be a
+   * static string, it is compared by address first. */
+  void handled(const char *type, int64_t ns);
+
+  /** Returns the number of bytes received. */
+  uint64_t bytesReceived() const;
+  /** Returns the number of bytes sent. */
+  uint64_t bytesSent() const;
+  /** Returns the number of frames handled. */
+  uint64_t frames() const;
+  /** Returns the high-water mark of the transmit buffer. */
+  int64_t highWaterMark() const;
+  /** Returns the time since the last reset in nanoseconds. */
+  int64_t elapsed() const;
+  /** Returns the number of frames handled per second. */
+  double framesPerSecond() const;
+
+  /** Returns the histogram for the given request type or @c nullptr if there is none. */
+  const Histogram *histogram(const char *type) const;
+  /** Returns the histogram over all requests. */
+  const Histogram &histogram() const;
+
+  /** Writes a summary into the given stream. */
+  void report(QTextStream &stream) const;
+
+  /** Returns a monotonic timestamp in nanoseconds. */
+  static int64_t now();
+  /** Returns a readable name for the given type name as obtained from @c typeid. */
+  static QByteArray typeName(const char *name);
+
+protected:
+  /** Start time of the statistics. */
+  int64_t _start;
+  /** Number of bytes received. */
+  uint64_t _bytesReceived;
+  /** Number of bytes sent. */
+  uint64_t _bytesSent;
+  /** High-water mark of the transmit buffer. */
+  int64_t _highWaterMark;
+  /** The latency over all requests. */
+  Histogram _total;
+  /** The latencies per request type. */
+  QVector<QPair<const char *, Histogram>> _requests;
+};
+
+#endif // DEVICESTATISTICS_HH
@@ -0,0 +1,108 @@
+#include "dirtyset.hh"
+#include <algorithm>
+
+
+/* ********************************************************************************************* *
+ * Implementation of DirtySet::Range
+ * ********************************************************************************************* */
+uint64_t
+DirtySet::Range::end() const {
+  return uint64_t(address) + size;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of DirtySet
+ * ********************************************************************************************* */
+DirtySet::DirtySet()
+  : _ranges()
+{
+  // pass...
+}
+
+void
+DirtySet::add(uint32_t address, uint32_t size) {
+  if (0 == size)
+    return;
+
+  uint64_t end = uint64_t(address) + size;
+  // Fast path: extends or lies within the last range
+  if ((! _ranges.isEmpty()) && (_ranges.back().address <= address)
+      && (_ranges.back().end() >= address)) {
+    Range &last = _ranges.back();
+    last.size = std::max(last.end(), end) - last.address;
+    return;
+  }
+
+  // First range ending at or behind the address, that is, the first range to merge.
+  auto first = std::partition_point(_ranges.begin(), _ranges.end(), [address](const Range &r) {
+    return r.end() < address;
+  });
+  // First range starting behind the new one, that is, the first not to merge.
+  auto last = std::partition_point(first, _ranges.end(), [end](const Range &r) {
+    return r.address <= end;
+  });
+
+  if (first == last) {
+    _ranges.insert(first, {address, size});
+    return;
+  }
+
+  uint32_t start = std::min(address, first->address);
+  uint64_t stop = std::max(end, (last-1)->end());
+  auto idx = first - _ranges.begin();
+  _ranges.erase(first+1, last);
+  _ranges[idx] = {start, uint32_t(stop - start)};
+}
+
+void
+DirtySet::add(const DirtySet &other) {
+  for (const Range &range: other)
+    add(range.address, range.size);
+}
+
+void
+DirtySet::clear() {
+  _ranges.clear();
+}
+
+bool
+DirtySet::isEmpty() const {
+  return _ranges.isEmpty();
+}
+
+qsizetype
+DirtySet::count() const {
+  return _ranges.size();
+}
+
+const DirtySet::Range &
+DirtySet::range(qsizetype i) const {
+  return _ranges.at(i);
+}
+
+bool
+DirtySet::contains(uint32_t address) const {
+  auto range = std::partition_point(_ranges.begin(), _ranges.end(), [address](const Range &r) {
+    return r.end() <= address;
+  });
+  return (_ranges.end() != range) && (range->address <= address);
+}
+
+uint64_t
+DirtySet::bytes() const {
+  uint64_t total = 0;
+  for (const Range &range: _ranges)
+    total += range.size;
+  return total;
+}
+
+DirtySet::const_iterator
+DirtySet::begin() const {
+  return _ranges.begin();
+}
+
+DirtySet::const_iterator
+DirtySet::end() const {
+  return _ranges.end();
+}
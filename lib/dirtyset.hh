@@ -0,0 +1,63 @@
+#ifndef DIRTYSET_HH
+#define DIRTYSET_HH
+
+#include <cstdint>
+#include <QVector>
+#include <QMetaType>
+
+
+/** A set of modified address ranges.
+ *
+ * The ranges are kept sorted and disjoint. Adding a range coalesces it with all overlapping and
+ * adjacent ranges, hence a sequential write of any length results in a single range. Adding a
+ * range extending the last one is a fast path, that needs no search.
+ *
+ * @ingroup codeplug */
+class DirtySet
+{
+public:
+  /** A modified address range. */
+  struct Range {
+    /** The start address. */
+    uint32_t address;
+    /** The size in bytes. */
+    uint32_t size;
+    /** Returns the address just behind the range. */
+    uint64_t end() const;
+  };
+
+  typedef QVector<Range>::const_iterator const_iterator;
+
+public:
+  /** Constructs an empty set. */
+  DirtySet();
+
+  /** Adds the given range. */
+  void add(uint32_t address, uint32_t size);
+  /** Adds all ranges of the given set. */
+  void add(const DirtySet &other);
+  /** Removes all ranges. */
+  void clear();
+
+  /** Returns @c true if there are no ranges. */
+  bool isEmpty() const;
+  /** Returns the number of disjoint ranges. */
+  qsizetype count() const;
+  /** Returns the i-th range. */
+  const Range &range(qsizetype i) const;
+  /** Returns @c true if the given address is within any range. */
+  bool contains(uint32_t address) const;
+  /** Returns the total number of bytes covered. */
+  uint64_t bytes() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+protected:
+  /** The sorted, disjoint ranges. */
+  QVector<Range> _ranges;
+};
+
+Q_DECLARE_METATYPE(DirtySet)
+
+#endif // DIRTYSET_HH
@@ -0,0 +1,69 @@
+#include "emulationserver.hh"
+#include "device.hh"
+#include "logger.hh"
+#include <QThread>
+#include <algorithm>
+
+
+/* ********************************************************************************************* *
+ * Implementation of EmulationServer
+ * ********************************************************************************************* */
+EmulationServer::EmulationServer(unsigned int workers, QObject *parent)
+  : QObject{parent}, _workers(), _load(), _devices()
+{
+  if (0 == workers)
+    workers = std::max(1, QThread::idealThreadCount());
+
+  for (unsigned int i=0; i<workers; i++) {
+    auto worker = new QThread(this);
+    worker->setObjectName(QString("worker%1").arg(i));
+    _workers.append(worker);
+    _load.append(0);
+  }
+}
+
+EmulationServer::~EmulationServer() {
+  // Devices of workers that never ran are still owned.
+  foreach (Device *device, _devices) {
+    if (! device->thread()->isRunning())
+      delete device;
+  }
+  // All others get deleted once their worker stops.
+  foreach (QThread *worker, _workers)
+    worker->quit();
+  foreach (QThread *worker, _workers)
+    worker->wait();
+}
+
+unsigned int
+EmulationServer::workers() const {
+  return _workers.size();
+}
+
+unsigned int
+EmulationServer::count() const {
+  return _devices.size();
+}
+
+void
+EmulationServer::add(Device *device) {
+  int idx = std::min_element(_load.begin(), _load.end()) - _load.begin();
+  QThread *worker = _workers[idx];
+  _load[idx]++;
+
+  device->setParent(nullptr);
+  device->moveToThread(worker);
+  // Device gets deleted within the worker, once its event loop exits.
+  connect(worker, &QThread::finished, device, &QObject::deleteLater);
+  _devices.append(device);
+
+  logDebug() << "Serve device " << _devices.size() << " by " << worker->objectName() << ".";
+}
+
+void
+EmulationServer::start() {
+  foreach (QThread *worker, _workers) {
+    if (! worker->isRunning())
+      worker->start();
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef EMULATIONSERVER_HH
+#define EMULATIONSERVER_HH
+
+#include <QObject>
+#include <QVector>
+
+class Device;
+class QThread;
+
+
+/** Serves several device emulations from a single process.
+ *
+ * The devices are distributed over a small, fixed pool of worker threads. Each worker runs its own
+ * event loop, driven by the socket notifiers of the interfaces of its devices. Hence, a busy
+ * instance only delays the devices sharing its worker, while the interfaces itself never block.
+ *
+ * @ingroup device */
+class EmulationServer: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a server with the given number of workers. If @c workers is 0, the number of
+   * workers is derived from the number of cores. */
+  explicit EmulationServer(unsigned int workers = 0, QObject *parent = nullptr);
+  /** Destructor. Stops all workers and deletes all devices. */
+  ~EmulationServer() override;
+
+  /** Returns the number of worker threads. */
+  unsigned int workers() const;
+  /** Returns the number of devices served. */
+  unsigned int count() const;
+
+  /** Adds a device to the server and takes ownership. The device must not have a parent and
+   * gets moved to the worker with the least number of devices. Call @c start to run the
+   * workers. */
+  void add(Device *device);
+
+  /** Starts all workers. */
+  void start();
+
+protected:
+  /** The worker threads. */
+  QVector<QThread *> _workers;
+  /** Number of devices assigned to each worker. */
+  QVector<unsigned int> _load;
+  /** The devices served. */
+  QVector<Device *> _devices;
+};
+
+#endif // EMULATIONSERVER_HH
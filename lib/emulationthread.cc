@@ -0,0 +1,39 @@
+#include "emulationthread.hh"
+#include "device.hh"
+#include "pattern.hh"
+#include "logger.hh"
+
+
+/* ********************************************************************************************* *
+ * Implementation of EmulationThread
+ * ********************************************************************************************* */
+EmulationThread::EmulationThread(Device *device, QObject *parent)
+  : QThread{parent}, _device(device)
+{
+  setObjectName("emulation");
+
+  // The pattern is edited by the GUI, keep it within the current thread.
+  if (_device->pattern())
+    _device->pattern()->setParent(this);
+
+  _device->setParent(nullptr);
+  _device->moveToThread(this);
+  // Device gets deleted within the thread, once the event loop exits.
+  connect(this, &QThread::finished, _device, &QObject::deleteLater);
+}
+
+EmulationThread::~EmulationThread() {
+  if (isRunning()) {
+    logDebug() << "Stop emulation thread.";
+    quit();
+    wait();
+  } else if (! isFinished()) {
+    // Never started, device still owned.
+    delete _device;
+  }
+}
+
+Device *
+EmulationThread::device() const {
+  return _device;
+}
@@ -0,0 +1,36 @@
+#ifndef EMULATIONTHREAD_HH
+#define EMULATIONTHREAD_HH
+
+#include <QThread>
+
+class Device;
+
+
+/** Runs a device emulation within its own event loop.
+ *
+ * The device, its interface and its handler get moved to this thread. Hence, the communication
+ * with the CPS is not blocked by a busy GUI (e.g., while rendering a large hex dump or diff).
+ * The codeplug pattern of the device is edited by the GUI and remains within the thread that
+ * created this object.
+ *
+ * @ingroup device */
+class EmulationThread: public QThread
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a new thread for the given device and takes ownership of it. The device must not
+   * have a parent. Call @c start to run the emulation. */
+  explicit EmulationThread(Device *device, QObject *parent = nullptr);
+  /** Destructor. Stops the thread and deletes the device. */
+  ~EmulationThread() override;
+
+  /** Returns the device. */
+  Device *device() const;
+
+protected:
+  /** The device, lives within the thread. */
+  Device *_device;
+};
+
+#endif // EMULATIONTHREAD_HH
@@ -0,0 +1,129 @@
+#include "framebuffer.hh"
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+
+
+/* ********************************************************************************************* *
+ * Implementation of FrameBuffer
+ * ********************************************************************************************* */
+FrameBuffer::FrameBuffer(qsizetype capacity)
+  : _data(), _head(0)
+{
+  if (capacity)
+    _data.reserve(capacity);
+}
+
+
+bool
+FrameBuffer::startsWith(QByteArrayView prefix) const {
+  if (size() < prefix.size())
+    return false;
+  return 0 == std::memcmp(constData(), prefix.data(), prefix.size());
+}
+
+bool
+FrameBuffer::startsWith(char c) const {
+  return (! isEmpty()) && (c == front());
+}
+
+
+QByteArrayView
+FrameBuffer::view(qsizetype offset, qsizetype len) const {
+  return QByteArrayView(constData() + offset, len);
+}
+
+QByteArrayView
+FrameBuffer::view() const {
+  return QByteArrayView(constData(), size());
+}
+
+QByteArray
+FrameBuffer::raw(qsizetype offset, qsizetype len) const {
+  return QByteArray::fromRawData(constData() + offset, len);
+}
+
+
+void
+FrameBuffer::consume(qsizetype n) {
+  _head = std::min(_head + n, _data.size());
+}
+
+void
+FrameBuffer::clear() {
+  _data.resize(0);
+  _head = 0;
+}
+
+
+void
+FrameBuffer::append(const char *data, qsizetype len) {
+  compact();
+  _data.append(data, len);
+}
+
+void
+FrameBuffer::append(QByteArrayView data) {
+  append(data.data(), data.size());
+}
+
+qint64
+FrameBuffer::readFrom(QIODevice *device) {
+  compact();
+
+  qint64 total = 0;
+  while (true) {
+    qsizetype chunk = std::max(device->bytesAvailable(), qint64(4096));
+    qsizetype offset = _data.size();
+    if (_data.capacity() < (offset+chunk))
+      _data.reserve(2*(offset+chunk));
+    _data.resize(offset + chunk);
+    qint64 n = device->read(_data.data() + offset, chunk);
+    _data.resize(offset + std::max(n, qint64(0)));
+    if (n <= 0)
+      break;
+    total += n;
+    if (n < chunk)
+      break;
+  }
+
+  return total;
+}
+
+qint64
+FrameBuffer::writeTo(QIODevice *device) {
+  if (isEmpty())
+    return 0;
+
+  qint64 n = device->write(constData(), size());
+  if (n > 0)
+    consume(n);
+  return n;
+}
+
+
+QByteArray &
+FrameBuffer::buffer() {
+  compact();
+  return _data;
+}
+
+
+void
+FrameBuffer::compact() {
+  if (0 == _head)
+    return;
+
+  if (_head == _data.size()) {
+    // Everything consumed, just rewind (keeps the capacity).
+    _data.resize(0);
+    _head = 0;
+  } else if (_head >= (_data.size() - _head)) {
+    // Less bytes left than consumed, move left-over to the front. This way, the moved bytes can
+    // be accounted to the consumed ones.
+    qsizetype left = _data.size() - _head;
+    std::memmove(_data.data(), _data.constData() + _head, left);
+    _data.resize(left);
+    _head = 0;
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef FRAMEBUFFER_HH
+#define FRAMEBUFFER_HH
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+class QIODevice;
+
+
+/** A receive/transmit buffer for framed protocols.
+ *
+ * The buffer keeps its content in a single contiguous block of memory and tracks a read position
+ * (head) within it. Consuming a frame just advances the head, hence parsers can take views
+ * into the buffered data without copying it. The space in front of the head gets reclaimed lazily
+ * once new data is appended. Then, only the not yet consumed bytes (usually a fraction of a single
+ * frame) are moved to the front. That is, the costs of buffer handling scale with the frame size
+ * and not with the amount of buffered data.
+ *
+ * Views obtained by @c view, @c constData or @c raw remain valid until the next call to
+ * @c append, @c buffer or @c clear.
+ *
+ * @ingroup device */
+class FrameBuffer
+{
+public:
+  /** Constructs an empty buffer, with the given initial capacity. */
+  explicit FrameBuffer(qsizetype capacity = 0);
+
+  /** Returns the number of bytes not consumed yet. */
+  inline qsizetype size() const { return _data.size() - _head; }
+  /** Returns @c true if there are no bytes left. */
+  inline bool isEmpty() const { return 0 == size(); }
+
+  /** Returns a pointer to the first byte not consumed yet. */
+  inline const char *constData() const { return _data.constData() + _head; }
+  /** Returns the i-th byte, relative to the head. */
+  inline char at(qsizetype i) const { return _data.at(_head + i); }
+  /** Returns the i-th byte, relative to the head. */
+  inline char operator[](qsizetype i) const { return at(i); }
+  /** Returns the first byte, the buffer must not be empty. */
+  inline char front() const { return at(0); }
+
+  /** Returns @c true if the buffer starts with the given bytes. */
+  bool startsWith(QByteArrayView prefix) const;
+  /** Returns @c true if the buffer starts with the given byte. */
+  bool startsWith(char c) const;
+
+  /** Returns a view of @c len bytes starting at @c offset (relative to the head). */
+  QByteArrayView view(qsizetype offset, qsizetype len) const;
+  /** Returns a view of all remaining bytes. */
+  QByteArrayView view() const;
+  /** Returns a non-owning @c QByteArray of @c len bytes starting at @c offset.
+   * This is just a convenience function to pass payloads to APIs using @c QByteArray. Any
+   * receiver storing such a byte array must detach it first. */
+  QByteArray raw(qsizetype offset, qsizetype len) const;
+
+  /** Marks the first @c n bytes as consumed. */
+  void consume(qsizetype n);
+  /** Drops all bytes. */
+  void clear();
+
+  /** Appends some data. */
+  void append(const char *data, qsizetype len);
+  /** Appends some data. */
+  void append(QByteArrayView data);
+  /** Reads all available data from the given device and appends it. */
+  qint64 readFrom(QIODevice *device);
+  /** Writes as much data as possible to the given device and consumes the written bytes. */
+  qint64 writeTo(QIODevice *device);
+
+  /** Returns the underlying storage for appending data directly, e.g., for serializing responses.
+   * Only appending to the returned byte array is allowed. */
+  QByteArray &buffer();
+
+protected:
+  /** Reclaims the space of already consumed bytes. */
+  void compact();
+
+protected:
+  /** The storage. */
+  QByteArray _data;
+  /** Index of the first byte not consumed yet. */
+  qsizetype _head;
+};
+
+#endif // FRAMEBUFFER_HH
@@ -5,6 +5,7 @@
 
 #include "errorstack.hh"
 #include "device.hh"
+#include "framebuffer.hh"
 
 
 
@@ -63,10 +64,10 @@ public:
                          QObject *parent = nullptr);
 
 protected:
-  /** Parses the given buffer and returns the parsed request. Also removes the consumed data from
+  /** Parses the given buffer and returns the parsed request. Also consumes the parsed data from
    * the buffer. Retruns @c null, if not sufficient data is held in the buffer. If null is
    * returned and ok is false, the an error occured. */
-  virtual GenericRequest *parse(QByteArray &buffer, bool &ok, const ErrorStack &errP=ErrorStack()) = 0;
+  virtual GenericRequest *parse(FrameBuffer &buffer, bool &ok, const ErrorStack &errP=ErrorStack()) = 0;
   /** Handles a request and constructs an appropriate response. */
   virtual GenericResponse *handle(GenericRequest *request) = 0;
 
@@ -78,8 +79,8 @@ protected slots:
 
 protected:
   QIODevice *_interface;
-  QByteArray _in_buffer;
-  QByteArray _out_buffer;
+  FrameBuffer _in_buffer;
+  FrameBuffer _out_buffer;
 };
 
 
@@ -1,7 +1,16 @@
 #include "hexdump.hh"
 #include "image.hh"
 #include "annotation.hh"
+#include "hexformat.hh"
+#include "blockcompare.hh"
+#include <QtAlgorithms>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <optional>
+#include <vector>
+#include <cstring>
 
 
 /* ********************************************************************************************* *
@@ -132,50 +141,292 @@ HexLine::hasDiff() const {
 }
 
 
+/* ********************************************************************************************* *
+ * Helper functions
+ * ********************************************************************************************* */
+/** Size of the output buffer. Formatted lines are collected and written in chunks of this size. */
+static const qsizetype HexBufferSize = 0x4000;
+
+/** Returns the offset of the line containing the byte at the given offset, relative to the
+ * element starting at @c address. */
+static inline qsizetype
+lineOffset(uint32_t address, qsizetype offset) {
+  qsizetype lineStart = qsizetype(((address+offset)>>4)<<4) - qsizetype(address);
+  return std::max(lineStart, qsizetype(0));
+}
+
+/** Copies @c len bytes at the given offset from the pages of the element. Returns an empty
+ * array if the element is @c nullptr or shorter. */
+static QByteArray
+slice(const Element *element, qsizetype offset, qsizetype len) {
+  if (nullptr == element)
+    return QByteArray();
+  return element->read(offset, len);
+}
+
+/** Returns @c true if both images are duplicates of the same original. */
+static bool
+sameOriginal(const Image *left, const Image *right) {
+  const Image *leftOriginal = left->duplicateOf() ? left->duplicateOf() : left;
+  const Image *rightOriginal = right->duplicateOf() ? right->duplicateOf() : right;
+  return leftOriginal == rightOriginal;
+}
+
+/** Calls @c fn for each line of the hex dump of the element. Only a single line exists at a time. */
+template <class Func>
+static void
+forEachLine(const Element *element, Func fn) {
+  uint32_t address = element->address().byte();
+  qsizetype size = element->size().byte();
+  for (qsizetype offset=0; offset<size;) {
+    qsizetype n = 0x10 - ((address+offset) & 0xf);
+    HexLine line(address+offset, slice(element, offset, n));
+    offset += line.consumed();
+    fn(line);
+  }
+}
+
+/** Returns the offset of the line following the one starting at the given offset. */
+static inline qsizetype
+nextLine(uint32_t address, qsizetype offset) {
+  return offset + (0x10 - ((address+offset) & 0xf));
+}
+
+/** Calls @c fn for each line of the hex difference between the elements, that contains a
+ * difference. Either may be @c nullptr. For elements at the same address, identical pages are
+ * skipped and the remaining ones are compared block-wise first (see @c BlockCompare). Lines are
+ * only created for differing blocks. Only the lines starting within [from, to) relative to the
+ * elements are considered, @c from must be the start of a line (see @c lineOffset). */
+template <class Func>
+static void
+forEachDiffLine(const Element *left, const Element *right, qsizetype from, qsizetype to, Func fn) {
+  uint32_t address = 0;
+  qsizetype left_size = 0, right_size = 0;
+  if (left) {
+    address = left->address().byte();
+    left_size = left->size().byte();
+  }
+  if (right) {
+    address = right->address().byte();
+    right_size = right->size().byte();
+  }
+
+  // Offset of the next line not created yet, unaligned blocks may overlap with the same line.
+  qsizetype next = from;
+  auto createLine = [&](qsizetype offset) {
+    if ((offset < next) || (offset >= to))
+      return;
+    qsizetype n = 0x10 - ((address+offset) & 0xf);
+    HexLine line(address+offset, slice(left, offset, n), slice(right, offset, n));
+    next = offset + line.consumed();
+    if (line.hasDiff())
+      fn(line);
+  };
+
+  // Pages can only be compared if both elements start at the same address.
+  qsizetype common = 0;
+  if (left && right && (left->address() == right->address()))
+    common = std::min(left_size, right_size);
+
+  // Pages holding any byte of the lines within the range.
+  uint64_t bitmap[BlockCompare::bitmapSize(Element::PageSize)];
+  for (qsizetype page=from/Element::PageSize;
+       ((page*Element::PageSize)<common) && ((page*Element::PageSize)<(to+HexFormat::LineSize));
+       page++)
+  {
+    if (left->samePage(right, page))
+      continue;
+    qsizetype start = page*Element::PageSize;
+    qsizetype len = std::min(qsizetype(Element::PageSize), common-start);
+    if (0 == BlockCompare::compare(left->page(page).data(), right->page(page).data(), len, bitmap))
+      continue;
+    for (qsizetype w=0; w<BlockCompare::bitmapSize(len); w++) {
+      for (uint64_t bits=bitmap[w]; bits; bits &= (bits-1)) {
+        qsizetype block = start + (64*w + qCountTrailingZeroBits(bits))*BlockCompare::BlockSize;
+        qsizetype end = std::min(block + BlockCompare::BlockSize, start + len);
+        // If the element is not aligned, a block overlaps with two lines.
+        for (qsizetype offset=lineOffset(address, block); offset<end;
+             offset=nextLine(address, offset))
+          createLine(offset);
+      }
+    }
+  }
+
+  // The remaining bytes are present in one element only
+  for (qsizetype offset=std::max(from, lineOffset(address, common));
+       (offset<std::max(left_size, right_size)) && (offset<to);
+       offset=std::max(next, nextLine(address, offset)))
+    createLine(offset);
+}
+
+/** Calls @c fn for each line of the hex difference between the elements, that contains a
+ * difference. */
+template <class Func>
+static void
+forEachDiffLine(const Element *left, const Element *right, Func fn) {
+  qsizetype size = std::max(left ? left->size().byte() : 0U, right ? right->size().byte() : 0U);
+  forEachDiffLine(left, right, 0, size, fn);
+}
+
+/** Calls @c fn for each pair of elements of both images, matched by their address. Elements
+ * present in only one of the images are paired with @c nullptr. */
+template <class Func>
+static void
+forEachElement(const Image *left, const Image *right, Func fn) {
+  for (unsigned int i=0,j=0; (i<left->count()) || (j<right->count());) {
+    if ((i<left->count()) && (j<right->count())) {
+      if (left->element(i)->address() < right->element(j)->address()) {
+        fn(left->element(i++), nullptr);
+      } else if (left->element(i)->address() > right->element(j)->address()) {
+        fn(nullptr, right->element(j++));
+      } else {
+        fn(left->element(i++), right->element(j++));
+      }
+    } else if (i<left->count()) {
+      fn(left->element(i++), nullptr);
+    } else if (j<right->count()) {
+      fn(nullptr, right->element(j++));
+    }
+  }
+}
+
+/** Calls @c fn for each index in [0, count) using the idle threads of the pool and the calling
+ * thread. Each worker takes the next index until all are done. Returns once all calls finished. */
+template <class Func>
+static void
+forEachParallel(QThreadPool *pool, int count, Func fn) {
+  QAtomicInt next(0);
+  auto work = [&fn, &next, count]() {
+    for (int i=next.fetchAndAddRelaxed(1); i<count; i=next.fetchAndAddRelaxed(1))
+      fn(i);
+  };
+
+  // Only idle threads of the pool are used, the calling thread works too.
+  QSemaphore done;
+  int workers = 0;
+  for (int i=1; (i<pool->maxThreadCount()) && (i<count); i++) {
+    if (! pool->tryStart([&work, &done]() { work(); done.release(); }))
+      break;
+    workers++;
+  }
+  work();
+  done.acquire(workers);
+}
+
+/** Appends a formatted hex-dump line to the buffer. Only the bytes whose bit is set in @c used are
+ * shown, all other bytes must be 0. */
+static void
+formatDumpLine(uint32_t address, const uint8_t *bytes, uint16_t used, QByteArray &buffer) {
+  // address, " :  ", values, " | ", chars and newline
+  qsizetype pos = buffer.size();
+  buffer.resize(pos + HexFormat::AddressLength + 4 + HexFormat::ValuesLength + 3
+                + HexFormat::CharsLength + 1);
+  char *out = buffer.data() + pos;
+  HexFormat::formatAddress(address, out);
+  out += HexFormat::AddressLength;
+  std::memcpy(out, " :  ", 4);
+  out += 4;
+  HexFormat::formatLine(bytes, out, out + HexFormat::ValuesLength + 3, ' ');
+  for (int k=0; k<HexFormat::LineSize; k++) {
+    if (0 == (used & (1<<k)))
+      std::memcpy(out + 3*k, "   ", 3);
+  }
+  std::memcpy(out + HexFormat::ValuesLength, " | ", 3);
+  out[HexFormat::ValuesLength + 3 + HexFormat::CharsLength] = '\n';
+}
+
+/** Appends the formatted hex-dump line to the buffer. */
+static void
+formatDumpLine(const HexLine &line, QByteArray &buffer) {
+  uint8_t bytes[HexFormat::LineSize];
+  uint16_t used = 0;
+  for (int k=0; k<HexFormat::LineSize; k++) {
+    bytes[k] = line.left(k).value;
+    if (HexLine::Byte::Unused != line.left(k).type)
+      used |= (1<<k);
+  }
+  formatDumpLine(line.address(), bytes, used, buffer);
+}
+
+/** Appends one side of a hex-difference line to the buffer, either the values or the chars. */
+static void
+formatDiffSide(const QVector<HexLine::Byte> &bytes, bool chars, const char *unused,
+               QByteArray &buffer)
+{
+  uint8_t values[HexFormat::LineSize];
+  for (int k=0; k<HexFormat::LineSize; k++)
+    values[k] = bytes[k].value;
+  char text[HexFormat::ValuesLength];
+  if (chars)
+    HexFormat::formatLine(values, nullptr, text, ' ');
+  else
+    HexFormat::formatLine(values, text, nullptr);
+
+  for (int k=0; k<HexFormat::LineSize; k++) {
+    if ((! chars) && (HexLine::Byte::Unused == bytes[k].type)) {
+      buffer.append(unused);
+      continue;
+    }
+    buffer.append((HexLine::Byte::Keep == bytes[k].type) ? "\033[2m" : "\033[1m");
+    if (chars)
+      buffer.append(text[k]);
+    else
+      buffer.append(text + 3*k, 2);
+    buffer.append(chars ? "\033[0m" : "\033[0m ");
+  }
+}
+
+/** Appends the formatted hex-difference line to the buffer. */
+static void
+formatDiffLine(const HexLine &line, QByteArray &buffer) {
+  char address[HexFormat::AddressLength];
+  HexFormat::formatAddress(line.address(), address);
+  buffer.append(address, HexFormat::AddressLength);
+  buffer.append(": ");
+  formatDiffSide(line.left(), false, "  ", buffer);
+  buffer.append("> ");
+  formatDiffSide(line.right(), false, "   ", buffer);
+  buffer.append("| ");
+  formatDiffSide(line.left(), true, nullptr, buffer);
+  buffer.append(" > ");
+  formatDiffSide(line.right(), true, nullptr, buffer);
+  buffer.append('\n');
+}
+
+/** Writes the buffer into the stream, once it holds at least @c threshold bytes. The capacity of
+ * the buffer is kept. */
+static void
+writeBuffer(QByteArray &buffer, QTextStream &stream, qsizetype threshold=0) {
+  if (buffer.isEmpty() || (buffer.size() < threshold))
+    return;
+  stream << QLatin1String(buffer.constData(), buffer.size());
+  buffer.resize(0);
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of HexElement
  * ********************************************************************************************* */
 HexElement::HexElement(const Element *element)
   : _lines(), _address(element->address().byte()), _isDiff(false), _hasDiff(false)
 {
-  uint32_t address = _address;
-  QByteArray data = element->data();
-
-  for (int offset=0; offset<data.size();) {
-    HexLine line(address, data.right(data.size()-offset));
-    address += line.consumed();
-    offset  += line.consumed();
+  forEachLine(element, [this](const HexLine &line) {
     _lines.append(line);
-  }
+  });
 }
 
 HexElement::HexElement(const Element *left, const Element *right)
   : _lines(), _address(0), _isDiff(true), _hasDiff(false)
 {
-  uint32_t address;
-  QByteArray left_data, right_data;
-
-  if (left) {
-    address = _address = left->address().byte();
-    left_data = left->data();
-  }
-  if (right) {
-    address = _address = right->address().byte();
-    right_data = right->data();
-  }
+  if (left)
+    _address = left->address().byte();
+  if (right)
+    _address = right->address().byte();
 
-  for (int offset=0; offset<std::max(left_data.size(), right_data.size());) {
-    QByteArray left_line, right_line;
-    if (offset < left_data.size())
-      left_line = left_data.mid(offset, 16);
-    if (offset < right_data.size())
-      right_line = right_data.mid(offset, 16);
-    HexLine line(address, left_line, right_line);
-    address += line.consumed();
-    offset  += line.consumed();
+  forEachDiffLine(left, right, [this](const HexLine &line) {
     _lines.append(line);
-    _hasDiff |= line.hasDiff();
-  }
+    _hasDiff = true;
+  });
 }
 
 HexElement::HexElement(const HexElement &other)
@@ -232,30 +483,42 @@ HexImage::HexImage(const Image *image)
 HexImage::HexImage(const Image *left, const Image *right)
   : _elements(), _isDiff(false), _hasDiff(false)
 {
-  for (unsigned int i=0,j=0; (i<left->count()) || (j<right->count());) {
-    if ((i<left->count()) && (j<right->count())) {
-      if (left->element(i)->address() < right->element(j)->address()) {
-        _elements.append(HexElement(left->element(i), nullptr));
-        _hasDiff |= _elements.last().hasDiff();
-        i++;
-      } else if (left->element(i)->address() > right->element(j)->address()) {
-        _elements.append(HexElement(nullptr, right->element(j)));
-        _hasDiff |= _elements.last().hasDiff();
-        j++;
-      } else {
-        _elements.append(HexElement(left->element(i), right->element(j)));
-        _hasDiff |= _elements.last().hasDiff();
-        i++; j++;
-      }
-    } else if (i<left->count()) {
-      _elements.append(HexElement(left->element(i), nullptr));
-      _hasDiff |= _elements.last().hasDiff();
-      i++;
-    } else if (j<right->count()) {
-      _elements.append(HexElement(nullptr, right->element(j)));
-      _hasDiff |= _elements.last().hasDiff();
-      j++;
-    }
+  // Duplicates of the same image have no differences.
+  if (sameOriginal(left, right))
+    return;
+
+  forEachElement(left, right, [this](const Element *l, const Element *r) {
+    _elements.append(HexElement(l, r));
+    _hasDiff |= _elements.last().hasDiff();
+  });
+}
+
+HexImage::HexImage(const Image *left, const Image *right, QThreadPool *pool)
+  : _elements(), _isDiff(false), _hasDiff(false)
+{
+  // Duplicates of the same image have no differences.
+  if (sameOriginal(left, right))
+    return;
+
+  // Pair the elements first. The content of the elements is read here, such that the workers
+  // access the pages only.
+  QVector<QPair<const Element *, const Element *>> pairs;
+  forEachElement(left, right, [&pairs](const Element *l, const Element *r) {
+    if (l) l->pageCount();
+    if (r) r->pageCount();
+    pairs.append({l, r});
+  });
+
+  // The results are stored by the index of the pair, hence the order does not depend on the
+  // scheduling.
+  std::vector<std::optional<HexElement>> results(pairs.size());
+  forEachParallel(pool, pairs.size(), [&pairs, &results](int i) {
+    results[i].emplace(pairs[i].first, pairs[i].second);
+  });
+
+  for (const std::optional<HexElement> &element: results) {
+    _elements.append(*element);
+    _hasDiff |= element->hasDiff();
   }
 }
 
@@ -283,87 +546,158 @@ HexImage::hasDiff() const {
  * Implementation of hexdump(HexImage)
  * ********************************************************************************************* */
 void hexdump(const HexImage &hex, QTextStream &stream) {
-  stream << "\033[0m";
+  QByteArray buffer("\033[0m");
   for (unsigned int i=0,c=0; i<hex.size(); i++) {
-    const HexElement element=hex.element(i);
+    const HexElement &element=hex.element(i);
     // If it is just a dump or the element contains a difference
     if ((!element.isDiff()) || element.hasDiff()) {
       // Just prepend an empty line before every element within the image,
       // just not before the first
-      if (c++) stream << Qt::endl;
+      if (c++) buffer.append('\n');
 
       for (unsigned j=0; j<element.size(); j++) {
-        const HexLine line = element.line(j);
-        if (! line.isDiff()) {
-          // If just a dump -> dump every line
-          stream << Qt::hex << qSetFieldWidth(8) << qSetPadChar(QChar('0')) << line.address()
-                 << qSetFieldWidth(0) << " :  ";
-          for (int k=0; k<16; k++) {
-            if (HexLine::Byte::Unused == line.left(k).type)
-              stream << "   ";
-            else
-              stream << qSetFieldWidth(2) << line.left(k).value
-                     << qSetFieldWidth(0) << " ";
-
-          }
-          stream << " | ";
-          for (int k=0; k<16; k++) {
-            if ((line.left(k).value >=0x20) && (line.left(k).value<0x7f))
-              stream << (char)line.left(k).value;
-            else
-              stream << " ";
-          }
-          stream << Qt::endl;
-        } else if (line.hasDiff()) {
-          // If line contains a difference
-          stream << Qt::hex << qSetFieldWidth(8) << qSetPadChar(QChar('0')) << line.address()
-                 << qSetFieldWidth(0) << ": ";
-          for (int k=0; k<16; k++) {
-            if (HexLine::Byte::Unused == line.left(k).type)
-              stream << "  ";
-            else if (HexLine::Byte::Keep == line.left(k).type)
-              stream << "\033[2m"
-                     << qSetFieldWidth(2) << line.left(k).value
-                     << qSetFieldWidth(0) << "\033[0m ";
-            else
-              stream << "\033[1m"
-                     << qSetFieldWidth(2) << line.left(k).value
-                     << qSetFieldWidth(0) << "\033[0m ";
-          }
-          stream << "> ";
-          for (int k=0; k<16; k++) {
-            if (HexLine::Byte::Unused == line.right(k).type)
-              stream << "   ";
-            else if (HexLine::Byte::Keep == line.right(k).type)
-              stream << "\033[2m"
-                     << qSetFieldWidth(2) << line.right(k).value
-                     << qSetFieldWidth(0) << "\033[0m ";
-            else
-              stream << "\033[1m"
-                     << qSetFieldWidth(2) << line.right(k).value
-                     << qSetFieldWidth(0) << "\033[0m ";
-          }
-          stream << "| ";
-          for (int k=0; k<16; k++) {
-            char c = ((line.left(k).value>=0x20) && (line.left(k).value<0x7f)) ?
-                  line.left(k).value : ' ';
-            if (HexLine::Byte::Keep == line.left(k).type)
-              stream << "\033[2m" << c << "\033[0m";
-            else
-              stream << "\033[1m" << c << "\033[0m";
-          }
-          stream << " > ";
-          for (int k=0; k<16; k++) {
-            char c = ((line.right(k).value>=0x20) && (line.right(k).value<0x7f)) ?
-                  line.right(k).value : ' ';
-            if (HexLine::Byte::Keep == line.right(k).type)
-              stream << "\033[2m" << c << "\033[0m";
-            else
-              stream << "\033[1m" << c << "\033[0m";
-          }
-          stream << Qt::endl;
-        }
+        const HexLine &line = element.line(j);
+        if (! line.isDiff())
+          formatDumpLine(line, buffer);   // If just a dump -> dump every line
+        else if (line.hasDiff())
+          formatDiffLine(line, buffer);   // If line contains a difference
+        writeBuffer(buffer, stream, HexBufferSize);
       }
     }
   }
+  writeBuffer(buffer, stream);
 }
+
+/* ********************************************************************************************* *
+ * Implementation of streaming hexdump(Image) and hexdiff(Image, Image)
+ * ********************************************************************************************* */
+void
+hexdump(const Image *image, QTextStream &stream) {
+  QByteArray buffer;
+  buffer.reserve(HexBufferSize + 0x400);
+  buffer.append("\033[0m");
+  for (unsigned int i=0; i<image->count(); i++) {
+    if (i) buffer.append('\n');
+    // Lines are formatted straight from the pages, without creating HexLine instances.
+    const Element *element = image->element(i);
+    uint32_t address = element->address().byte();
+    qsizetype size = element->size().byte();
+    for (qsizetype offset=0; offset<size;) {
+      uint8_t bytes[HexFormat::LineSize] = {0};
+      int first = (address+offset) & 0xf;
+      qsizetype n = element->read(offset, HexFormat::LineSize-first, (char *)bytes + first);
+      formatDumpLine(uint32_t(address+offset) & ~0xfU, bytes, ((1U<<n)-1) << first, buffer);
+      offset += n;
+      writeBuffer(buffer, stream, HexBufferSize);
+    }
+  }
+  writeBuffer(buffer, stream);
+}
+
+/** Formats the hex-difference like @c hexdiff, but diffs the elements in parallel. The pairs of
+ * elements are split into jobs of a page each, such that large elements are diffed in parallel
+ * too. The jobs are processed in windows, the workers format the differences of each job into a
+ * separate buffer and these are written in order. Hence, only the differences of a few pages are
+ * held in memory. */
+static bool
+parallelDiff(const Image *left, const Image *right, QTextStream &stream, const QString &header,
+             QThreadPool *pool)
+{
+  /** A range of lines of a pair of elements. */
+  struct Job {
+    const Element *left, *right;
+    qsizetype from, to;
+  };
+
+  QVector<Job> jobs;
+  forEachElement(left, right, [&jobs](const Element *l, const Element *r) {
+    uint32_t address = (l ? l : r)->address().byte();
+    qsizetype size = std::max(l ? l->size().byte() : 0U, r ? r->size().byte() : 0U);
+    // Each job starts with the line containing the first byte of its page.
+    for (qsizetype start=0; start<size; start+=Element::PageSize) {
+      qsizetype end = std::min(start+Element::PageSize, size);
+      jobs.append(Job{l, r, lineOffset(address, start),
+                       (end < size) ? lineOffset(address, end) : size});
+    }
+  });
+
+  // Several jobs per thread, such that a page with many differences does not stall the others.
+  int window = 2*std::max(1, pool->maxThreadCount());
+  QVector<QByteArray> diffs(window);
+  QByteArray buffer;
+  bool hasDiff = false;
+  const Element *last = nullptr;
+  for (int start=0; start<jobs.size(); start+=window) {
+    int n = std::min(window, int(jobs.size())-start);
+    // The content of the elements is read here, such that the workers access the pages only.
+    for (int i=start; i<(start+n); i++) {
+      if (jobs[i].left) jobs[i].left->pageCount();
+      if (jobs[i].right) jobs[i].right->pageCount();
+    }
+
+    const Job *job = jobs.constData() + start;
+    QByteArray *diff = diffs.data();
+    forEachParallel(pool, n, [job, diff](int i) {
+      forEachDiffLine(job[i].left, job[i].right, job[i].from, job[i].to,
+                      [diff, i](const HexLine &line) { formatDiffLine(line, diff[i]); });
+    });
+
+    // Written in the order of the elements, as the serial version does.
+    for (int i=0; i<n; i++) {
+      if (diffs[i].isEmpty())
+        continue;
+      if (! hasDiff) {
+        stream << header;
+        buffer.append("\033[0m");
+        hasDiff = true;
+      } else if (last != (job[i].left ? job[i].left : job[i].right)) {
+        // Separate elements by an empty line
+        buffer.append('\n');
+      }
+      last = job[i].left ? job[i].left : job[i].right;
+      // The capacity of the buffers is kept for the next window.
+      writeBuffer(buffer, stream);
+      writeBuffer(diffs[i], stream);
+    }
+  }
+  writeBuffer(buffer, stream);
+
+  return hasDiff;
+}
+
+bool
+hexdiff(const Image *left, const Image *right, QTextStream &stream, const QString &header,
+        QThreadPool *pool)
+{
+  if (sameOriginal(left, right))
+    return false;
+
+  if (pool)
+    return parallelDiff(left, right, stream, header, pool);
+
+  QByteArray buffer;
+  buffer.reserve(HexBufferSize + 0x800);
+  bool hasDiff = false;
+  unsigned int count = 0;
+  forEachElement(left, right, [&](const Element *l, const Element *r) {
+    bool first = true;
+    forEachDiffLine(l, r, [&](const HexLine &line) {
+      // Nothing is written, until the first difference is found.
+      if (! hasDiff) {
+        stream << header;
+        buffer.append("\033[0m");
+        hasDiff = true;
+      }
+      // Separate elements by an empty line
+      if (first && (count++))
+        buffer.append('\n');
+      first = false;
+      formatDiffLine(line, buffer);
+      writeBuffer(buffer, stream, HexBufferSize);
+    });
+  });
+  writeBuffer(buffer, stream);
+
+  return hasDiff;
+}
+
@@ -3,12 +3,14 @@
 
 #include <QByteArray>
 #include <QVector>
+#include <QString>
 
 class Element;
 class Image;
 class ElementDifference;
 class ImageDifference;
 class QTextStream;
+class QThreadPool;
 
 
 /** A single line in a hex-dump or hex-diff.
@@ -90,6 +92,11 @@ protected:
 
 /** Represents a hex dump or hex difference between entire @c Element instances.
  * To this end, this is just a collection of @c HexLine instances.
+ *
+ * For differences between elements at the same address, the pages of both elements (see
+ * @c Element::page) are compared by their content hashes first. Identical pages are skipped, the
+ * remaining ones are compared in blocks of 16 bytes (see @c BlockCompare). A difference only
+ * contains the lines that actually differ.
  * @ingroup utils */
 class HexElement
 {
@@ -134,8 +141,13 @@ class HexImage
 public:
   /** Constructs a hex dump of the image. */
   explicit HexImage(const Image *image);
-  /** Constructs a hex-difference between the given images. */
+  /** Constructs a hex-difference between the given images. The difference between an image and
+   * its duplicate (see @c Image::duplicateOf) is empty. */
   explicit HexImage(const Image *left, const Image *right);
+  /** Constructs a hex-difference between the given images in parallel. Once the elements are
+   * paired by their address, the pairs are diffed by idle threads of the given pool and the calling
+   * thread. The result is identical to the serial one. */
+  explicit HexImage(const Image *left, const Image *right, QThreadPool *pool);
   /** Copy constructor. */
   HexImage(const HexImage &other) = default;
   /** Copying assignment operator. */
@@ -167,6 +179,27 @@ protected:
  * @ingroup utils */
 void hexdump(const HexImage &hex, QTextStream &stream);
 
+/** Formats the hex dump of the image directly into the given text stream.
+ *
+ * Unlike @c HexImage, this does not hold the entire dump in memory. The lines are formatted one
+ * by one from the content of the elements. Hence the memory used is independent of the size of
+ * the image. The output is identical to the one of @c hexdump(HexImage(image), stream).
+ * @ingroup utils */
+void hexdump(const Image *image, QTextStream &stream);
+
+/** Formats the hex-difference between the two images directly into the given text stream.
+ *
+ * Like @c hexdump(const Image*, QTextStream&), only a single line exists at a time. Identical
+ * pages are skipped as for @c HexElement. The output is identical to the one of
+ * @c hexdump(HexImage(left, right), stream). If there is any difference, the optional @c header is
+ * written first. Returns @c false if there are no differences, in this case nothing is written.
+ *
+ * If a thread @c pool is given, the elements are diffed in parallel, page by page. Only the
+ * differing lines of the few pages currently diffed are held in memory until they are written.
+ * @ingroup utils */
+bool hexdiff(const Image *left, const Image *right, QTextStream &stream,
+             const QString &header=QString(), QThreadPool *pool=nullptr);
+
 /** Stream operator for formatting hex-dumps into a @c QTextStream.
  * @ingroup utils */
 inline QTextStream &
@@ -0,0 +1,238 @@
+#include "hexformat.hh"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+// Vector kernels are compiled for their target explicitly and selected at runtime.
+#define HEXFORMAT_HAVE_SSSE3 1
+#define HEXFORMAT_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+
+/** Lookup table of the hex digits of all byte values. */
+struct HexTable
+{
+  char digits[256][2];
+
+  constexpr HexTable()
+    : digits()
+  {
+    const char hex[] = "0123456789abcdef";
+    for (int i=0; i<256; i++) {
+      digits[i][0] = hex[i>>4];
+      digits[i][1] = hex[i&0xf];
+    }
+  }
+};
+
+static constexpr HexTable hexTable;
+
+
+/** Shuffle masks, spreading the digits of 16 bytes into 48 chars of "xx " each. */
+struct SpreadTable
+{
+  /** Index of the byte, whose high nibble is placed at each position, -128 (zero) otherwise. */
+  int8_t high[HexFormat::ValuesLength];
+  /** Index of the byte, whose low nibble is placed at each position, -128 (zero) otherwise. */
+  int8_t low[HexFormat::ValuesLength];
+  /** Spaces between the values. */
+  int8_t space[HexFormat::ValuesLength];
+
+  constexpr SpreadTable()
+    : high(), low(), space()
+  {
+    for (int p=0; p<HexFormat::ValuesLength; p++) {
+      high[p]  = (0 == (p%3)) ? int8_t(p/3) : int8_t(-128);
+      low[p]   = (1 == (p%3)) ? int8_t(p/3) : int8_t(-128);
+      space[p] = (2 == (p%3)) ? ' ' : 0;
+    }
+  }
+};
+
+static constexpr SpreadTable spreadTable;
+
+
+/* ********************************************************************************************* *
+ * Scalar kernel
+ * ********************************************************************************************* */
+static void
+formatLineScalar(const uint8_t *bytes, char *values, char *chars, char placeholder) {
+  if (values) {
+    for (int i=0; i<HexFormat::LineSize; i++) {
+      std::memcpy(values + 3*i, hexTable.digits[bytes[i]], 2);
+      values[3*i+2] = ' ';
+    }
+  }
+  if (chars) {
+    for (int i=0; i<HexFormat::LineSize; i++)
+      chars[i] = HexFormat::printable(bytes[i]) ? char(bytes[i]) : placeholder;
+  }
+}
+
+
+/* ********************************************************************************************* *
+ * SSSE3 kernel
+ * ********************************************************************************************* */
+#ifdef HEXFORMAT_HAVE_SSSE3
+/** Returns the hex digits of the high and low nibbles of all 16 bytes. */
+__attribute__((target("ssse3"))) static inline void
+nibbleDigits(__m128i v, __m128i &high, __m128i &low) {
+  const __m128i digits = _mm_setr_epi8('0','1','2','3','4','5','6','7',
+                                       '8','9','a','b','c','d','e','f');
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+  low  = _mm_shuffle_epi8(digits, _mm_and_si128(v, mask));
+}
+
+/** Replaces non-printable chars by the placeholder. */
+__attribute__((target("ssse3"))) static inline __m128i
+printableChars(__m128i v, char placeholder) {
+  // Bytes >= 0x80 are negative, hence rejected by the first comparison
+  __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)),
+                             _mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)));
+  return _mm_or_si128(_mm_and_si128(ok, v), _mm_andnot_si128(ok, _mm_set1_epi8(placeholder)));
+}
+
+__attribute__((target("ssse3"))) static void
+formatLineSSSE3(const uint8_t *bytes, char *values, char *chars, char placeholder) {
+  __m128i v = _mm_loadu_si128((const __m128i *)bytes);
+  if (values) {
+    __m128i high, low;
+    nibbleDigits(v, high, low);
+    for (int k=0; k<HexFormat::ValuesLength; k+=16) {
+      __m128i h = _mm_shuffle_epi8(high, _mm_loadu_si128((const __m128i *)(spreadTable.high+k)));
+      __m128i l = _mm_shuffle_epi8(low, _mm_loadu_si128((const __m128i *)(spreadTable.low+k)));
+      __m128i s = _mm_loadu_si128((const __m128i *)(spreadTable.space+k));
+      _mm_storeu_si128((__m128i *)(values+k), _mm_or_si128(_mm_or_si128(h, l), s));
+    }
+  }
+  if (chars)
+    _mm_storeu_si128((__m128i *)chars, printableChars(v, placeholder));
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * AVX2 kernel
+ * ********************************************************************************************* */
+#ifdef HEXFORMAT_HAVE_AVX2
+__attribute__((target("avx2"))) static void
+formatLineAVX2(const uint8_t *bytes, char *values, char *chars, char placeholder) {
+  __m128i v = _mm_loadu_si128((const __m128i *)bytes);
+  if (values) {
+    __m128i high, low;
+    nibbleDigits(v, high, low);
+    // The shuffle works within 128bit lanes, hence both lanes hold all digits.
+    __m256i high2 = _mm256_broadcastsi128_si256(high), low2 = _mm256_broadcastsi128_si256(low);
+    __m256i h = _mm256_shuffle_epi8(high2, _mm256_loadu_si256((const __m256i *)spreadTable.high));
+    __m256i l = _mm256_shuffle_epi8(low2, _mm256_loadu_si256((const __m256i *)spreadTable.low));
+    __m256i s = _mm256_loadu_si256((const __m256i *)spreadTable.space);
+    _mm256_storeu_si256((__m256i *)values, _mm256_or_si256(_mm256_or_si256(h, l), s));
+    // Last 16 chars
+    __m128i h1 = _mm_shuffle_epi8(high, _mm_loadu_si128((const __m128i *)(spreadTable.high+32)));
+    __m128i l1 = _mm_shuffle_epi8(low, _mm_loadu_si128((const __m128i *)(spreadTable.low+32)));
+    __m128i s1 = _mm_loadu_si128((const __m128i *)(spreadTable.space+32));
+    _mm_storeu_si128((__m128i *)(values+32), _mm_or_si128(_mm_or_si128(h1, l1), s1));
+  }
+  if (chars)
+    _mm_storeu_si128((__m128i *)chars, printableChars(v, placeholder));
+}
+#endif
+
+
+/* ********************************************************************************************* *
+ * Implementation of HexFormat
+ * ********************************************************************************************* */
+/** Signature of the line kernels. */
+typedef void (*LineKernel)(const uint8_t *bytes, char *values, char *chars, char placeholder);
+
+/** Returns the implementation of the given kernel, or the scalar one if not supported. */
+static LineKernel
+lineKernel(HexFormat::Kernel kernel) {
+  switch (kernel) {
+#ifdef HEXFORMAT_HAVE_AVX2
+  case HexFormat::Kernel::AVX2:
+    if (HexFormat::supported(HexFormat::Kernel::AVX2))
+      return formatLineAVX2;
+    break;
+#endif
+#ifdef HEXFORMAT_HAVE_SSSE3
+  case HexFormat::Kernel::SSSE3:
+    if (HexFormat::supported(HexFormat::Kernel::SSSE3))
+      return formatLineSSSE3;
+    break;
+#endif
+  default:
+    break;
+  }
+  return formatLineScalar;
+}
+
+void
+HexFormat::formatLine(const uint8_t *bytes, char *values, char *chars, char placeholder) {
+  // Called for every line, hence the kernel is looked up once.
+  static const LineKernel selected = lineKernel(kernel());
+  selected(bytes, values, chars, placeholder);
+}
+
+void
+HexFormat::formatLine(const uint8_t *bytes, char *values, char *chars, char placeholder,
+                      Kernel kernel)
+{
+  lineKernel(kernel)(bytes, values, chars, placeholder);
+}
+
+
+const char *
+HexFormat::hex(uint8_t value) {
+  return hexTable.digits[value];
+}
+
+void
+HexFormat::formatAddress(uint32_t address, char *buffer) {
+  std::memcpy(buffer+0, hexTable.digits[(address>>24) & 0xff], 2);
+  std::memcpy(buffer+2, hexTable.digits[(address>>16) & 0xff], 2);
+  std::memcpy(buffer+4, hexTable.digits[(address>>8) & 0xff], 2);
+  std::memcpy(buffer+6, hexTable.digits[address & 0xff], 2);
+}
+
+
+HexFormat::Kernel
+HexFormat::kernel() {
+  if (supported(Kernel::AVX2))
+    return Kernel::AVX2;
+  if (supported(Kernel::SSSE3))
+    return Kernel::SSSE3;
+  return Kernel::Scalar;
+}
+
+bool
+HexFormat::supported(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar:
+    return true;
+  case Kernel::SSSE3:
+#ifdef HEXFORMAT_HAVE_SSSE3
+    return __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+  case Kernel::AVX2:
+#ifdef HEXFORMAT_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+const char *
+HexFormat::kernelName(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Scalar: return "scalar";
+  case Kernel::SSSE3: return "SSSE3";
+  case Kernel::AVX2: return "AVX2";
+  }
+  return "unknown";
+}
@@ -0,0 +1,63 @@
+#ifndef HEXFORMAT_HH
+#define HEXFORMAT_HH
+
+#include <QtGlobal>
+#include <cstdint>
+
+
+/** Formatting kernel for hex dumps, shared by the text dumps (see @c hexdump) and the hex
+ * documents of the GUI.
+ *
+ * A line of 16 bytes gets rendered into preallocated buffers: The hex values, each followed by a
+ * space (@c ValuesLength chars) and the printable chars (@c CharsLength chars). Single values and
+ * addresses are formatted using a 256-entry lookup table. On x86 CPUs supporting SSSE3 or AVX2,
+ * the lines are formatted by shuffling the nibbles of all 16 bytes at once. On all other
+ * platforms, the lookup table is used. Like for @c Checksum, the kernel is selected once at
+ * runtime.
+ *
+ * @ingroup utils */
+class HexFormat
+{
+public:
+  /** Possible formatting kernels. */
+  enum class Kernel {
+    Scalar, ///< Portable implementation using the lookup table.
+    SSSE3,  ///< 128bit nibble-shuffle implementation.
+    AVX2    ///< 256bit nibble-shuffle implementation.
+  };
+
+  /** Number of bytes in a line. */
+  static constexpr int LineSize     = 16;
+  /** Length of the formatted values of a line, "xx " for each byte. */
+  static constexpr int ValuesLength = 3*LineSize;
+  /** Length of the printable chars of a line. */
+  static constexpr int CharsLength  = LineSize;
+  /** Length of a formatted address. */
+  static constexpr int AddressLength = 8;
+
+public:
+  /** Formats the 16 bytes of a line. The hex values are written into @c values, the printable chars
+   * into @c chars. Non-printable chars are replaced by @c placeholder. Either buffer may be
+   * @c nullptr. */
+  static void formatLine(const uint8_t *bytes, char *values, char *chars, char placeholder=' ');
+  /** Same as above using the specified kernel.
+   * If the kernel is not supported, the scalar implementation is used. */
+  static void formatLine(const uint8_t *bytes, char *values, char *chars, char placeholder,
+                         Kernel kernel);
+
+  /** Returns a pointer to the two lower-case hex digits of the given value. */
+  static const char *hex(uint8_t value);
+  /** Writes the address as 8 lower-case hex digits. */
+  static void formatAddress(uint32_t address, char *buffer);
+  /** Returns @c true if the value is a printable ASCII char. */
+  static inline bool printable(uint8_t value) { return (value >= 0x20) && (value < 0x7f); }
+
+  /** Returns the kernel selected for this CPU. */
+  static Kernel kernel();
+  /** Returns @c true if the given kernel is supported by this build and CPU. */
+  static bool supported(Kernel kernel);
+  /** Returns the name of the given kernel. */
+  static const char *kernelName(Kernel kernel);
+};
+
+#endif // HEXFORMAT_HH
@@ -1,25 +1,50 @@
 #include "image.hh"
 #include "annotation.hh"
 #include "pattern.hh"
+#include "logger.hh"
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+
+
+/* ********************************************************************************************* *
+ * Implementation of ElementSource
+ * ********************************************************************************************* */
+ElementSource::~ElementSource() {
+  // pass...
+}
 
 
 /* ********************************************************************************************* *
  * Implementation of Element
  * ********************************************************************************************* */
 Element::Element(const Address &address, uint32_t size, QObject *parent)
-  : QObject{parent}, AnnotationCollection(), _address(address), _data(size, 0)
+  : QObject{parent}, AnnotationCollection(), _address(address), _pages(), _hashes(), _size(0),
+    _flat(), _source(nullptr), _loaded(true), _updateDepth(0), _modifiedWithinUpdate(false)
 {
-  // pass...
+  QByteArray zeros(PageSize, 0);
+  for (qsizetype left=size; left>0; left-=PageSize)
+    appendPages(zeros.constData(), std::min(left, PageSize));
 }
 
 Element::Element(const Address &address, const QByteArray &data, QObject *parent)
-  : QObject{parent}, AnnotationCollection(), _address(address), _data(data)
+  : QObject{parent}, AnnotationCollection(), _address(address), _pages(), _hashes(), _size(0),
+    _flat(), _source(nullptr), _loaded(true), _updateDepth(0), _modifiedWithinUpdate(false)
+{
+  // Deep copy into pages, as data may refer to a receive buffer.
+  appendPages(data.constData(), data.size());
+}
+
+Element::Element(const Address &address, uint32_t size, ElementSource *source, QObject *parent)
+  : QObject{parent}, AnnotationCollection(), _address(address), _pages(), _hashes(), _size(size),
+    _flat(), _source(source), _loaded(false), _updateDepth(0), _modifiedWithinUpdate(false)
 {
   // pass...
 }
 
 Element::~Element() {
-  // pass...
+  if (_source)
+    delete _source;
 }
 
 bool
@@ -34,14 +59,21 @@ Element::operator<(const Element &other) const {
 
 bool
 Element::operator==(const Element &other) const {
-  return (this->address() == other.address()) &&
-      (this->data() == other.data());
+  if ((this->address() != other.address()) || (_size != other._size))
+    return false;
+  load(); other.load();
+  // Compare page-wise, shared pages are equal.
+  for (unsigned int i=0; i<pageCount(); i++) {
+    if ((_pages.at(i).constData() != other._pages.at(i).constData())
+        && (_pages.at(i) != other._pages.at(i)))
+      return false;
+  }
+  return true;
 }
 
 bool
 Element::operator!=(const Element &other) const {
-  return (this->address() != other.address()) ||
-      (this->data() != other.data());
+  return ! (*this == other);
 }
 
 const Address &
@@ -51,7 +83,7 @@ Element::address() const {
 
 Size
 Element::size() const {
-  return Size::fromByte(_data.size());
+  return Size::fromByte(_size);
 }
 
 bool
@@ -78,7 +110,45 @@ Element::contains(const Address &address, const Size &size) const {
 
 const QByteArray &
 Element::data() const {
-  return _data;
+  load();
+  if (_flat.size() != _size) {
+    _flat.clear();
+    _flat.reserve(_size);
+    foreach (const QByteArray &page, _pages)
+      _flat.append(page);
+  }
+  return _flat;
+}
+
+qsizetype
+Element::read(qsizetype offset, qsizetype len, char *dest) const {
+  load();
+  qsizetype copied = 0;
+  // Collect the bytes from the pages, the range may span several of them.
+  while ((len > 0) && (offset >= 0) && (offset < _size)) {
+    const QByteArray &page = _pages.at(offset/PageSize);
+    qsizetype start = offset % PageSize;
+    qsizetype n = std::min(len, page.size()-start);
+    std::memcpy(dest+copied, page.constData()+start, n);
+    offset += n; len -= n; copied += n;
+  }
+  return copied;
+}
+
+QByteArray
+Element::read(qsizetype offset, qsizetype len) const {
+  QByteArray data;
+  if ((offset < 0) || (offset >= _size))
+    return data;
+  data.resize(std::min(len, _size-offset));
+  read(offset, data.size(), data.data());
+  return data;
+}
+
+char
+Element::at(qsizetype offset) const {
+  load();
+  return _pages.at(offset/PageSize).at(offset % PageSize);
 }
 
 const uint8_t *
@@ -91,8 +161,159 @@ Element::data(const Address &address) const {
 
 void
 Element::append(const QByteArray &data) {
-  this->_data.append(data);
-  emit modified(_address.byte());
+  load();
+  // The source does not hold the content anymore.
+  if (_source) {
+    delete _source;
+    _source = nullptr;
+  }
+  appendPages(data.constData(), data.size());
+  // An assembled copy is outdated, assemble it again on demand only.
+  _flat = QByteArray();
+  if (_updateDepth)
+    _modifiedWithinUpdate = true;
+  else
+    emit modified(_address.byte());
+}
+
+void
+Element::appendPages(const char *data, qsizetype len) {
+  while (len) {
+    if (_pages.isEmpty() || (PageSize == _pages.back().size())) {
+      _pages.append(QByteArray());
+      _pages.back().reserve(PageSize);
+    }
+    qsizetype n = std::min(len, PageSize - _pages.back().size());
+    _pages.back().append(data, n);
+    data += n; len -= n; _size += n;
+    if (PageSize == _pages.back().size())
+      _hashes.append(PageStore::hash(_pages.back().constData(), PageSize));
+  }
+}
+
+void
+Element::reserve(uint32_t size) {
+  _pages.reserve((size + PageSize - 1)/PageSize);
+  _hashes.reserve(size/PageSize);
+}
+
+unsigned int
+Element::pageCount() const {
+  load();
+  return _pages.size();
+}
+
+QByteArrayView
+Element::page(unsigned int n) const {
+  load();
+  return QByteArrayView(_pages.at(n));
+}
+
+uint64_t
+Element::pageHash(unsigned int n) const {
+  load();
+  if (n < _hashes.size())
+    return _hashes.at(n);
+  // Last, partial page
+  return PageStore::hash(_pages.at(n).constData(), _pages.at(n).size());
+}
+
+bool
+Element::samePage(const Element *other, unsigned int n) const {
+  if ((n >= pageCount()) || (n >= other->pageCount()))
+    return false;
+  QByteArrayView a = page(n), b = other->page(n);
+  if (a.size() != b.size())
+    return false;
+  if (a.data() == b.data())
+    return true;
+  // Equal hashes only hint at the same content.
+  return (pageHash(n) == other->pageHash(n)) && (0 == std::memcmp(a.data(), b.data(), a.size()));
+}
+
+void
+Element::share(PageStore &store) {
+  // Content not read yet, nothing to share.
+  if (! _loaded)
+    return;
+  for (unsigned int i=0; i<_hashes.size(); i++)
+    store.intern(_pages[i], _hashes.at(i));
+}
+
+void
+Element::squeeze() {
+  _flat = QByteArray();
+}
+
+qsizetype
+Element::copySize() const {
+  return _flat.capacity();
+}
+
+bool
+Element::loaded() const {
+  return _loaded;
+}
+
+bool
+Element::hasSource() const {
+  return nullptr != _source;
+}
+
+void
+Element::setSource(ElementSource *source) {
+  load();
+  if (_source)
+    delete _source;
+  _source = source;
+}
+
+bool
+Element::evict() {
+  if (nullptr == _source)
+    return false;
+  _pages.clear();
+  _hashes.clear();
+  _flat = QByteArray();
+  _loaded = false;
+  return true;
+}
+
+void
+Element::load() const {
+  if (_loaded)
+    return;
+
+  QByteArray content = _source->read();
+  _loaded = true;
+
+  if (content.size() != _size) {
+    logError() << "Cannot read content of element at " << _address.toString()
+               << ", expected " << _size << " bytes, got " << content.size() << ".";
+    content = QByteArray(_size, 0);
+    delete _source;
+    _source = nullptr;
+  }
+
+  // Reading the content does not change the element, just its representation.
+  Element *self = const_cast<Element *>(this);
+  self->_size = 0;
+  self->appendPages(content.constData(), content.size());
+}
+
+void
+Element::beginUpdate() {
+  _updateDepth++;
+}
+
+void
+Element::endUpdate() {
+  if ((0 == _updateDepth) || (0 != --_updateDepth))
+    return;
+  if (_modifiedWithinUpdate) {
+    _modifiedWithinUpdate = false;
+    emit modified(_address.byte());
+  }
 }
 
 void
@@ -112,7 +333,8 @@ Element::clearAnnotations() {
  * Implementation of Image
  * ********************************************************************************************* */
 Image::Image(const QString &label, QObject *parent)
-  : QObject{parent}, _label(label), _elements()
+  : QObject{parent}, _label(label), _elements(), _cursor(-1), _sizeHints(), _journal(),
+    _duplicateOf(), _updateDepth(0), _dirty(), _flushInterval(0), _flushTimer(nullptr)
 {
   // pass...
 }
@@ -148,13 +370,34 @@ Image::append(uint32_t address, const QByteArray &data) {
 
 void
 Image::append(const Address &address, const QByteArray &data) {
-  Element *pred = findPred(address);
-  if ((nullptr == pred) || (! pred->extends(address))) {
-    add(new Element(address, data, this));
-    return;
+  _dirty.add(address.byte(), data.size());
+
+  // Fast path: extend the element modified last, if no other element starts at the address.
+  if ((0 <= _cursor) && _elements.at(_cursor)->extends(address)
+      && (((_cursor+1) == _elements.size()) || (address < _elements.at(_cursor+1)->address()))) {
+    _elements.at(_cursor)->append(data);
+  } else {
+    int idx = findPredIndex(address);
+    if ((0 > idx) || (! _elements.at(idx)->extends(address))) {
+      auto el = new Element(address, data, this);
+      el->reserve(sizeHint(address.byte()));
+      add(el);
+    } else {
+      _cursor = idx;
+      _elements.at(idx)->append(data);
+    }
   }
 
-  pred->append(data);
+  if (0 == _updateDepth)
+    flush();
+}
+
+void
+Image::append(Element *element) {
+  _dirty.add(element->address().byte(), element->size().byte());
+  add(element);
+  if (0 == _updateDepth)
+    flush();
 }
 
 const QString &
@@ -166,6 +409,67 @@ Image::setLabel(const QString &label) {
   _label = label;
 }
 
+void
+Image::setSizeHints(const QMap<uint32_t, uint32_t> &hints) {
+  _sizeHints = hints;
+}
+
+uint32_t
+Image::sizeHint(uint32_t address) const {
+  auto next = _sizeHints.upperBound(address);
+  if (_sizeHints.begin() == next)
+    return 0;
+  auto block = std::prev(next);
+  uint64_t end = uint64_t(block.key()) + block.value();
+  if (address >= end)
+    return 0;
+  return end - address;
+}
+
+void
+Image::share(PageStore &store) {
+  foreach (auto element, _elements)
+    element->share(store);
+}
+
+void
+Image::squeeze() {
+  foreach (auto element, _elements)
+    element->squeeze();
+}
+
+uint64_t
+Image::digest() const {
+  QVector<uint64_t> words;
+  foreach (const Element *element, _elements) {
+    words.append(element->address().byte());
+    words.append(element->size().byte());
+    for (unsigned int i=0; i<element->pageCount(); i++)
+      words.append(element->pageHash(i));
+  }
+  return PageStore::hash((const char *)words.constData(), words.size()*sizeof(uint64_t));
+}
+
+const Image *
+Image::duplicateOf() const {
+  return _duplicateOf;
+}
+
+void
+Image::setDuplicateOf(const Image *original) {
+  _duplicateOf = original;
+}
+
+const WriteJournal &
+Image::journal() const {
+  return _journal;
+}
+
+void
+Image::setJournal(const WriteJournal &journal) {
+  _journal = journal;
+}
+
 bool
 Image::annotate(const CodeplugPattern *pattern) {
  bool ok = ImageAnnotator::annotate(this, pattern);
@@ -184,7 +488,11 @@ Image::add(Element *el) {
   unsigned int idx = findInsertionIndex(el->address().byte(), 0, _elements.size());
   el->setParent(this);
   _elements.insert(idx, el);
-  emit modified(idx, el->address().byte());
+  _cursor = idx;
+  if (_updateDepth)
+    el->beginUpdate();
+  else
+    emit modified(idx, el->address().byte());
 }
 
 Element *
@@ -203,16 +511,22 @@ Image::find(const Address &address) const {
 
 Element *
 Image::findPred(const Address &address) const {
-  if (_elements.isEmpty())
+  int idx = findPredIndex(address);
+  if (0 > idx)
     return nullptr;
+  return _elements.at(idx);
+}
+
+int
+Image::findPredIndex(const Address &address) const {
+  if (_elements.isEmpty())
+    return -1;
 
   unsigned int idx = findInsertionIndex(address, 0, _elements.size());
   // Chcek if we hit element
   if ((_elements.size() > idx) && (_elements.at(idx)->contains(address)))
-    return _elements.at(idx);
-  if (0 == idx)
-    return nullptr;
-  return _elements.at(idx-1);
+    return idx;
+  return int(idx)-1;
 }
 
 unsigned int
@@ -222,20 +536,73 @@ Image::findInsertionIndex(uint32_t address, unsigned int a, unsigned int b) cons
 
 unsigned int
 Image::findInsertionIndex(const Address &address, unsigned int a, unsigned int b) const {
+  // Elements are usually added in ascending order, check tail first.
+  if ((a < b) && (_elements.at(b-1)->address() < address))
+    return b;
 
-  if (a == b)
-    return a;
+  while (a < b) {
+    unsigned int m = a + (b-a)/2;
+    if (_elements.at(m)->address() < address)
+      a = m+1;
+    else
+      b = m;
+  }
 
-  if (address <= _elements.at(a)->address())
-    return a;
+  return a;
+}
 
-  if (address >= _elements.at(b-1)->address())
-    return b;
+void
+Image::beginUpdate() {
+  if (0 != _updateDepth++)
+    return;
+  foreach (Element *element, _elements)
+    element->beginUpdate();
+  setFlushInterval(_flushInterval);
+}
+
+void
+Image::endUpdate() {
+  if ((0 == _updateDepth) || (0 != --_updateDepth))
+    return;
+  if (_flushTimer)
+    _flushTimer->stop();
+  foreach (Element *element, _elements)
+    element->endUpdate();
+  flush();
+}
+
+bool
+Image::updating() const {
+  return 0 != _updateDepth;
+}
+
+int
+Image::flushInterval() const {
+  return _flushInterval;
+}
+
+void
+Image::setFlushInterval(int ms) {
+  _flushInterval = ms;
+  if ((0 < ms) && _updateDepth) {
+    if (nullptr == _flushTimer) {
+      _flushTimer = new QTimer(this);
+      connect(_flushTimer, &QTimer::timeout, this, &Image::flush);
+    }
+    _flushTimer->start(ms);
+  } else if (_flushTimer) {
+    _flushTimer->stop();
+  }
+}
 
-  unsigned int m = (a+b)/2;
-  if (address < _elements.at(m)->address())
-    return findInsertionIndex(address, a, m);
-  return findInsertionIndex(address, m, b);
+void
+Image::flush() {
+  if (_dirty.isEmpty())
+    return;
+  // Emit a copy, receivers may modify the image.
+  DirtySet ranges = _dirty;
+  _dirty.clear();
+  emit updated(ranges);
 }
 
 Image::const_iterator
@@ -261,11 +628,34 @@ Image::annotationSeverity() const {
 
 
 
+/** Returns @c true if the content of all elements of the image is held in memory. */
+static bool
+fullyLoaded(const Image *image) {
+  for (const Element *element: *image) {
+    if (! element->loaded())
+      return false;
+  }
+  return true;
+}
+
+/** Compares the content of both images page by page. */
+static bool
+identical(const Image *a, const Image *b) {
+  if (a->count() != b->count())
+    return false;
+  for (unsigned int i=0; i<a->count(); i++) {
+    if (*a->element(i) != *b->element(i))
+      return false;
+  }
+  return true;
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of Collection
  * ********************************************************************************************* */
 Collection::Collection(QObject *parent)
-  : QObject{parent}, _images()
+  : QObject{parent}, _images(), _pages(), _recent(), _budget(0), _spill(), _digests()
 {
   // pass...
 }
@@ -287,12 +677,39 @@ Collection::indexOf(const Image *img) const {
 
 void
 Collection::append(Image *image) {
+  image->share(_pages);
+  image->squeeze();
+
+  // Images not read yet (e.g., from an archive) are not read just to find duplicates.
+  if (fullyLoaded(image)) {
+    uint64_t digest = image->digest();
+    QVector<Image *> &group = _digests[digest];
+    if (group.isEmpty()) {
+      group.append(image);
+    } else if (identical(group.first(), image)) {
+      // The digest only hints at a duplicate, the content confirms it.
+      logInfo() << "Image '" << image->label() << "' is a duplicate of '"
+                << group.first()->label() << "'.";
+      image->setDuplicateOf(group.first());
+      group.append(image);
+    }
+  }
+
   _images.append(image);
   image->setParent(this);
   connect(image, &QObject::destroyed, this, &Collection::onImageDeleted);
   connect(image, &Image::annotated, this, &Collection::onImageAnnotated);
+  _recent.append(image);
 
   emit imageAdded(_images.size()-1);
+  enforceBudget();
+}
+
+void
+Collection::appendLater(Image *image) {
+  image->setParent(nullptr);
+  image->moveToThread(thread());
+  QMetaObject::invokeMethod(this, [this, image]() { append(image); }, Qt::QueuedConnection);
 }
 
 void
@@ -302,6 +719,8 @@ Collection::deleteImage(unsigned int idx) {
 
   auto image = _images.at(idx);
   _images.remove(idx);
+  _recent.removeOne(image);
+  removeDigest(image);
 
   disconnect(image, &Image::annotated, this, &Collection::onImageAnnotated);
   disconnect(image, &QObject::destroyed, this, &Collection::onImageDeleted);
@@ -309,6 +728,111 @@ Collection::deleteImage(unsigned int idx) {
   emit imageRemoved(idx);
 
   delete image;
+  _pages.purge();
+}
+
+void
+Collection::touch(const Image *image, bool enforce) {
+  int idx = _recent.indexOf(image);
+  if (0 > idx)
+    return;
+  _recent.move(idx, _recent.size()-1);
+  if (enforce)
+    enforceBudget();
+}
+
+qsizetype
+Collection::memoryBudget() const {
+  return _budget;
+}
+
+void
+Collection::setMemoryBudget(qsizetype bytes) {
+  _budget = bytes;
+  enforceBudget();
+}
+
+qsizetype
+Collection::memoryUsage() const {
+  QHash<const char *, int> refs;
+  return countPages(refs);
+}
+
+qsizetype
+Collection::countPages(QHash<const char *, int> &refs) const {
+  qsizetype usage = 0;
+  foreach (const Image *image, _images) {
+    for (const Element *element: *image) {
+      if (! element->loaded())
+        continue;
+      usage += element->copySize();
+      for (unsigned int i=0; i<element->pageCount(); i++) {
+        QByteArrayView page = element->page(i);
+        if (1 == ++refs[page.data()])
+          usage += page.size();
+      }
+    }
+  }
+  return usage;
+}
+
+void
+Collection::enforceBudget() {
+  if (0 == _budget)
+    return;
+
+  // Pages read back since the last call are shared again, before counting.
+  foreach (Image *image, _images)
+    image->share(_pages);
+
+  QHash<const char *, int> refs;
+  qsizetype usage = countPages(refs);
+  if (usage <= _budget)
+    return;
+
+  for (int i=0; (usage > _budget) && ((i+1) < _recent.size()); i++) {
+    Image *image = _recent.at(i);
+    for (Element *element: *image) {
+      if (! element->loaded())
+        continue;
+      if (! element->hasSource()) {
+        ElementSource *source = _spill.write(element);
+        if (nullptr == source)
+          continue;
+        element->setSource(source);
+      }
+      // Memory is only released for pages not used by any other element.
+      usage -= element->copySize();
+      for (unsigned int j=0; j<element->pageCount(); j++) {
+        QByteArrayView page = element->page(j);
+        if (0 == --refs[page.data()])
+          usage -= page.size();
+      }
+      element->evict();
+    }
+    logDebug() << "Evicted image '" << image->label() << "', " << usage << "b left.";
+  }
+
+  _pages.purge();
+}
+
+void
+Collection::removeDigest(Image *image) {
+  for (auto it=_digests.begin(); it!=_digests.end(); it++) {
+    int idx = it->indexOf(image);
+    if (0 > idx)
+      continue;
+    it->remove(idx);
+    if (it->isEmpty()) {
+      _digests.erase(it);
+    } else if (0 == idx) {
+      // The oldest remaining duplicate becomes the original of the others.
+      it->first()->setDuplicateOf(nullptr);
+      for (int i=1; i<it->size(); i++)
+        it->at(i)->setDuplicateOf(it->first());
+    }
+    return;
+  }
 }
 
 void
@@ -317,8 +841,11 @@ Collection::onImageDeleted(QObject *obj) {
   if (idx < 0)
     return;
   _images.remove(idx);
+  _recent.removeOne(qobject_cast<Image*>(obj));
+  removeDigest(qobject_cast<Image*>(obj));
   disconnect(qobject_cast<Image*>(obj), &Image::annotated, this, &Collection::onImageAnnotated);
   emit imageRemoved(idx);
+  // The image is not deleted yet, its pages are dropped with the next purge.
 }
 
 void
@@ -5,22 +5,64 @@
 
 #include <QObject>
 #include <QVector>
+#include <QMap>
+#include <QByteArrayView>
+#include <QPointer>
 #include "offset.hh"
 #include "annotation.hh"
+#include "writejournal.hh"
+#include "pagestore.hh"
+#include "spillfile.hh"
+#include "dirtyset.hh"
 
 class CodeplugPattern;
+class QTimer;
+
+
+/** Interface to load the content of an element on demand.
+ * @ingroup codeplug */
+class ElementSource
+{
+public:
+  /** Destructor. */
+  virtual ~ElementSource();
+
+  /** Reads the content of the element. Returns an empty array on error. */
+  virtual QByteArray read() const = 0;
+};
 
 
 /** A continuous element of codeplug memory.
+ *
+ * The content is stored in pages of @c PageSize bytes. Appending fills the last page and adds new
+ * pages as needed, hence the content grows without reallocating and moving the data received so
+ * far. Pages are implicitly shared byte arrays, that can be shared between the elements of several
+ * images using a @c PageStore (see @c share). A content hash is maintained for every full page.
+ *
+ * A contiguous copy of the content is assembled lazily, once the data is accessed via @c data and
+ * kept until released by @c squeeze or the next modification. Bounded ranges can be read without
+ * that copy using @c read, the pages can be traversed using @c pageCount and @c page.
+ *
+ * An element can also be constructed from an @c ElementSource. Then, only the size is known and
+ * the content gets read from the source, once it is accessed for the first time (see @c loaded).
+ * The source is kept as long as the content is not modified. This allows to release the content
+ * again (see @c evict), to be read from the source on the next access.
  *
  * @ingroup codeplug */
 class Element: public QObject, public AnnotationCollection
 {
   Q_OBJECT
 
+public:
+  /** Size of the storage pages. */
+  static constexpr qsizetype PageSize = 0x1000;
+
 public:
   /** Constructs an element of the specified size starting at the given address. */
   explicit Element(const Address &address, uint32_t size = 0, QObject *parent=nullptr);
+  /** Constructs an element of the specified size, that reads its content from the given source on
+   * demand. Takes ownership of the source. */
+  Element(const Address &address, uint32_t size, ElementSource *source, QObject *parent=nullptr);
   /** Constructs an element from the given data at the specified address. */
   explicit Element(const Address &address, const QByteArray &data, QObject *parent=nullptr);
 
@@ -49,14 +91,59 @@ public:
   /** Returns @c true if the element contains the given address and the specified size. */
   bool contains(const Address &address, const Size &size=Size::zero()) const;
 
-  /** Returns the data of the element. */
+  /** Returns the data of the element. Assembles a contiguous copy of the pages, if needed. */
   const QByteArray &data() const;
+  /** Copies up to @c len bytes at the given offset into the element from the pages. Returns the
+   * number of bytes copied, which is less if the element ends before. */
+  qsizetype read(qsizetype offset, qsizetype len, char *dest) const;
+  /** Returns up to @c len bytes at the given offset into the element. Unlike @c data, no contiguous
+   * copy of the entire content is assembled. */
+  QByteArray read(qsizetype offset, qsizetype len) const;
+  /** Returns the byte at the given offset into the element. */
+  char at(qsizetype offset) const;
   /** Returns the data of the element at the specified address. */
   const uint8_t *data(uint32_t address) const;
   /** Returns the data of the element at the specified address. */
   const uint8_t *data(const Address &address) const;
   /** Appends some data to the element. */
   void append(const QByteArray &data);
+  /** Reserves storage for the given total size of the element. This is a hint, the element may
+   * grow beyond it. */
+  void reserve(uint32_t size);
+
+  /** Returns the number of pages. */
+  unsigned int pageCount() const;
+  /** Returns the n-th page. All pages but the last one are full. */
+  QByteArrayView page(unsigned int n) const;
+  /** Returns the content hash of the n-th page (see @c PageStore::hash). */
+  uint64_t pageHash(unsigned int n) const;
+  /** Returns @c true if the n-th pages of this and the other element have the same content. Pages
+   * shared between the elements are compared by their address. All others are compared by their
+   * hashes first and, if these match, byte-wise. Hence a hash collision cannot hide a difference. */
+  bool samePage(const Element *other, unsigned int n) const;
+
+  /** Shares the full pages of this element with identical pages held by the given store. */
+  void share(PageStore &store);
+  /** Releases the contiguous copy of the content. References obtained by @c data become invalid.
+   */
+  void squeeze();
+  /** Returns the number of bytes held by the contiguous copy of the content, 0 if there is none. */
+  qsizetype copySize() const;
+  /** Returns @c true if the content is present, that is, it has been read from the source. */
+  bool loaded() const;
+  /** Returns @c true if the element has a source holding a copy of its content. */
+  bool hasSource() const;
+  /** Sets the source holding a copy of the current content. Takes ownership of the source. */
+  void setSource(ElementSource *source);
+  /** Releases the content, if it can be read again from the source. Returns @c false if there is
+   * no source. References obtained by @c data or @c page become invalid. */
+  bool evict();
+
+  /** Starts an update scope. Within the scope, @c modified is emitted at most once, when the
+   * outermost scope ends. Scopes can be nested. */
+  void beginUpdate();
+  /** Ends an update scope. */
+  void endUpdate();
 
   void addAnnotation(AbstractAnnotation *annotation);
   void clearAnnotations();
@@ -65,11 +152,31 @@ signals:
   /** Get emitted, if the element is modified at the specified address. */
   void modified(uint32_t address);
 
+protected:
+  /** Appends data to the pages. */
+  void appendPages(const char *data, qsizetype len);
+  /** Reads the content from the source, if not done yet. */
+  void load() const;
+
 protected:
   /** The start address of the element. */
   Address _address;
-  /** The content of the element. */
-  QByteArray _data;
+  /** The pages holding the content. */
+  QVector<QByteArray> _pages;
+  /** The content hashes of the full pages. */
+  QVector<uint64_t> _hashes;
+  /** The total size of the content. */
+  qsizetype _size;
+  /** Contiguous copy of the content, assembled on demand. */
+  mutable QByteArray _flat;
+  /** The source of the content, @c nullptr if none or if the content was modified. */
+  mutable ElementSource *_source;
+  /** If @c false, the content must be read from the source. */
+  mutable bool _loaded;
+  /** Depth of nested update scopes. */
+  unsigned int _updateDepth;
+  /** If @c true, the element was modified within the current update scope. */
+  bool _modifiedWithinUpdate;
 };
 
 
@@ -77,6 +184,12 @@ protected:
  *
  * Each image contains at least one @c Element of codeplug memory.
  *
+ * Every modification of the image is recorded into a set of dirty address ranges, that is
+ * announced by the @c updated signal. Outside of an update scope (see @c beginUpdate), the signal
+ * is emitted for every modification. Within a scope, modifications are coalesced and the signal is
+ * emitted once the scope ends or periodically (see @c setFlushInterval). This way, a programming
+ * session results in a handful of signals instead of one per received frame.
+ *
  * @ingroup codeplug */
 class Image : public QObject
 {
@@ -112,18 +225,52 @@ public:
 
   /** Appends some data to the image.
    * This may extend an existing element if the address points to the end of an element. If not, a
-   * new element is added to the image. */
+   * new element is added to the image. Extending the element modified last is a fast path, that
+   * needs no search. */
   void append(uint32_t address, const QByteArray &data);
   /** Appends some data to the image.
    * This may extend an existing element if the address points to the end of an element. If not, a
    * new element is added to the image. */
   void append(const Address &address, const QByteArray &data);
+  /** Adds the given element to the image and takes ownership. The element must not overlap with
+   * any other element of the image. */
+  void append(Element *element);
 
   /** Returns the label of the image. */
   const QString &label() const;
   /** Sets the label of the image. */
   void setLabel(const QString &label);
 
+  /** Sets the expected memory layout, used to preallocate the storage of new elements.
+   * The hints map start addresses of contiguous memory blocks to their size in bytes. */
+  void setSizeHints(const QMap<uint32_t, uint32_t> &hints);
+  /** Returns the expected number of bytes, that will be written contiguously starting at the given
+   * address. Returns 0 if unknown. */
+  uint32_t sizeHint(uint32_t address) const;
+
+  /** Shares the pages of all elements with identical pages held by the given store. */
+  void share(PageStore &store);
+  /** Releases the contiguous copies of the content of all elements. */
+  void squeeze();
+
+  /** Returns a digest of the content of the image. It is derived from the addresses and sizes of
+   * all elements and the content hashes of their pages. The digest itself is not maintained while
+   * the content is received, it is computed from the page hashes on each call. This is cheap, as
+   * the page hashes are maintained while receiving. Images with the same digest are likely
+   * identical, the content must be compared to be sure. */
+  uint64_t digest() const;
+  /** Returns the image this one is a duplicate of, @c nullptr if none. */
+  const Image *duplicateOf() const;
+  /** Marks this image as a duplicate of the given one. */
+  void setDuplicateOf(const Image *original);
+
+  /** Returns the journal of the writes this image was assembled from. The journal is only kept if
+   * the image was collected in journal mode and asked to keep it (see
+   * @c ImageCollector::setKeepJournal). */
+  const WriteJournal &journal() const;
+  /** Sets the journal of writes. */
+  void setJournal(const WriteJournal &journal);
+
   /** Annotates the image using the given pattern. */
   bool annotate(const CodeplugPattern *pattern);
 
@@ -135,18 +282,42 @@ public:
   /** Returns the most critical anntoation issue level. */
   AnnotationIssue::Severity annotationSeverity() const;
 
+  /** Starts an update scope. The elements emit their @c modified signal and the image its
+   * @c updated signal only once, when the outermost scope ends. Within a scope, the @c modified
+   * signal of the image is not emitted. Scopes can be nested. */
+  void beginUpdate();
+  /** Ends an update scope. */
+  void endUpdate();
+  /** Returns @c true, if within an update scope. */
+  bool updating() const;
+  /** Returns the interval in ms, the modifications within an update scope are announced in.
+   * 0 means only at the end of the scope. */
+  int flushInterval() const;
+  /** Sets the interval in ms, the modifications within an update scope are announced in. */
+  void setFlushInterval(int ms);
+
+public slots:
+  /** Announces all pending modifications by emitting @c updated. */
+  void flush();
+
 signals:
   /** Gets emitted when the image is modified at the specified address. */
   void modified(unsigned int image, uint32_t address);
+  /** Gets emitted with the address ranges modified since the last emission. */
+  void updated(const DirtySet &ranges);
   /** Gets emitted when the image is annotated. */
   void annotated(Image *img);
 
 protected:
   /** Helper function to insert a new element into the image. */
   void add(Element *el);
-  /** Binary search for insertion index of the address. */
+  /** Returns the index of the element containing or preceding the given address, -1 if none. */
+  int findPredIndex(const Address &address) const;
+  /** Binary search for insertion index of the address. That is, the index of the first element
+   * within [a,b) at or behind the given address. */
   unsigned int findInsertionIndex(uint32_t address, unsigned int a, unsigned int b) const;
-  /** Binary search for insertion index of the address. */
+  /** Binary search for insertion index of the address. That is, the index of the first element
+   * within [a,b) at or behind the given address. */
   unsigned int findInsertionIndex(const Address &address, unsigned int a, unsigned int b) const;
 
 protected:
@@ -154,11 +325,38 @@ protected:
   QString _label;
   /** The elements of the image, sorted by ascending address. */
   QVector<Element *> _elements;
+  /** Index of the element modified last, -1 if none. As the CPS usually writes in ascending
+   * order, the next write likely extends this element. */
+  int _cursor;
+  /** The expected memory blocks. */
+  QMap<uint32_t, uint32_t> _sizeHints;
+  /** The journal of writes, if recorded. */
+  WriteJournal _journal;
+  /** The image this one is a duplicate of. */
+  QPointer<const Image> _duplicateOf;
+  /** Depth of nested update scopes. */
+  unsigned int _updateDepth;
+  /** The modifications not announced yet. */
+  DirtySet _dirty;
+  /** The interval of announcing modifications within an update scope. */
+  int _flushInterval;
+  /** Timer to announce modifications periodically, created on demand. */
+  QTimer *_flushTimer;
 };
 
 
 
 /** A collection of several received codeplug images.
+ *
+ * The memory held by the images can be limited by a budget (see @c setMemoryBudget). Once the
+ * content of all images exceeds the budget, the least recently used images are evicted. That is,
+ * the content of their elements is released and read back on the next access, either from the
+ * archive the image was loaded from or from a temporary spill file. Images are used by appending
+ * them or by @c touch.
+ *
+ * Appended images identical to an image already held (see @c Image::digest) are marked as
+ * duplicates of the latter (see @c Image::duplicateOf). Their pages are shared anyway. Images
+ * whose content is not read yet (e.g., loaded from an archive) are not checked for duplicates.
  * @ingroup codeplug */
 class Collection: public QObject
 {
@@ -175,11 +373,31 @@ public:
   /** Searches for the index of the given image. */
   int indexOf(const Image *img) const;
 
-  /** Appends an image. */
+  /** Appends an image. The pages of the image get shared with all other images of the
+   * collection. */
   void append(Image *image);
+  /** Appends an image created within another thread. The image must not have a parent. It gets
+   * moved to the thread of the collection and appended there, once the event loop of that thread
+   * is entered. This method can be called from any thread. */
+  void appendLater(Image *image);
   /** Deletes the specified image. */
   void deleteImage(unsigned int idx);
 
+  /** Marks the given image as used recently. This may evict other images, unless @c enforce is
+   * @c false. Then, the budget is kept with the next call to @c enforceBudget. */
+  void touch(const Image *image, bool enforce=true);
+  /** Evicts the least recently used images until the memory usage is within the budget. The
+   * image used last is never evicted. As this counts all pages held, analyses touching many images
+   * should call it once in a while rather than after each image. */
+  void enforceBudget();
+  /** Returns the memory budget in bytes, 0 if unlimited. */
+  qsizetype memoryBudget() const;
+  /** Sets the memory budget in bytes, 0 means unlimited. */
+  void setMemoryBudget(qsizetype bytes);
+  /** Returns the number of bytes held by the pages of all images. Shared pages are counted once.
+   * Contiguous copies of the content (see @c Element::data) are included. */
+  qsizetype memoryUsage() const;
+
 signals:
   /** Gets emitted when an image is added. */
   void imageAdded(unsigned int idx);
@@ -194,9 +412,28 @@ protected slots:
   /** Internal callback on image annotations. */
   void onImageAnnotated(Image *img);
 
+protected:
+  /** Counts the references to the pages of all loaded elements and returns the total number of
+   * bytes held, including the contiguous copies of their content. */
+  qsizetype countPages(QHash<const char *, int> &refs) const;
+  /** Removes the image from the digest index. If it was the original of some duplicates, the
+   * oldest of them becomes the original of the others. */
+  void removeDigest(Image *image);
+
 protected:
   /** The set of images. */
   QVector<Image *> _images;
+  /** The pages shared between all images. */
+  PageStore _pages;
+  /** The images ordered by their last use, least recently used first. */
+  QVector<Image *> _recent;
+  /** The memory budget in bytes, 0 if unlimited. */
+  qsizetype _budget;
+  /** Holds the content of evicted elements. */
+  SpillFile _spill;
+  /** The images indexed by their digest, in the order they were appended. The first one is the
+   * original of the others. */
+  QHash<uint64_t, QVector<Image *>> _digests;
 };
 
 
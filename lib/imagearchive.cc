@@ -0,0 +1,270 @@
+#include "imagearchive.hh"
+#include "image.hh"
+#include <QFile>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QtEndian>
+#include <cstring>
+
+
+static const char    ArchiveMagic[8] = {'A','E','I','M','A','G','E','S'};
+static const quint16 ArchiveVersion = 1;
+/** Size of the header, magic, version and flags. */
+static const qint64  ArchiveHeaderSize = sizeof(ArchiveMagic) + 2*sizeof(quint16);
+/** Size of the trailer, the index offset. */
+static const qint64  ArchiveTrailerSize = sizeof(quint64);
+
+
+/** Reads the content of an element from a memory mapped archive.
+ * The source keeps the archive file, and thus the mapping, alive. */
+class ArchiveSource: public ElementSource
+{
+public:
+  /** Constructs a source for the payload at the given location within the mapped file. */
+  ArchiveSource(const QSharedPointer<QFile> &file, const uchar *payload, quint32 length,
+                bool compressed)
+    : ElementSource(), _file(file), _payload(payload), _length(length), _compressed(compressed)
+  {
+    // pass...
+  }
+
+  QByteArray read() const override {
+    if (_compressed)
+      return qUncompress(_payload, _length);
+    return QByteArray((const char *)_payload, _length);
+  }
+
+protected:
+  /** The mapped archive file. */
+  QSharedPointer<QFile> _file;
+  /** The payload within the mapped file. */
+  const uchar *_payload;
+  /** The length of the payload. */
+  quint32 _length;
+  /** If @c true, the payload is compressed. */
+  bool _compressed;
+};
+
+
+template <typename T>
+static void
+appendLE(QByteArray &buffer, T value) {
+  uchar bytes[sizeof(T)];
+  qToLittleEndian<T>(value, bytes);
+  buffer.append((const char *)bytes, sizeof(T));
+}
+
+template <typename T>
+static bool
+takeLE(const uchar *&ptr, const uchar *end, T &value) {
+  if ((end - ptr) < qsizetype(sizeof(T)))
+    return false;
+  value = qFromLittleEndian<T>(ptr);
+  ptr += sizeof(T);
+  return true;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of ImageArchive
+ * ********************************************************************************************* */
+bool
+ImageArchive::write(QIODevice *device, const QVector<const Image *> &images, bool compress,
+                    const ErrorStack &err)
+{
+  QByteArray header(ArchiveMagic, sizeof(ArchiveMagic));
+  appendLE<quint16>(header, ArchiveVersion);
+  appendLE<quint16>(header, compress ? Compressed : None);
+  if (header.size() != device->write(header)) {
+    errMsg(err) << "Cannot write archive header: " << device->errorString() << ".";
+    return false;
+  }
+
+  // The index is collected while writing the payloads.
+  quint64 offset = header.size();
+  QByteArray index;
+  appendLE<quint32>(index, images.size());
+  foreach (const Image *image, images) {
+    QByteArray label = image->label().toUtf8().left(0xffff);
+    appendLE<quint16>(index, label.size());
+    index.append(label);
+    appendLE<quint32>(index, image->count());
+    for (const Element *element: *image) {
+      qint64 length = 0;
+      if (compress) {
+        QByteArray content;
+        content.reserve(element->size().byte());
+        for (unsigned int i=0; i<element->pageCount(); i++)
+          content.append(element->page(i));
+        QByteArray payload = qCompress(content);
+        length = device->write(payload);
+        if (payload.size() != length)
+          length = -1;
+      } else {
+        for (unsigned int i=0; (i<element->pageCount()) && (0 <= length); i++) {
+          QByteArrayView page = element->page(i);
+          if (page.size() == device->write(page.data(), page.size()))
+            length += page.size();
+          else
+            length = -1;
+        }
+      }
+      if (0 > length) {
+        errMsg(err) << "Cannot write content of element " << element->address().toString()
+                    << ": " << device->errorString() << ".";
+        return false;
+      }
+      appendLE<quint32>(index, element->address().byte());
+      appendLE<quint32>(index, element->size().byte());
+      appendLE<quint64>(index, offset);
+      appendLE<quint32>(index, length);
+      offset += length;
+    }
+  }
+  appendLE<quint64>(index, offset);
+
+  if (index.size() != device->write(index)) {
+    errMsg(err) << "Cannot write archive index: " << device->errorString() << ".";
+    return false;
+  }
+
+  return true;
+}
+
+bool
+ImageArchive::save(const QString &filename, const QVector<const Image *> &images, bool compress,
+                   const ErrorStack &err)
+{
+  // Write into a temporary file, the archive may still be mapped by a previous load.
+  QSaveFile file(filename);
+  if (! file.open(QIODevice::WriteOnly)) {
+    errMsg(err) << "Cannot open archive '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+  if (! write(&file, images, compress, err)) {
+    errMsg(err) << "Cannot write archive '" << filename << "'.";
+    file.cancelWriting();
+    return false;
+  }
+  if (! file.commit()) {
+    errMsg(err) << "Cannot save archive '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+  return true;
+}
+
+bool
+ImageArchive::save(const QString &filename, const Collection *collection, bool compress,
+                   const ErrorStack &err)
+{
+  QVector<const Image *> images;
+  for (unsigned int i=0; i<collection->count(); i++)
+    images.append(collection->image(i));
+  return save(filename, images, compress, err);
+}
+
+
+bool
+ImageArchive::load(const QString &filename, QVector<Image *> &images, const ErrorStack &err) {
+  QSharedPointer<QFile> file(new QFile(filename));
+  if (! file->open(QIODevice::ReadOnly)) {
+    errMsg(err) << "Cannot open archive '" << filename << "': " << file->errorString() << ".";
+    return false;
+  }
+
+  qint64 size = file->size();
+  if (size < (ArchiveHeaderSize + ArchiveTrailerSize)) {
+    errMsg(err) << "'" << filename << "' is not an image archive.";
+    return false;
+  }
+
+  // The mapping remains valid after closing the file, until the file object is destroyed.
+  const uchar *map = file->map(0, size);
+  if (nullptr == map) {
+    errMsg(err) << "Cannot map archive '" << filename << "': " << file->errorString() << ".";
+    return false;
+  }
+  file->close();
+
+  if (0 != memcmp(map, ArchiveMagic, sizeof(ArchiveMagic))) {
+    errMsg(err) << "'" << filename << "' is not an image archive.";
+    return false;
+  }
+  quint16 version = qFromLittleEndian<quint16>(map + sizeof(ArchiveMagic));
+  if (ArchiveVersion != version) {
+    errMsg(err) << "Unsupported archive version " << version << ".";
+    return false;
+  }
+  bool compressed = Compressed & qFromLittleEndian<quint16>(map + sizeof(ArchiveMagic) + 2);
+
+  quint64 indexOffset = qFromLittleEndian<quint64>(map + size - ArchiveTrailerSize);
+  if ((indexOffset < quint64(ArchiveHeaderSize))
+      || (indexOffset > quint64(size - ArchiveTrailerSize))) {
+    errMsg(err) << "Invalid index offset " << indexOffset << " in archive.";
+    return false;
+  }
+
+  const uchar *ptr = map + indexOffset, *end = map + size - ArchiveTrailerSize;
+  quint32 imageCount;
+  if (! takeLE(ptr, end, imageCount)) {
+    errMsg(err) << "Truncated archive index.";
+    return false;
+  }
+
+  QVector<Image *> loaded;
+  for (quint32 i=0; i<imageCount; i++) {
+    quint16 labelLength; quint32 elementCount;
+    if ((! takeLE(ptr, end, labelLength)) || ((end-ptr) < labelLength)) {
+      errMsg(err) << "Truncated archive index.";
+      qDeleteAll(loaded);
+      return false;
+    }
+    Image *image = new Image(QString::fromUtf8((const char *)ptr, labelLength));
+    loaded.append(image);
+    ptr += labelLength;
+    if (! takeLE(ptr, end, elementCount)) {
+      errMsg(err) << "Truncated archive index.";
+      qDeleteAll(loaded);
+      return false;
+    }
+
+    quint64 next = 0;
+    for (quint32 j=0; j<elementCount; j++) {
+      quint32 address, elementSize, length; quint64 offset;
+      if ((! takeLE(ptr, end, address)) || (! takeLE(ptr, end, elementSize))
+          || (! takeLE(ptr, end, offset)) || (! takeLE(ptr, end, length))) {
+        errMsg(err) << "Truncated archive index.";
+        qDeleteAll(loaded);
+        return false;
+      }
+      if ((offset < quint64(ArchiveHeaderSize)) || (offset > indexOffset)
+          || (length > (indexOffset - offset))
+          || ((! compressed) && (length != elementSize))) {
+        errMsg(err) << "Invalid content of element " << Qt::hex << address << "h in archive.";
+        qDeleteAll(loaded);
+        return false;
+      }
+      if (address < next) {
+        errMsg(err) << "Element " << Qt::hex << address << "h overlaps with previous one in archive.";
+        qDeleteAll(loaded);
+        return false;
+      }
+      next = quint64(address) + elementSize;
+      image->append(new Element(Address::fromByte(address), elementSize,
+                                new ArchiveSource(file, map + offset, length, compressed)));
+    }
+  }
+
+  images.append(loaded);
+  return true;
+}
+
+bool
+ImageArchive::load(const QString &filename, Collection *collection, const ErrorStack &err) {
+  QVector<Image *> images;
+  if (! load(filename, images, err))
+    return false;
+  foreach (Image *image, images)
+    collection->append(image);
+  return true;
+}
@@ -0,0 +1,62 @@
+#ifndef IMAGEARCHIVE_HH
+#define IMAGEARCHIVE_HH
+
+#include <QIODevice>
+#include <QVector>
+#include "errorstack.hh"
+
+class Image;
+class Collection;
+
+
+/** Stores codeplug images in a compact binary archive.
+ *
+ * The archive consists of a header, the raw content of all elements of all images, followed by an
+ * index of the images and their elements. The index is located via a trailer at the end of the
+ * file. The content of each element may be compressed using @c qCompress. All integers are
+ * stored in little endian:
+ * @code
+ * header:  "AEIMAGES" | version (u16) | flags (u16)
+ * payload: content of each element, compressed if flag 0x0001 is set
+ * index:   image count (u32) | images...
+ * image:   label length (u16) | label | element count (u32) | elements...
+ * element: address (u32) | size (u32) | payload offset (u64) | payload length (u32)
+ * trailer: index offset (u64)
+ * @endcode
+ *
+ * When loading an archive, the file is memory mapped and only the index is read. The elements are
+ * created with their address and size only. Their content is read from the mapped file, once it
+ * is accessed for the first time (see @c ElementSource).
+ *
+ * @ingroup codeplug */
+class ImageArchive
+{
+public:
+  /** Possible flags of an archive. */
+  enum Flags {
+    None       = 0x0000,  ///< Uncompressed archive.
+    Compressed = 0x0001   ///< Content of elements is compressed.
+  };
+
+public:
+  /** Writes the given images into the device. */
+  static bool write(QIODevice *device, const QVector<const Image *> &images,
+                    bool compress=false, const ErrorStack &err=ErrorStack());
+  /** Saves the given images into the specified file. The file is replaced atomically, hence an
+   * archive can be saved over the one it was loaded from. */
+  static bool save(const QString &filename, const QVector<const Image *> &images,
+                   bool compress=false, const ErrorStack &err=ErrorStack());
+  /** Saves all images of the collection into the specified file. */
+  static bool save(const QString &filename, const Collection *collection,
+                   bool compress=false, const ErrorStack &err=ErrorStack());
+
+  /** Loads the images from the specified archive. The content of the elements is read on demand.
+   * On success, the images are appended to the given list and the caller takes ownership. */
+  static bool load(const QString &filename, QVector<Image *> &images,
+                   const ErrorStack &err=ErrorStack());
+  /** Loads the images from the specified archive and appends them to the collection. */
+  static bool load(const QString &filename, Collection *collection,
+                   const ErrorStack &err=ErrorStack());
+};
+
+#endif // IMAGEARCHIVE_HH
@@ -66,7 +66,7 @@ LogHandler::~LogHandler() {
 Logger *Logger::_instance = nullptr;
 
 Logger::Logger()
-  : QObject(nullptr), _handler()
+  : QObject(nullptr), _handler(), _mutex()
 {
   // pass...
 }
@@ -77,6 +77,7 @@ Logger::~Logger() {
 
 void
 Logger::log(const LogMessage &msg) {
+  QMutexLocker locker(&_mutex);
   foreach (LogHandler *handler, _handler) {
     handler->handle(msg);
   }
@@ -86,6 +87,7 @@ void
 Logger::addHandler(LogHandler *handler) {
   if (nullptr == handler)
     return;
+  QMutexLocker locker(&_mutex);
   if (_handler.contains(handler))
     return;
   handler->setParent(this);
@@ -95,6 +97,7 @@ Logger::addHandler(LogHandler *handler) {
 
 void
 Logger::remHandler(LogHandler *handler) {
+  QMutexLocker locker(&_mutex);
   if (_handler.contains(handler)) {
     handler->setParent(nullptr);
     disconnect(handler, SIGNAL(destroyed(QObject*)), this, SLOT(onHandlerDeleted(QObject*)));
@@ -104,6 +107,7 @@ Logger::remHandler(LogHandler *handler) {
 
 void
 Logger::onHandlerDeleted(QObject *obj) {
+  QMutexLocker locker(&_mutex);
   _handler.removeAll(dynamic_cast<LogHandler*>(obj));
 }
 
@@ -9,6 +9,7 @@
 #include <QFile>
 #include <QTextStream>
 #include <QList>
+#include <QRecursiveMutex>
 
 /** Constructs a debug message.
  * @ingroup log */
@@ -112,7 +113,7 @@ public:
   /** Destructor. */
   virtual ~Logger();
 
-  /** Logs a message. */
+  /** Logs a message. This method can be called from any thread. */
   void log(const LogMessage &msg);
   /** Adds a log-handler to the logger. The ownership is transferred to the logger. */
   void addHandler(LogHandler *handler);
@@ -132,6 +133,8 @@ protected:
   static Logger *_instance;
   /** The list of registered log-handler. */
   QList<LogHandler *> _handler;
+  /** Serializes the access to the handlers, messages may originate from several threads. */
+  QRecursiveMutex _mutex;
 };
 
 
@@ -2,13 +2,15 @@
 #include "image.hh"
 #include "logger.hh"
 #include "pattern.hh"
+#include <algorithm>
 
 
 /* ********************************************************************************************* *
  * Implementation of ImageCollector
  * ********************************************************************************************* */
 ImageCollector::ImageCollector(QObject *parent)
-  : QObject(parent), _images()
+  : QObject(parent), _images(), _sizeHints(), _journaling(false), _keepJournal(false),
+    _journal(), _pages()
 {
   // pass...
 }
@@ -46,6 +48,65 @@ ImageCollector::previous() const {
 }
 
 
+void
+ImageCollector::setSizeHints(const CodeplugPattern *pattern) {
+  _sizeHints.clear();
+  if (nullptr == pattern)
+    return;
+
+  for (unsigned int i=0; i<pattern->numChildPattern(); i++) {
+    auto block = pattern->childPattern(i)->as<FixedPattern>();
+    if ((nullptr == block) || (! block->hasAddress()) || (! block->hasSize()))
+      continue;
+    uint32_t address = block->address().byte(), size = block->size().byte();
+    if (0 == size)
+      continue;
+    // Merge with preceding adjacent or overlapping block, as the CPS writes them contiguously.
+    auto next = _sizeHints.upperBound(address);
+    if (_sizeHints.begin() != next) {
+      auto prev = std::prev(next);
+      if ((uint64_t(prev.key()) + prev.value()) >= address) {
+        prev.value() = std::max(uint64_t(prev.value()), uint64_t(address)+size-prev.key());
+        continue;
+      }
+    }
+    _sizeHints.insert(address, size);
+  }
+}
+
+
+bool
+ImageCollector::journaling() const {
+  return _journaling;
+}
+
+void
+ImageCollector::setJournaling(bool enable) {
+  _journaling = enable;
+}
+
+bool
+ImageCollector::keepJournal() const {
+  return _keepJournal;
+}
+
+void
+ImageCollector::setKeepJournal(bool enable) {
+  _keepJournal = enable;
+}
+
+void
+ImageCollector::applyJournal(Image *image) {
+  if (_journal.isEmpty())
+    return;
+  logDebug() << "Apply journal of " << _journal.count() << " writes.";
+  _journal.apply(image);
+  if (_keepJournal)
+    image->setJournal(_journal);
+  _journal.clear();
+}
+
+
 bool
 ImageCollector::read(uint32_t address, uint8_t length, QByteArray &payload) {
   Q_UNUSED(address); Q_UNUSED(length); Q_UNUSED(payload)
@@ -58,26 +119,49 @@ ImageCollector::write(uint32_t address, const QByteArray &payload) {
     logError() << "No image created yet.";
     return false;
   }
-  _images.last()->append(address, payload);
+  if (_journaling)
+    _journal.record(address, payload);
+  else
+    _images.last()->append(address, payload);
   return true;
 }
 
 
 void
 ImageCollector::startProgram() {
+  // Assemble an incomplete previous session
+  if (0 != _images.count()) {
+    applyJournal(_images.last());
+    if (_images.last()->updating())
+      _images.last()->endUpdate();
+  }
+
   if ((0 == _images.count()) || (0 != _images.last()->count())) {
     logInfo() << "Create new image.";
     _images.append(new Image(QString("Codeplug %1").arg(_images.count()), this));
+    _images.last()->setSizeHints(_sizeHints);
   } else if (0 == _images.last()->count()) {
     logInfo() << "Reuse last image.";
   }
+  // Announce the modifications once at the end of the session.
+  _images.last()->beginUpdate();
 }
 
 void
 ImageCollector::endProgram() {
+  if (0 != _images.count()) {
+    applyJournal(_images.last());
+    if (_images.last()->updating())
+      _images.last()->endUpdate();
+  }
+
   if ((0 != _images.count()) && (0 != _images.last()->count())) {
     logInfo() << "Image received.";
+    _images.last()->share(_pages);
     emit imageReceived();
+    // Drop the contiguous copies assembled by the receivers, only the shared pages are kept.
+    foreach (auto image, _images)
+      image->squeeze();
   }
 }
 
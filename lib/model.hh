@@ -2,8 +2,12 @@
 #define MODEL_HH
 
 #include <QObject>
+#include <QMap>
+#include "writejournal.hh"
+#include "pagestore.hh"
 
 class Image;
+class CodeplugPattern;
 
 
 /** A memory model to collect and strore images.
@@ -38,6 +42,22 @@ public:
    * Retruns @c nullptr if is are none. */
   const Image *previous() const;
 
+  /** Derives the expected memory layout from the top-level blocks of the given codeplug pattern.
+   * The layout is passed to new images to preallocate the storage of their elements. */
+  void setSizeHints(const CodeplugPattern *pattern);
+
+  /** Returns @c true if writes are recorded into a journal. */
+  bool journaling() const;
+  /** Enables or disables journal mode. In journal mode, writes received during programming are
+   * just recorded. The image gets assembled from the journal once the programming ended. */
+  void setJournaling(bool enable);
+  /** Returns @c true if the images keep the journal they were assembled from. */
+  bool keepJournal() const;
+  /** If enabled, the images assembled in journal mode keep the journal (see @c Image::journal).
+   * The journal holds a copy of all writes, that is not part of the memory budget of a
+   * @c Collection. Hence it is dropped by default. */
+  void setKeepJournal(bool enable);
+
 public slots:
   /** Gets called when the "radio programming" starts. */
   virtual void startProgram();
@@ -48,9 +68,23 @@ signals:
   /** Gets emitted, once an image is received. */
   void imageReceived();
 
+protected:
+  /** Assembles the given image from the current journal, if there is one. */
+  void applyJournal(Image *image);
+
 protected:
   /** The images. */
   QVector<Image *> _images;
+  /** Expected memory blocks, maps start addresses to sizes. */
+  QMap<uint32_t, uint32_t> _sizeHints;
+  /** If @c true, writes are recorded into the journal. */
+  bool _journaling;
+  /** If @c true, the images keep their journal. */
+  bool _keepJournal;
+  /** The writes of the current programming session. */
+  WriteJournal _journal;
+  /** The pages shared between all received images. */
+  PageStore _pages;
 };
 
 
@@ -1,8 +1,14 @@
 #include "modelrom.hh"
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include "logger.hh"
 
 
+/** Source of content stamps, shared by all instances. Stamp 0 is reserved for the empty ROM. */
+static std::atomic<uint64_t> lastGeneration(0);
+
+
 /* ********************************************************************************************** *
  * Implementation of ModelRom::Segment
  * ********************************************************************************************** */
@@ -19,7 +25,12 @@ ModelRom::Segment::operator <(uint32_t rhs_address) const {
 bool
 ModelRom::Segment::contains(uint32_t address, uint16_t size) const {
   return (this->address <= address)
-      && ((this->address+content.size()) >= (address+size));
+      && (end() >= (uint64_t(address)+size));
+}
+
+uint64_t
+ModelRom::Segment::end() const {
+  return uint64_t(address) + content.size();
 }
 
 
@@ -28,7 +39,7 @@ ModelRom::Segment::contains(uint32_t address, uint16_t size) const {
  * Implementation of ModelRom
  * ********************************************************************************************** */
 ModelRom::ModelRom()
-  : _content()
+  : _content(), _pages(), _generation(0)
 {
   // pass...
 }
@@ -37,9 +48,7 @@ ModelRom::ModelRom()
 ModelRom
 ModelRom::operator +(const ModelRom &rhs) const {
   ModelRom res(*this);
-  foreach (const Segment &segment, rhs) {
-    res.write(segment.address, segment.content);
-  }
+  res += rhs;
   return res;
 }
 
@@ -56,71 +65,117 @@ ModelRom::segmentCount() const {
   return _content.size();
 }
 
+uint64_t
+ModelRom::generation() const {
+  return _generation;
+}
+
 void
 ModelRom::write(uint32_t address, const QByteArray &data) {
-  auto left = std::lower_bound(begin(), end(), address);
-  // we use end() as an invalid iterator
-  auto prev = (begin() != left) ? left-1 : end(),
-      next = (end() != left) ? left+1 : end();
-
-  if ((end() != prev) && ((prev->address + prev->content.size()) == address)) {
-    prev->content.append(data);
-  } else if ((end() != prev) && prev->contains(address, data.size())) {
-    uint32_t offset = address - prev->address;
-    memcpy(prev->content.data()+offset, data.data(), data.size());
-  } else if ((end() != left) && left->contains(address, data.size())) {
-    uint32_t offset = address - left->address;
-    memcpy(left->content.data()+offset, data.data(), data.size());
-  } else if ((end() == left) || ((address+data.size()) < left->address)) {
-    _content.insert(left, {address, data});
+  if (data.isEmpty())
+    return;
+
+  _generation = ++lastGeneration;
+
+  uint64_t end = uint64_t(address) + data.size();
+  // First segment ending at or behind the address, that is, the first segment to touch or merge.
+  auto first = std::partition_point(_content.begin(), _content.end(), [address](const Segment &s) {
+    return s.end() < address;
+  });
+  // First segment starting behind the new data, that is, the first not to touch.
+  auto last = std::partition_point(first, _content.end(), [end](const Segment &s) {
+    return s.address <= end;
+  });
+
+  if (first == last) {
+    // Disjoint from all other segments
+    auto idx = first - _content.begin();
+    _content.insert(first, {address, data});
+    updateIndex(idx, 1, address, end);
+  } else if ((1 == (last-first)) && first->contains(address, 0) && (first->end() >= end)) {
+    // Contained in a single segment, override in place
+    memcpy(first->content.data() + (address - first->address), data.constData(), data.size());
+    // Page index unchanged
+  } else if ((1 == (last-first)) && (first->end() == address)) {
+    // Extends a single segment, append (amortized), only the new pages need to be indexed
+    first->content.append(data);
+    updateIndex(first - _content.begin(), 0, address, end);
   } else {
-    _content.insert(next, {address, data});
+    // Merge all touched segments and the new data into one
+    uint32_t start = std::min(address, first->address);
+    uint64_t stop = std::max(end, (last-1)->end());
+    QByteArray merged(stop - start, '\0');
+    for (auto s=first; s!=last; s++)
+      memcpy(merged.data() + (s->address - start), s->content.constData(), s->content.size());
+    memcpy(merged.data() + (address - start), data.constData(), data.size());
+    auto idx = first - _content.begin();
+    int removed = (last - first) - 1;
+    _content.erase(first+1, last);
+    _content[idx] = {start, merged};
+    updateIndex(idx, -removed, start, stop);
   }
 }
 
 
 bool
 ModelRom::read(uint32_t address, uint16_t length, QByteArray &data) const {
-  auto next = std::lower_bound(begin(), end(), address);
-
-  if (begin() == next) {
-    if ((end() == next) || (next->address != address) || (! next->contains(address, length))) {
-      logDebug() << "Cannot read from rom at address " << QString::number(address, 16)
-                 << "h: No segment containing this address found.";
-      return false;
-    }
-
-    uint32_t offset = address - next->address;
-    data = next->content.mid(offset, length);
-    return true;
-  }
-
-  auto prev = next-1;
-  if (((end() != next) && !next->contains(address, length)) && (! prev->contains(address, length))) {
+  int idx = find(address, length);
+  if (0 > idx) {
     logDebug() << "Cannot read from rom at address " << QString::number(address, 16)
                << "h: No segment containing this address found.";
     return false;
   }
 
-  if ((end() != next) && next->contains(address, length)) {
-    data = next->content.first(length);
-  } else {
-    uint32_t offset = address - prev->address;
-    data = prev->content.mid(offset, length);
-  }
-
+  const Segment &segment = _content.at(idx);
+  data = QByteArray::fromRawData(segment.content.constData() + (address - segment.address), length);
   return true;
 }
 
 
-ModelRom::iterator
-ModelRom::begin() {
-  return _content.begin();
+int
+ModelRom::find(uint32_t address, uint16_t length) const {
+  auto page = _pages.constFind(address >> PageBits);
+  if (_pages.constEnd() == page)
+    return -1;
+
+  // Segments are disjoint and sorted, the first segment starting behind the address terminates.
+  for (int i=page.value(); (i<_content.size()) && (_content.at(i).address <= address); i++) {
+    if (_content.at(i).contains(address, length))
+      return i;
+  }
+
+  return -1;
 }
 
-ModelRom::iterator
-ModelRom::end() {
-  return _content.end();
+void
+ModelRom::updateIndex(int idx, int delta, uint32_t address, uint64_t end) {
+  // Segments behind the modified one moved by delta. Shift the entries of their pages, as long as
+  // these still refer to them. Processed such that no entry gets shifted twice.
+  auto shift = [this, delta](int i) {
+    const Segment &segment = _content.at(i);
+    for (uint32_t p=(segment.address >> PageBits); p<=((segment.end()-1) >> PageBits); p++) {
+      auto entry = _pages.find(p);
+      if ((_pages.end() != entry) && ((i-delta) == entry.value()))
+        entry.value() = i;
+    }
+  };
+  if (delta > 0) {
+    for (int i=_content.size()-1; i>idx; i--)
+      shift(i);
+  } else if (delta < 0) {
+    for (int i=idx+1; i<_content.size(); i++)
+      shift(i);
+  }
+
+  // Index the modified range. Entries of pages shared with a preceding segment are kept, entries of
+  // merged segments and those of pages shared with the following segment are replaced.
+  for (uint32_t p=(address >> PageBits); p<=((end-1) >> PageBits); p++) {
+    auto entry = _pages.find(p);
+    if (_pages.end() == entry)
+      _pages.insert(p, idx);
+    else if (entry.value() >= idx)
+      entry.value() = idx;
+  }
 }
 
 
@@ -133,4 +188,3 @@ ModelRom::const_iterator
 ModelRom::end() const {
   return _content.end();
 }
-
@@ -4,9 +4,19 @@
 #include <cstdint>
 #include <QByteArray>
 #include <QVector>
+#include <QHash>
 
 
-/** Implementes some fixed memory read from an emulated model. */
+/** Implementes some fixed memory read from an emulated model.
+ *
+ * The content is kept as a sorted list of disjoint segments. Writes coalesce overlapping and
+ * adjacent segments, hence every contiguous range of mapped memory is held by exactly one
+ * segment. Additionally, a page index maps each page of @c PageSize bytes to the first segment
+ * intersecting it. Thus, a lookup is a hash lookup followed by a scan over the (usually one or
+ * two) segments within that page.
+ *
+ * Reads do not copy the content but return non-owning views into the segments. These views remain
+ * valid until the ROM gets written or destroyed. */
 class ModelRom
 {
 public:
@@ -17,30 +27,54 @@ public:
     bool operator<(const Segment &other) const;
     bool operator<(uint32_t address) const;
     bool contains(uint32_t address, uint16_t size=0) const;
+    /** Returns the address just behind the segment. */
+    uint64_t end() const;
   };
 
-  typedef QVector<Segment>::iterator iterator;
   typedef QVector<Segment>::const_iterator const_iterator;
 
+  /** Number of address bits of a page. */
+  static constexpr unsigned int PageBits = 12;
+  /** Size of a page of the index. */
+  static constexpr uint32_t PageSize = (1u << PageBits);
+
 public:
   ModelRom();
   ModelRom(const ModelRom &other) = default;
+  ModelRom &operator=(const ModelRom &other) = default;
 
   ModelRom operator+(const ModelRom &other) const;
   const ModelRom &operator+=(const ModelRom &other);
 
   unsigned int segmentCount() const;
+  /** Returns a stamp identifying the current content. Every write assigns a new, globally unique
+   * stamp. Hence caches derived from the content can detect modifications cheaply. */
+  uint64_t generation() const;
 
+  /** Stores the given data at the given address. Overlapping content gets overridden. */
   void write(uint32_t address, const QByteArray &data);
+  /** Reads @c length bytes from the given address. On success, @c data is a non-owning view into
+   * the ROM content. Any receiver keeping the data beyond the next write must detach it. */
   bool read(uint32_t address, uint16_t length, QByteArray &data) const;
 
   const_iterator begin() const;
   const_iterator end() const;
-  iterator begin();
-  iterator end();
 
 protected:
+  /** Returns the index of the segment containing the given range or -1 if there is none. */
+  int find(uint32_t address, uint16_t length) const;
+  /** Updates the page index after the segment at @c idx was modified within the given range.
+   * All segments behind it moved by @c delta positions. Only the pages of the modified range and
+   * of the moved segments are visited. */
+  void updateIndex(int idx, int delta, uint32_t address, uint64_t end);
+
+protected:
+  /** The disjoint, sorted segments. */
   QVector<Segment> _content;
+  /** Maps page numbers to the index of the first segment intersecting that page. */
+  QHash<uint32_t, int> _pages;
+  /** Content stamp. */
+  uint64_t _generation;
 };
 
 
@@ -0,0 +1,126 @@
+#include "pagestore.hh"
+#include <cstring>
+
+
+/* ********************************************************************************************* *
+ * XXH64 implementation
+ * ********************************************************************************************* */
+static const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t prime3 = 0x165667B19E3779F9ULL;
+static const uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t
+rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+read64(const char *p) {
+  uint64_t v; memcpy(&v, p, 8);
+  return v;
+}
+
+static inline uint32_t
+read32(const char *p) {
+  uint32_t v; memcpy(&v, p, 4);
+  return v;
+}
+
+static inline uint64_t
+xxhRound(uint64_t acc, uint64_t input) {
+  acc += input * prime2;
+  acc = rotl(acc, 31);
+  return acc * prime1;
+}
+
+static inline uint64_t
+xxhMergeRound(uint64_t acc, uint64_t val) {
+  acc ^= xxhRound(0, val);
+  return acc * prime1 + prime4;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of PageStore
+ * ********************************************************************************************* */
+PageStore::PageStore()
+  : _pages()
+{
+  // pass...
+}
+
+
+void
+PageStore::intern(QByteArray &page, uint64_t hash) {
+  for (auto it = _pages.find(hash); (_pages.end() != it) && (it.key() == hash); it++) {
+    if (it.value().constData() == page.constData())
+      return;
+    if (it.value() == page) {
+      page = it.value();
+      return;
+    }
+  }
+  _pages.insert(hash, page);
+}
+
+void
+PageStore::purge() {
+  for (auto it = _pages.begin(); _pages.end() != it;) {
+    // Only referenced by the store
+    if (it.value().isDetached())
+      it = _pages.erase(it);
+    else
+      it++;
+  }
+}
+
+qsizetype
+PageStore::count() const {
+  return _pages.size();
+}
+
+
+uint64_t
+PageStore::hash(const char *data, qsizetype len, uint64_t seed) {
+  // Assumes a little-endian host, the hash is only used in-process.
+  const char *p = data, *end = data + len;
+  uint64_t h;
+
+  if (len >= 32) {
+    uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed, v4 = seed - prime1;
+    for (; (p+32) <= end; p += 32) {
+      v1 = xxhRound(v1, read64(p));
+      v2 = xxhRound(v2, read64(p+8));
+      v3 = xxhRound(v3, read64(p+16));
+      v4 = xxhRound(v4, read64(p+24));
+    }
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = xxhMergeRound(h, v1); h = xxhMergeRound(h, v2);
+    h = xxhMergeRound(h, v3); h = xxhMergeRound(h, v4);
+  } else {
+    h = seed + prime5;
+  }
+
+  h += uint64_t(len);
+
+  for (; (p+8) <= end; p += 8) {
+    h ^= xxhRound(0, read64(p));
+    h = rotl(h, 27) * prime1 + prime4;
+  }
+  if ((p+4) <= end) {
+    h ^= uint64_t(read32(p)) * prime1;
+    h = rotl(h, 23) * prime2 + prime3;
+    p += 4;
+  }
+  for (; p < end; p++) {
+    h ^= uint64_t(uint8_t(*p)) * prime5;
+    h = rotl(h, 11) * prime1;
+  }
+
+  h ^= h >> 33; h *= prime2;
+  h ^= h >> 29; h *= prime3;
+  h ^= h >> 32;
+  return h;
+}
@@ -0,0 +1,44 @@
+#ifndef PAGESTORE_HH
+#define PAGESTORE_HH
+
+#include <QByteArray>
+#include <QHash>
+#include <cstdint>
+
+
+/** Pool of codeplug memory pages shared between images.
+ *
+ * Captures of the same radio usually differ in a handful of bytes only. The content of elements is
+ * stored in pages of @c Element::PageSize bytes, which are implicitly shared byte arrays. Interning
+ * the pages of an image replaces every page by an identical page already held by the store. Hence
+ * identical pages of all images refer to the same memory and the memory consumption scales with
+ * the number of distinct pages. Modifying a shared page detaches it (copy on write).
+ *
+ * Pages are identified by their content hash (see @c hash), ties are resolved by comparing the
+ * content. The store is not thread-safe, it must be accessed from a single thread.
+ *
+ * @ingroup codeplug */
+class PageStore
+{
+public:
+  /** Constructs an empty store. */
+  PageStore();
+
+  /** Replaces the given page by an identical one held by the store. If there is none, the page is
+   * added to the store. @c hash must be the content hash of the page. */
+  void intern(QByteArray &page, uint64_t hash);
+  /** Drops all pages not referenced by any image anymore. */
+  void purge();
+
+  /** Returns the number of distinct pages held. */
+  qsizetype count() const;
+
+  /** Computes the 64bit content hash (XXH64) of the given data. */
+  static uint64_t hash(const char *data, qsizetype len, uint64_t seed=0);
+
+protected:
+  /** The pages held, indexed by their content hash. */
+  QMultiHash<uint64_t, QByteArray> _pages;
+};
+
+#endif // PAGESTORE_HH
@@ -1498,7 +1498,7 @@ UnknownFieldPattern::value(const Element *element, const Address& address, Field
     return {};
 
   Offset within = address - element->address();
-  return element->data().mid(within.byte(), size().byte());
+  return element->read(within.byte(), size().byte());
 }
 
 
@@ -1577,7 +1577,7 @@ UnusedFieldPattern::value(const Element *element, const Address& address, FieldA
   Q_UNUSED(annotation);
 
   Offset within = address - element->address();
-  return element->data().mid(within.byte(), size().byte());
+  return element->read(within.byte(), size().byte());
 }
 
 
@@ -1843,7 +1843,7 @@ IntegerFieldPattern::decode_unsigned(const Element *element,
     }
     unsigned int shift = (address.bit()+1)-size().bits();
     unsigned int mask  = (1<<size().bits())-1;
-    return  (static_cast<uint8_t>(element->data().at(within.byte())) >> shift) & mask;
+    return  (static_cast<uint8_t>(element->at(within.byte())) >> shift) & mask;
   }
 
   // All other sizes must align with byte boundaries. Otherwise, little/bit endian makes no sense
@@ -1857,7 +1857,8 @@ IntegerFieldPattern::decode_unsigned(const Element *element,
     return std::numeric_limits<long long>::max();
   }
 
-  const char *ptr = element->data().mid(within.byte(),size().byte()).constData();
+  QByteArray bytes = element->read(within.byte(), size().byte());
+  const char *ptr = bytes.constData();
   long long  value = 0;
   for (unsigned int i=0; i<size().byte(); i++) {
     if (Endian::Little == endian()) {
@@ -1887,7 +1888,8 @@ IntegerFieldPattern::decode_bcd(const Element *element,
   }
 
   Offset within = address - element->address();
-  const char *ptr = element->data().mid(within.byte(),size().byte()).constData();
+  QByteArray bytes = element->read(within.byte(), size().byte());
+  const char *ptr = bytes.constData();
   long long  value = 0, power = 1;
   for (unsigned int i=0; i<size().byte(); i++, power *= 100) {
     auto digits = static_cast<long long>(ptr[i]>>4)*10 + (ptr[i]&0xf);
@@ -2101,7 +2103,7 @@ EnumFieldPattern::decode(const Element *element, const Address &address, Annotat
   }
   unsigned int shift = (address.bit()+1)-size().bits();
   unsigned int mask  = (1<<size().bits())-1;
-  return (uint8_t(element->data().at(within.byte())) >> shift) & mask;
+  return (uint8_t(element->at(within.byte())) >> shift) & mask;
 }
 
 
@@ -2187,7 +2189,7 @@ StringFieldPattern::value(const Element *element, const Address &address, FieldA
   }
 
   Offset offset = address-element->address();
-  QByteArray mid = element->data().mid(offset.byte(), size().byte());
+  QByteArray mid = element->read(offset.byte(), size().byte());
 
   if (Format::ASCII == format()) {
     bool printable = true;
@@ -12,7 +12,7 @@
 PseudoTerminal::PseudoTerminal(const QString &symLink, QObject *parent)
   : QIODevice{parent}, _flags(O_NOCTTY|O_NONBLOCK), _dom(-1), _subPath(),
     _symLink(symLink),
-    _readNotifier(nullptr)
+    _readNotifier(nullptr), _writeNotifier(nullptr)
 {
   if (_symLink.startsWith("~")) {
     _symLink.replace("~", QDir::homePath());
@@ -48,6 +48,8 @@ PseudoTerminal::reopen()
     _readNotifier->setEnabled(false);
     delete _readNotifier;
     _readNotifier = nullptr;
+    delete _writeNotifier;
+    _writeNotifier = nullptr;
     ::close(_dom);
     _dom = -1;
   }
@@ -84,6 +86,10 @@ PseudoTerminal::reopen()
   connect(_readNotifier, &QSocketNotifier::activated, this, &PseudoTerminal::readyRead);
   _readNotifier->setEnabled(true);
 
+  _writeNotifier = new QSocketNotifier(_dom, QSocketNotifier::Write, this);
+  _writeNotifier->setEnabled(false);
+  connect(_writeNotifier, &QSocketNotifier::activated, this, &PseudoTerminal::onWritable);
+
   // Check if symlink is given:
   if (_symLink.isEmpty()) {
     logInfo() << "No symlink specified, use " << _subPath << " in wine config for COM port.";
@@ -138,6 +144,8 @@ PseudoTerminal::close() {
   _readNotifier->setEnabled(false);
   delete _readNotifier;
   _readNotifier = nullptr;
+  delete _writeNotifier;
+  _writeNotifier = nullptr;
 
   ::close(_dom);
   _dom = -1;
@@ -172,7 +180,12 @@ PseudoTerminal::writeData(const char *data, qint64 maxLen) {
   while (left) {
     int n = ::write(_dom, data, left);
 
-    if (n < 0) {
+    if ((n < 0) && (EAGAIN == errno)) {
+      // PTY is full, do not spin here (this would stall all other devices served by the same
+      // thread). Report what was written and signal bytesWritten once the PTY takes more data.
+      _writeNotifier->setEnabled(true);
+      return maxLen - left;
+    } else if (n < 0) {
       setErrorString(QString("Cannot write to pyt: %1.").arg(strerror(errno)));
       return -1;
     }
@@ -183,3 +196,9 @@ PseudoTerminal::writeData(const char *data, qint64 maxLen) {
 
   return maxLen;
 }
+
+void
+PseudoTerminal::onWritable() {
+  _writeNotifier->setEnabled(false);
+  emit bytesWritten(0);
+}
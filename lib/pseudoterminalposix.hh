@@ -37,6 +37,10 @@ protected:
   /** Internal function to reopen the PTY. */
   bool reopen();
 
+protected slots:
+  /** Internal callback, once the PTY can take more data. */
+  void onWritable();
+
 protected:
   /** Internal flags. */
   int _flags;
@@ -48,6 +52,8 @@ protected:
   QString _symLink;
   /** Notifier for read operations. */
   QSocketNotifier *_readNotifier;
+  /** Notifier for write operations, only enabled while the PTY is full. */
+  QSocketNotifier *_writeNotifier;
 };
 
 #endif // PSEUDOTERMINALPOSIX_HH
@@ -0,0 +1,62 @@
+#include "responsecache.hh"
+#include "modelrom.hh"
+
+
+/* ********************************************************************************************* *
+ * Implementation of ResponseCache
+ * ********************************************************************************************* */
+ResponseCache::ResponseCache(qsizetype capacity)
+  : _capacity(capacity), _size(0), _generation(0), _entries(), _hits(0), _misses(0)
+{
+  // pass...
+}
+
+
+const QByteArray *
+ResponseCache::find(const ModelRom &rom, uint32_t address, uint16_t length) {
+  validate(rom);
+
+  auto entry = _entries.constFind(key(address, length));
+  if (_entries.constEnd() == entry) {
+    _misses++;
+    return nullptr;
+  }
+
+  _hits++;
+  return &(*entry);
+}
+
+void
+ResponseCache::insert(const ModelRom &rom, uint32_t address, uint16_t length,
+                      const QByteArray &response)
+{
+  validate(rom);
+
+  // Responses are usually small and the set of distinct reads is limited. If the CPS reads
+  // everything, just start over.
+  if ((_size + response.size()) > _capacity)
+    clear();
+  if (response.size() > _capacity)
+    return;
+
+  QByteArray &entry = _entries[key(address, length)];
+  _size += response.size() - entry.size();
+  entry = response;
+  // Detach from any (transmit) buffer the response was taken from.
+  entry.detach();
+}
+
+void
+ResponseCache::clear() {
+  _entries.clear();
+  _size = 0;
+}
+
+
+void
+ResponseCache::validate(const ModelRom &rom) {
+  if (_generation == rom.generation())
+    return;
+  clear();
+  _generation = rom.generation();
+}
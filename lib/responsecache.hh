@@ -0,0 +1,64 @@
+#ifndef RESPONSECACHE_HH
+#define RESPONSECACHE_HH
+
+#include <QByteArray>
+#include <QHash>
+#include <cstdint>
+
+class ModelRom;
+
+
+/** Caches fully framed responses to read requests served from the ROM of a device.
+ *
+ * The CPS usually reads the same identification regions of the ROM several times. The cache keeps
+ * the serialized response (including header and checksum) keyed by address and length. Hence, a
+ * repeated read just appends the cached bytes to the transmit buffer. The cache is bound to the
+ * content stamp of the ROM and gets cleared automatically once the ROM is written.
+ *
+ * The cache is not thread-safe, it must be accessed from the thread of the device only.
+ *
+ * @ingroup device */
+class ResponseCache
+{
+public:
+  /** Constructs an empty cache holding at most @c capacity bytes of responses. */
+  explicit ResponseCache(qsizetype capacity = 0x10000);
+
+  /** Returns the cached response for the given read request or @c nullptr if there is none.
+   * Drops all entries, if the ROM has been modified since they were cached. */
+  const QByteArray *find(const ModelRom &rom, uint32_t address, uint16_t length);
+  /** Caches the given framed response to a read request from the given ROM. */
+  void insert(const ModelRom &rom, uint32_t address, uint16_t length, const QByteArray &response);
+  /** Drops all entries. */
+  void clear();
+
+  /** Returns the number of cache hits. */
+  inline uint64_t hits() const { return _hits; }
+  /** Returns the number of cache misses. */
+  inline uint64_t misses() const { return _misses; }
+
+protected:
+  /** Drops all entries if the ROM has been modified. */
+  void validate(const ModelRom &rom);
+
+  /** Builds the key for the given request. */
+  static inline uint64_t key(uint32_t address, uint16_t length) {
+    return (uint64_t(address) << 16) | length;
+  }
+
+protected:
+  /** The maximum number of bytes cached. */
+  qsizetype _capacity;
+  /** The number of bytes cached. */
+  qsizetype _size;
+  /** The ROM content stamp the entries belong to. */
+  uint64_t _generation;
+  /** The cached responses. */
+  QHash<uint64_t, QByteArray> _entries;
+  /** Cache hits. */
+  uint64_t _hits;
+  /** Cache misses. */
+  uint64_t _misses;
+};
+
+#endif // RESPONSECACHE_HH
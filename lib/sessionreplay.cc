@@ -0,0 +1,198 @@
+#include "sessionreplay.hh"
+#include "devicestatistics.hh"
+#include "logger.hh"
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+
+
+/* ********************************************************************************************* *
+ * Implementation of ReplayInterface
+ * ********************************************************************************************* */
+ReplayInterface::ReplayInterface(QObject *parent)
+  : QIODevice{parent}, _rx(), _rxPos(0), _tx()
+{
+  // pass...
+}
+
+bool
+ReplayInterface::isSequential() const {
+  return true;
+}
+
+qint64
+ReplayInterface::bytesAvailable() const {
+  return (_rx.size() - _rxPos) + QIODevice::bytesAvailable();
+}
+
+void
+ReplayInterface::feed(const QByteArray &data) {
+  if (_rxPos == _rx.size()) {
+    _rx.resize(0);
+    _rxPos = 0;
+  }
+  _rx.append(data);
+  emit readyRead();
+}
+
+QByteArray
+ReplayInterface::take() {
+  QByteArray data;
+  data.swap(_tx);
+  return data;
+}
+
+qint64
+ReplayInterface::readData(char *data, qint64 maxSize) {
+  qint64 n = std::min(qint64(_rx.size() - _rxPos), maxSize);
+  std::memcpy(data, _rx.constData() + _rxPos, n);
+  _rxPos += n;
+  return n;
+}
+
+qint64
+ReplayInterface::writeData(const char *data, qint64 maxSize) {
+  _tx.append(data, maxSize);
+  return maxSize;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of SessionReplay
+ * ********************************************************************************************* */
+SessionReplay::SessionReplay(const SessionTrace &trace, QObject *parent)
+  : QObject{parent}, _trace(trace), _interface(), _expected(), _received(),
+    _elapsed(0), _fed(0), _compared(0)
+{
+  // pass...
+}
+
+QIODevice *
+SessionReplay::interface() {
+  if (nullptr == _interface)
+    _interface = new ReplayInterface();
+  return _interface;
+}
+
+bool
+SessionReplay::run(bool realtime, const ErrorStack &err) {
+  if (nullptr == _interface) {
+    errMsg(err) << "No device attached to replay.";
+    return false;
+  }
+  if (! _interface->isOpen()) {
+    errMsg(err) << "Replay interface not opened by device.";
+    return false;
+  }
+
+  _expected.clear(); _received.clear();
+  _fed = _compared = 0;
+  qint64 start = DeviceStatistics::now();
+
+  for (const auto &record: _trace) {
+    if (realtime) {
+      qint64 delay = (start + record.timestamp*1000 - DeviceStatistics::now())/1000000;
+      if (delay > 0) {
+        // Keep the event loop running, devices may depend on timers.
+        QEventLoop loop;
+        QTimer::singleShot(delay, &loop, &QEventLoop::quit);
+        loop.exec();
+      }
+    }
+
+    if (nullptr == _interface) {
+      errMsg(err) << "Replay interface deleted during replay.";
+      return false;
+    }
+
+    if (SessionTrace::Direction::Request == record.direction) {
+      // Device handles the request immediately and writes the response into the interface.
+      _interface->feed(record.data);
+      _fed += record.data.size();
+    } else {
+      _expected.append(record.data);
+    }
+
+    if (! compare(err))
+      return false;
+  }
+
+  QCoreApplication::processEvents();
+  if (! compare(err))
+    return false;
+
+  _elapsed = DeviceStatistics::now() - start;
+
+  settle();
+  if (! compare(err))
+    return false;
+
+  if (_expected.size() || _received.size()) {
+    errMsg(err) << "Response length mismatch at offset " << _compared << ": Expected "
+                << _expected.size() << " more bytes, got " << _received.size() << ".";
+    return false;
+  }
+
+  return true;
+}
+
+bool
+SessionReplay::compare(const ErrorStack &err) {
+  if (_interface)
+    _received.append(_interface->take());
+
+  qsizetype n = std::min(_expected.size(), _received.size());
+  if (0 == n)
+    return true;
+
+  auto mismatch = std::mismatch(_expected.constBegin(), _expected.constBegin()+n,
+                                _received.constBegin());
+  if (mismatch.first != (_expected.constBegin()+n)) {
+    qsizetype offset = mismatch.first - _expected.constBegin();
+    errMsg(err) << "Response mismatch at offset " << (_compared + offset) << ": Expected "
+                << _expected.mid(offset, 16).toHex(' ') << ", got "
+                << _received.mid(offset, 16).toHex(' ') << ".";
+    return false;
+  }
+
+  _expected.remove(0, n);
+  _received.remove(0, n);
+  _compared += n;
+  return true;
+}
+
+void
+SessionReplay::settle() {
+  qint64 deadline = DeviceStatistics::now() + qint64(SettleTimeout)*1000000;
+  while (_interface && _interface->parent()) {
+    // Longest remaining time of the pending single-shot timers of the device
+    int remaining = -1;
+    for (QTimer *timer: _interface->parent()->findChildren<QTimer *>()) {
+      if (timer->isActive() && timer->isSingleShot())
+        remaining = std::max(remaining, timer->remainingTime());
+    }
+    qint64 left = (deadline - DeviceStatistics::now())/1000000;
+    if ((remaining < 0) || (left <= 0))
+      return;
+    QEventLoop loop;
+    QTimer::singleShot(std::min(qint64(remaining)+1, left), &loop, &QEventLoop::quit);
+    loop.exec();
+  }
+}
+
+qint64
+SessionReplay::elapsed() const {
+  return _elapsed;
+}
+
+qint64
+SessionReplay::bytesFed() const {
+  return _fed;
+}
+
+qint64
+SessionReplay::bytesCompared() const {
+  return _compared;
+}
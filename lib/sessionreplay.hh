@@ -0,0 +1,113 @@
+#ifndef SESSIONREPLAY_HH
+#define SESSIONREPLAY_HH
+
+#include <QIODevice>
+#include <QPointer>
+#include "sessiontrace.hh"
+
+
+/** An in-memory interface to feed a device with recorded requests.
+ * @ingroup interface */
+class ReplayInterface: public QIODevice
+{
+  Q_OBJECT
+
+public:
+  /** Constructs an empty interface. */
+  explicit ReplayInterface(QObject *parent = nullptr);
+
+  /** Returns @c true. */
+  bool isSequential() const override;
+  /** Returns the number of bytes fed but not read yet. */
+  qint64 bytesAvailable() const override;
+
+  /** Makes the given data available for reading and signals @c readyRead. */
+  void feed(const QByteArray &data);
+  /** Returns and clears everything written by the device so far. */
+  QByteArray take();
+
+protected:
+  qint64 readData(char *data, qint64 maxSize) override;
+  qint64 writeData(const char *data, qint64 maxSize) override;
+
+protected:
+  /** The data fed. */
+  QByteArray _rx;
+  /** Read position within @c _rx. */
+  qsizetype _rxPos;
+  /** The data written by the device. */
+  QByteArray _tx;
+};
+
+
+/** Replays a recorded session against a device.
+ *
+ * The requests of the trace are fed into the device through a @c ReplayInterface, either as
+ * fast as possible or with the original timing. The responses of the device are compared byte by
+ * byte against the recorded ones.
+ *
+ * Devices may finish a programming from a timer, e.g., a time-out after the last request. Hence,
+ * once the trace is fed, the event loop keeps running until the pending single-shot timers owned
+ * by the device fired (at most @c SettleTimeout ms). Timers not owned by the device are not
+ * waited for, use the original timing for these.
+ *
+ * Usage:
+ * @code
+ * SessionReplay replay(trace);
+ * Device *device = firmware->createDevice(replay.interface());
+ * if (! replay.run(false, err)) ...
+ * @endcode
+ *
+ * @ingroup device */
+class SessionReplay: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Maximum time in ms to wait for the timers of the device, once the trace is fed. */
+  static constexpr int SettleTimeout = 10000;
+
+public:
+  /** Constructs a replay for the given trace. */
+  explicit SessionReplay(const SessionTrace &trace, QObject *parent = nullptr);
+
+  /** Returns the interface to pass to the device. The ownership is transferred to the caller
+   * (usually the device). */
+  QIODevice *interface();
+
+  /** Runs the replay. If @c realtime is set, the original timing is reproduced. Returns @c false
+   * if the responses of the device differ from the recorded ones. */
+  bool run(bool realtime = false, const ErrorStack &err=ErrorStack());
+
+  /** Returns the duration of the last run in nanoseconds, excluding the time waited for the
+   * timers of the device. */
+  qint64 elapsed() const;
+  /** Returns the number of request bytes fed during the last run. */
+  qint64 bytesFed() const;
+  /** Returns the number of response bytes compared during the last run. */
+  qint64 bytesCompared() const;
+
+protected:
+  /** Compares the responses received so far against the expected ones. */
+  bool compare(const ErrorStack &err);
+  /** Keeps the event loop running until the pending single-shot timers of the device fired. */
+  void settle();
+
+protected:
+  /** The trace to replay. */
+  const SessionTrace &_trace;
+  /** The interface, owned by the device. */
+  QPointer<ReplayInterface> _interface;
+  /** Expected response bytes not compared yet. */
+  QByteArray _expected;
+  /** Received response bytes not compared yet. */
+  QByteArray _received;
+  /** Duration of the last run. */
+  qint64 _elapsed;
+  /** Bytes fed. */
+  qint64 _fed;
+  /** Bytes compared. */
+  qint64 _compared;
+};
+
+#endif // SESSIONREPLAY_HH
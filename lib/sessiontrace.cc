@@ -0,0 +1,237 @@
+#include "sessiontrace.hh"
+#include "devicestatistics.hh"
+#include "logger.hh"
+#include <QFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+
+static const char   TraceMagic[8] = {'A','E','T','R','A','C','E','\0'};
+static const quint16 TraceVersion = 1;
+
+
+/* ********************************************************************************************* *
+ * Implementation of SessionTrace
+ * ********************************************************************************************* */
+SessionTrace::SessionTrace(const QString &model, const QString &firmware)
+  : _model(model), _firmware(firmware), _records()
+{
+  // pass...
+}
+
+const QString &
+SessionTrace::model() const {
+  return _model;
+}
+
+const QString &
+SessionTrace::firmware() const {
+  return _firmware;
+}
+
+qsizetype
+SessionTrace::count() const {
+  return _records.size();
+}
+
+const SessionTrace::Record &
+SessionTrace::record(qsizetype i) const {
+  return _records.at(i);
+}
+
+void
+SessionTrace::append(Direction direction, qint64 timestamp, const QByteArray &data) {
+  _records.append({direction, timestamp, data});
+}
+
+SessionTrace::const_iterator
+SessionTrace::begin() const {
+  return _records.begin();
+}
+
+SessionTrace::const_iterator
+SessionTrace::end() const {
+  return _records.end();
+}
+
+
+static bool
+readString(QIODevice *device, QString &str) {
+  quint16 len;
+  if (sizeof(len) != device->read((char *)&len, sizeof(len)))
+    return false;
+  len = qFromLittleEndian(len);
+  QByteArray data = device->read(len);
+  if (len != data.size())
+    return false;
+  str = QString::fromUtf8(data);
+  return true;
+}
+
+static bool
+writeString(QIODevice *device, const QString &str) {
+  QByteArray data = str.toUtf8();
+  quint16 len = qToLittleEndian(quint16(data.size()));
+  return (sizeof(len) == device->write((const char *)&len, sizeof(len)))
+      && (data.size() == device->write(data));
+}
+
+
+bool
+SessionTrace::read(QIODevice *device, const ErrorStack &err) {
+  char magic[sizeof(TraceMagic)];
+  if ((sizeof(magic) != device->read(magic, sizeof(magic)))
+      || (0 != memcmp(magic, TraceMagic, sizeof(magic)))) {
+    errMsg(err) << "Not a session trace.";
+    return false;
+  }
+
+  quint16 version;
+  if (sizeof(version) != device->read((char *)&version, sizeof(version))) {
+    errMsg(err) << "Cannot read trace version.";
+    return false;
+  }
+  if (TraceVersion != qFromLittleEndian(version)) {
+    errMsg(err) << "Unsupported trace version " << qFromLittleEndian(version) << ".";
+    return false;
+  }
+
+  if ((! readString(device, _model)) || (! readString(device, _firmware))) {
+    errMsg(err) << "Cannot read trace header.";
+    return false;
+  }
+
+  _records.clear();
+  qint64 timestamp = 0;
+  while (! device->atEnd()) {
+    uchar header[9];
+    if (sizeof(header) != device->read((char *)header, sizeof(header))) {
+      errMsg(err) << "Truncated record header in trace.";
+      return false;
+    }
+    if (header[0] > uchar(Direction::Response)) {
+      errMsg(err) << "Invalid record direction " << header[0] << " in trace.";
+      return false;
+    }
+    timestamp += qFromLittleEndian<quint32>(header+1);
+    quint32 len = qFromLittleEndian<quint32>(header+5);
+    QByteArray data = device->read(len);
+    if (len != data.size()) {
+      errMsg(err) << "Truncated record in trace.";
+      return false;
+    }
+    append(Direction(header[0]), timestamp, data);
+  }
+
+  return true;
+}
+
+bool
+SessionTrace::load(const QString &filename, const ErrorStack &err) {
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errMsg(err) << "Cannot open trace '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+  if (! read(&file, err)) {
+    errMsg(err) << "Cannot read trace '" << filename << "'.";
+    return false;
+  }
+  return true;
+}
+
+
+bool
+SessionTrace::writeHeader(QIODevice *device, const QString &model, const QString &firmware) {
+  quint16 version = qToLittleEndian(TraceVersion);
+  return (sizeof(TraceMagic) == device->write(TraceMagic, sizeof(TraceMagic)))
+      && (sizeof(version) == device->write((const char *)&version, sizeof(version)))
+      && writeString(device, model) && writeString(device, firmware);
+}
+
+bool
+SessionTrace::writeRecord(QIODevice *device, Direction direction, quint32 delta,
+                          const char *data, qsizetype len)
+{
+  uchar header[9];
+  header[0] = uchar(direction);
+  qToLittleEndian<quint32>(delta, header+1);
+  qToLittleEndian<quint32>(len, header+5);
+  return (sizeof(header) == device->write((const char *)header, sizeof(header)))
+      && (len == device->write(data, len));
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of SessionRecorder
+ * ********************************************************************************************* */
+SessionRecorder::SessionRecorder(QIODevice *interface, QIODevice *trace, const QString &model,
+                                 const QString &firmware, QObject *parent)
+  : QIODevice{parent}, _interface(interface), _trace(trace), _last(DeviceStatistics::now()/1000)
+{
+  _interface->setParent(this);
+  _trace->setParent(this);
+  connect(_interface, &QIODevice::readyRead, this, &QIODevice::readyRead);
+  connect(_interface, &QIODevice::bytesWritten, this, &QIODevice::bytesWritten);
+
+  if (! SessionTrace::writeHeader(_trace, model, firmware))
+    logError() << "Cannot write trace header: " << _trace->errorString();
+}
+
+bool
+SessionRecorder::isSequential() const {
+  return true;
+}
+
+bool
+SessionRecorder::open(OpenMode mode) {
+  if (! _interface->open(mode)) {
+    setErrorString(_interface->errorString());
+    return false;
+  }
+  // Unbuffered, every read and write must pass through to get recorded immediately.
+  return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void
+SessionRecorder::close() {
+  _interface->close();
+  if (auto file = qobject_cast<QFileDevice *>(_trace))
+    file->flush();
+  QIODevice::close();
+}
+
+qint64
+SessionRecorder::bytesAvailable() const {
+  return _interface->bytesAvailable() + QIODevice::bytesAvailable();
+}
+
+qint64
+SessionRecorder::readData(char *data, qint64 maxSize) {
+  qint64 n = _interface->read(data, maxSize);
+  if (n > 0)
+    record(SessionTrace::Direction::Request, data, n);
+  else if (n < 0)
+    setErrorString(_interface->errorString());
+  return n;
+}
+
+qint64
+SessionRecorder::writeData(const char *data, qint64 maxSize) {
+  qint64 n = _interface->write(data, maxSize);
+  if (n > 0)
+    record(SessionTrace::Direction::Response, data, n);
+  else if (n < 0)
+    setErrorString(_interface->errorString());
+  return n;
+}
+
+void
+SessionRecorder::record(SessionTrace::Direction direction, const char *data, qint64 len) {
+  qint64 now = DeviceStatistics::now()/1000;
+  quint32 delta = quint32(std::min(now - _last, qint64(0xffffffff)));
+  _last = now;
+  if (! SessionTrace::writeRecord(_trace, direction, delta, data, len))
+    logError() << "Cannot write trace record: " << _trace->errorString();
+}
@@ -0,0 +1,122 @@
+#ifndef SESSIONTRACE_HH
+#define SESSIONTRACE_HH
+
+#include <QIODevice>
+#include <QVector>
+#include "errorstack.hh"
+
+
+/** A recorded session between a CPS and an emulated device.
+ *
+ * A trace consists of a header, naming the emulated model and firmware, followed by a sequence of
+ * records. Each record holds the bytes exchanged in one direction, together with the time since
+ * the start of the session. Within the binary trace file, all integers are stored in little
+ * endian:
+ * @code
+ * header: "AETRACE" 0x00 | version (u16) | model length (u16) | model | firmware length (u16) | firmware
+ * record: direction (u8) | time since previous record in us (u32) | length (u32) | data
+ * @endcode
+ *
+ * @ingroup device */
+class SessionTrace
+{
+public:
+  /** The direction of a record. */
+  enum class Direction {
+    Request = 0,  ///< Bytes sent by the CPS to the device.
+    Response = 1  ///< Bytes sent by the device to the CPS.
+  };
+
+  /** A single record of a trace. */
+  struct Record {
+    /** The direction of the data. */
+    Direction direction;
+    /** Time since the start of the session in microseconds. */
+    qint64 timestamp;
+    /** The data exchanged. */
+    QByteArray data;
+  };
+
+  typedef QVector<Record>::const_iterator const_iterator;
+
+public:
+  /** Constructs an empty trace. */
+  SessionTrace(const QString &model = QString(), const QString &firmware = QString());
+
+  /** Returns the model ID. */
+  const QString &model() const;
+  /** Returns the firmware name. */
+  const QString &firmware() const;
+
+  /** Returns the number of records. */
+  qsizetype count() const;
+  /** Returns the i-th record. */
+  const Record &record(qsizetype i) const;
+  /** Appends a record. */
+  void append(Direction direction, qint64 timestamp, const QByteArray &data);
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /** Reads a trace from the given device. */
+  bool read(QIODevice *device, const ErrorStack &err=ErrorStack());
+  /** Reads a trace from the given file. */
+  bool load(const QString &filename, const ErrorStack &err=ErrorStack());
+
+  /** Writes the header of a trace. */
+  static bool writeHeader(QIODevice *device, const QString &model, const QString &firmware);
+  /** Writes a single record. */
+  static bool writeRecord(QIODevice *device, Direction direction, quint32 delta,
+                          const char *data, qsizetype len);
+
+protected:
+  /** The model ID. */
+  QString _model;
+  /** The firmware name. */
+  QString _firmware;
+  /** The records. */
+  QVector<Record> _records;
+};
+
+
+/** Records a session into a trace file.
+ *
+ * This device wraps the actual interface to the CPS and forwards all reads and writes while
+ * recording them into the trace.
+ *
+ * @ingroup interface */
+class SessionRecorder: public QIODevice
+{
+  Q_OBJECT
+
+public:
+  /** Wraps the given interface and records into the given trace device. Takes ownership of both
+   * devices. The trace device must be opened already. */
+  SessionRecorder(QIODevice *interface, QIODevice *trace, const QString &model,
+                  const QString &firmware, QObject *parent = nullptr);
+
+  /** Returns @c true. */
+  bool isSequential() const override;
+  /** Opens the wrapped interface. */
+  bool open(OpenMode mode) override;
+  /** Closes the wrapped interface and flushes the trace. */
+  void close() override;
+  /** Returns the bytes available from the wrapped interface. */
+  qint64 bytesAvailable() const override;
+
+protected:
+  qint64 readData(char *data, qint64 maxSize) override;
+  qint64 writeData(const char *data, qint64 maxSize) override;
+  /** Appends a record to the trace. */
+  void record(SessionTrace::Direction direction, const char *data, qint64 len);
+
+protected:
+  /** The wrapped interface. */
+  QIODevice *_interface;
+  /** The trace file. */
+  QIODevice *_trace;
+  /** Timestamp of the last record in microseconds. */
+  qint64 _last;
+};
+
+#endif // SESSIONTRACE_HH
@@ -0,0 +1,87 @@
+#include "spillfile.hh"
+#include "image.hh"
+#include "logger.hh"
+
+
+/** Reads the content of an element back from the spill file. */
+class SpillSource: public ElementSource
+{
+public:
+  /** Constructs a source for the given region of the spill file. */
+  SpillSource(const QSharedPointer<QTemporaryFile> &file, qint64 offset, qint64 length)
+    : ElementSource(), _file(file), _offset(offset), _length(length)
+  {
+    // pass...
+  }
+
+  QByteArray read() const override {
+    if (0 == _length)
+      return QByteArray();
+    // Map the region only while reading, the content is copied into the pages of the element.
+    uchar *ptr = _file->map(_offset, _length);
+    if (nullptr == ptr) {
+      logError() << "Cannot map spill file '" << _file->fileName() << "': "
+                 << _file->errorString() << ".";
+      return QByteArray();
+    }
+    QByteArray content((const char *)ptr, _length);
+    _file->unmap(ptr);
+    return content;
+  }
+
+protected:
+  /** The spill file. */
+  QSharedPointer<QTemporaryFile> _file;
+  /** Offset of the content within the file. */
+  qint64 _offset;
+  /** Length of the content. */
+  qint64 _length;
+};
+
+
+/* ********************************************************************************************* *
+ * Implementation of SpillFile
+ * ********************************************************************************************* */
+SpillFile::SpillFile()
+  : _file()
+{
+  // pass...
+}
+
+ElementSource *
+SpillFile::write(const Element *element) {
+  if (_file.isNull()) {
+    _file.reset(new QTemporaryFile());
+    if (! _file->open()) {
+      logError() << "Cannot create spill file: " << _file->errorString() << ".";
+      _file.reset();
+      return nullptr;
+    }
+    logDebug() << "Spill evicted images into '" << _file->fileName() << "'.";
+  }
+
+  qint64 offset = _file->size();
+  if (! _file->seek(offset)) {
+    logError() << "Cannot write spill file: " << _file->errorString() << ".";
+    return nullptr;
+  }
+  for (unsigned int i=0; i<element->pageCount(); i++) {
+    QByteArrayView page = element->page(i);
+    if (page.size() != _file->write(page.data(), page.size())) {
+      logError() << "Cannot write spill file: " << _file->errorString() << ".";
+      // Drop the partial write
+      _file->resize(offset);
+      return nullptr;
+    }
+  }
+  _file->flush();
+
+  return new SpillSource(_file, offset, element->size().byte());
+}
+
+qint64
+SpillFile::size() const {
+  if (_file.isNull())
+    return 0;
+  return _file->size();
+}
@@ -0,0 +1,37 @@
+#ifndef SPILLFILE_HH
+#define SPILLFILE_HH
+
+#include <QSharedPointer>
+#include <QTemporaryFile>
+
+class Element;
+class ElementSource;
+
+
+/** An append-only temporary file holding the content of evicted elements.
+ *
+ * The content of an element is written to the end of the file. The returned @c ElementSource
+ * maps the written region to read it back, once the element is accessed again. The file is
+ * created on the first write and removed, once the spill file and all sources are destroyed.
+ * Space is not reclaimed, hence the file grows with every element spilled.
+ *
+ * @ingroup codeplug */
+class SpillFile
+{
+public:
+  /** Constructs a spill file. The file is created on the first write. */
+  SpillFile();
+
+  /** Appends the content of the element to the file. Returns a source to read it back or
+   * @c nullptr on error. */
+  ElementSource *write(const Element *element);
+
+  /** Returns the number of bytes written. */
+  qint64 size() const;
+
+protected:
+  /** The temporary file. */
+  QSharedPointer<QTemporaryFile> _file;
+};
+
+#endif // SPILLFILE_HH
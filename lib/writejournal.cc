@@ -0,0 +1,99 @@
+#include "writejournal.hh"
+#include "image.hh"
+#include <algorithm>
+#include <cstring>
+
+
+/* ********************************************************************************************* *
+ * Implementation of WriteJournal
+ * ********************************************************************************************* */
+WriteJournal::WriteJournal()
+  : _entries(), _data()
+{
+  // pass...
+}
+
+
+bool
+WriteJournal::isEmpty() const {
+  return _entries.isEmpty();
+}
+
+qsizetype
+WriteJournal::count() const {
+  return _entries.size();
+}
+
+const WriteJournal::Entry &
+WriteJournal::entry(qsizetype i) const {
+  return _entries.at(i);
+}
+
+QByteArrayView
+WriteJournal::payload(const Entry &entry) const {
+  return QByteArrayView(_data.constData() + entry.offset, entry.length);
+}
+
+
+void
+WriteJournal::record(uint32_t address, const QByteArray &data) {
+  _entries.append({address, uint32_t(data.size()), _data.size(), uint32_t(_entries.size())});
+  _data.append(data);
+}
+
+void
+WriteJournal::clear() {
+  _entries.clear();
+  _data.clear();
+}
+
+
+void
+WriteJournal::apply(Image *image) const {
+  if (_entries.isEmpty())
+    return;
+
+  // Sort by address, keep the order of writes to the same address.
+  QVector<Entry> sorted(_entries);
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Entry &a, const Entry &b) {
+    return a.address < b.address;
+  });
+
+  auto runStart = sorted.begin();
+  while (sorted.end() != runStart) {
+    // Find the run of overlapping or adjacent writes
+    uint32_t start = runStart->address;
+    uint64_t end = uint64_t(start) + runStart->length;
+    auto runEnd = runStart+1;
+    for (; (sorted.end() != runEnd) && (runEnd->address <= end); runEnd++)
+      end = std::max(end, uint64_t(runEnd->address) + runEnd->length);
+
+    // Assemble run content, in the order the writes were received
+    QByteArray content;
+    if ((runEnd - runStart) == 1) {
+      content = payload(*runStart).toByteArray();
+    } else {
+      std::sort(runStart, runEnd, [](const Entry &a, const Entry &b) {
+        return a.sequence < b.sequence;
+      });
+      content = QByteArray(end - start, '\0');
+      for (auto e=runStart; e!=runEnd; e++)
+        memcpy(content.data() + (e->address - start), _data.constData() + e->offset, e->length);
+    }
+
+    if (! content.isEmpty())
+      image->append(start, content);
+    runStart = runEnd;
+  }
+}
+
+
+WriteJournal::const_iterator
+WriteJournal::begin() const {
+  return _entries.begin();
+}
+
+WriteJournal::const_iterator
+WriteJournal::end() const {
+  return _entries.end();
+}
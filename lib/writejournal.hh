@@ -0,0 +1,68 @@
+#ifndef WRITEJOURNAL_HH
+#define WRITEJOURNAL_HH
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+
+class Image;
+
+
+/** An append-only journal of the writes received during a programming session.
+ *
+ * Recording a write just appends the payload to a single buffer and adds an entry referring to
+ * it. Hence, no per-frame bookkeeping takes place while the CPS is writing. Once the session
+ * ended, the journal is merged into an @c Image in one pass. In contrast to the image, the journal
+ * retains the order of the writes as well as repeated writes to the same address.
+ *
+ * @ingroup codeplug */
+class WriteJournal
+{
+public:
+  /** A single write. */
+  struct Entry {
+    /** The target address. */
+    uint32_t address;
+    /** The number of bytes written. */
+    uint32_t length;
+    /** Offset of the payload within the journal buffer. */
+    qsizetype offset;
+    /** Sequence number of the write within the session. */
+    uint32_t sequence;
+  };
+
+  typedef QVector<Entry>::const_iterator const_iterator;
+
+public:
+  /** Constructs an empty journal. */
+  WriteJournal();
+
+  /** Returns @c true if no writes were recorded. */
+  bool isEmpty() const;
+  /** Returns the number of writes recorded. */
+  qsizetype count() const;
+  /** Returns the i-th write. */
+  const Entry &entry(qsizetype i) const;
+  /** Returns the payload of the given write. */
+  QByteArrayView payload(const Entry &entry) const;
+
+  /** Records a write. */
+  void record(uint32_t address, const QByteArray &data);
+  /** Drops all writes. */
+  void clear();
+
+  /** Merges all writes into the given image. Overlapping and adjacent writes are coalesced into
+   * single elements, if the same bytes were written several times, the last write wins. */
+  void apply(Image *image) const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+protected:
+  /** The writes in the order received. */
+  QVector<Entry> _entries;
+  /** The payloads of all writes. */
+  QByteArray _data;
+};
+
+#endif // WRITEJOURNAL_HH
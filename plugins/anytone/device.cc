@@ -27,65 +27,98 @@ AnyToneDevice::AnyToneDevice(QIODevice *interface, CodeplugPattern *pattern, Ima
 
 void
 AnyToneDevice::onBytesAvailable() {
-  _in_buffer.append(_interface->readAll());
-
-  while (AnytoneRequest *req = AnytoneRequest::fromBuffer(_in_buffer)) {
-    AnytoneResponse *resp = this->handle(req);
-    delete req;
-    if (resp) {
-      if (resp->serialize(_out_buffer))
-        onBytesWritten();
-      delete resp;
+  _statistics.received(_in_buffer.readFrom(_interface));
+
+  AnytoneRequestFrame request;
+  int64_t start = DeviceStatistics::now();
+  while (_decoder.decode(_in_buffer, request)) {
+    if (this->respond(request, _out_buffer.buffer())) {
+      _statistics.buffered(_out_buffer.size());
+      onBytesWritten();
     }
+    int64_t end = DeviceStatistics::now();
+    _statistics.handled(AnytoneRequestFrame::typeName(request.type), end-start);
+    start = end;
   }
 }
 
 
 void
 AnyToneDevice::onBytesWritten() {
-  if (0 == _out_buffer.size())
-    return;
+  _statistics.sent(_out_buffer.writeTo(_interface));
+}
+
+
+bool
+AnyToneDevice::respond(const AnytoneRequestFrame &request, QByteArray &buffer) {
+  bool cacheable = (AnytoneRequestFrame::Type::Read == request.type) && (State::Program == _state);
+  if (cacheable) {
+    if (const QByteArray *response = _readCache.find(rom(), request.address, request.length)) {
+      buffer.append(*response);
+      return true;
+    }
+  }
 
-  qint64 nbytes = _interface->write(_out_buffer);
-  _out_buffer.remove(0, nbytes);
+  qsizetype start = buffer.size();
+  AnytoneResponseFrame response = this->handle(request);
+  if (! response.serialize(buffer))
+    return false;
+  if (cacheable && (AnytoneResponseFrame::Type::Read == response.type))
+    _readCache.insert(rom(), request.address, request.length, buffer.mid(start));
+  return true;
 }
 
 
-AnytoneResponse *
-AnyToneDevice::handle(AnytoneRequest *request) {
-  if (request->is<AnytoneProgramRequest>()) {
+AnytoneResponseFrame
+AnyToneDevice::handle(const AnytoneRequestFrame &request) {
+  typedef AnytoneRequestFrame::Type Type;
+
+  switch (request.type) {
+  case Type::Program:
     if (State::Initial == _state)
       emit startProgram();
     logDebug() << "Enter progam mode.";
     _state = State::Program;
-    return new AnytoneProgramResponse();
-  } else if ((State::Program == _state) && request->is<AnytoneDeviceInfoRequest>()) {
+    return AnytoneResponseFrame::program();
+
+  case Type::DeviceInfo:
+    if (State::Program != _state)
+      break;
     logDebug() << "Get device info.";
-    return new AnytoneDeviceInfoResponse(this->model(), this->band(), this->revision());
-  } else if ((State::Program == _state) && request->is<AnytoneReadRequest>()) {
-    AnytoneReadRequest *rreq = request->as<AnytoneReadRequest>();
-    logDebug() << "Read " << (int)rreq->length() << "b from " << Qt::hex << rreq->address() << "h.";
-    QByteArray payload; payload.reserve(rreq->length());
-    if (! this->read(rreq->address(), rreq->length(), payload)) {
+    return AnytoneResponseFrame::deviceInfo(this->model(), this->band(), this->revision());
+
+  case Type::Read: {
+    if (State::Program != _state)
+      break;
+    logDebug() << "Read " << (int)request.length << "b from " << Qt::hex << request.address << "h.";
+    QByteArray payload;
+    if (! this->read(request.address, request.length, payload)) {
       logError() << "Cannot read from emulated device.";
-      return nullptr;
+      return AnytoneResponseFrame();
     }
-    return new AnytoneReadResponse(rreq->address(), payload);
-  } else if ((State::Program == _state) && request->is<AnytoneWriteRequest>()) {
-    AnytoneWriteRequest *wreq = request->as<AnytoneWriteRequest>();
-    if (! this->write(wreq->address(), wreq->payload()))
-      return nullptr;
-    return new AnytoneWriteResponse(wreq->address(), wreq->payload().size());
-  } else if (request->is<AnytoneEndRequest>()) {
+    return AnytoneResponseFrame::read(request.address, payload);
+  }
+
+  case Type::Write:
+    if (State::Program != _state)
+      break;
+    if (! this->write(request.address, request.payload))
+      return AnytoneResponseFrame();
+    return AnytoneResponseFrame::write(request.address, request.payload.size());
+
+  case Type::End:
     if (State::Program == _state)
       emit endProgram();
     logDebug() << "Received END command -> done.";
     _state = State::Initial;
-    return new AnytoneACKResponse();
+    return AnytoneResponseFrame::ack();
+
+  case Type::Invalid:
+    break;
   }
 
   logWarn() << "Uknown request.";
-  return nullptr;
+  return AnytoneResponseFrame();
 }
 
 
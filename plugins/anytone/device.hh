@@ -2,9 +2,9 @@
 #define ANYTONEDEVICE_HH
 
 #include <device.hh>
-
-class AnytoneRequest;
-class AnytoneResponse;
+#include <framebuffer.hh>
+#include <responsecache.hh>
+#include "protocol.hh"
 
 /** Abstract base class for all emulated devices.
  * @ingroup device */
@@ -35,8 +35,13 @@ public:
   const QByteArray &revision() const;
 
 protected:
-  /** Handles a request and constructs an appropriate response. */
-  virtual AnytoneResponse *handle(AnytoneRequest *request);
+  /** Handles a request and constructs an appropriate response.
+   * If there is no response, the type of the returned frame is @c None. */
+  virtual AnytoneResponseFrame handle(const AnytoneRequestFrame &request);
+  /** Handles a request and serializes the response into the given buffer.
+   * Responses to read requests are served from the ROM response cache, if possible. This assumes
+   * that @c read is backed by the ROM. Returns @c false if there is no response. */
+  bool respond(const AnytoneRequestFrame &request, QByteArray &buffer);
 
 protected slots:
   /** Internal callback to handle incomming data. */
@@ -51,9 +56,13 @@ protected:
   QIODevice *_interface;
 
   /** Internal receive buffer. */
-  QByteArray _in_buffer;
+  FrameBuffer _in_buffer;
   /** Internal transmit buffer. */
-  QByteArray _out_buffer;
+  FrameBuffer _out_buffer;
+  /** Decodes the requests from the receive buffer. */
+  AnytoneRequestDecoder _decoder;
+  /** Caches the framed responses to read requests. */
+  ResponseCache _readCache;
 
   QByteArray _model;
   uint8_t _band;
@@ -1,13 +1,240 @@
 #include "protocol.hh"
 #include <QtEndian>
+#include <algorithm>
 #include "logger.hh"
+#include "framebuffer.hh"
+#include "checksum.hh"
 
 
-inline uint8_t crc8(const QByteArray &data) {
-  uint8_t crc = 0;
-  for (int i=0; i<data.length(); i++)
-    crc += data[i];
-  return crc;
+/* ********************************************************************************************* *
+ * AnytoneRequestFrame implementation
+ * ********************************************************************************************* */
+const char *
+AnytoneRequestFrame::typeName(Type type) {
+  switch (type) {
+  case Type::Invalid: return "Invalid";
+  case Type::Program: return "Program";
+  case Type::End: return "End";
+  case Type::DeviceInfo: return "DeviceInfo";
+  case Type::Read: return "Read";
+  case Type::Write: return "Write";
+  }
+  return "Unknown";
+}
+
+bool
+AnytoneRequestFrame::decode(FrameBuffer &buffer, AnytoneRequestFrame &frame) {
+  AnytoneRequestDecoder decoder;
+  return decoder.decode(buffer, frame);
+}
+
+
+/* ********************************************************************************************* *
+ * AnytoneRequestDecoder implementation
+ * ********************************************************************************************* */
+AnytoneRequestDecoder::AnytoneRequestDecoder()
+  : _state(State::Idle), _pos(0), _type(AnytoneRequestFrame::Type::Invalid),
+    _keyword(nullptr), _keywordLength(0), _address(0), _length(0), _checksum(0),
+    _checksumValid(true)
+{
+  // pass...
+}
+
+void
+AnytoneRequestDecoder::reset() {
+  _state = State::Idle;
+  _pos = 0;
+  _type = AnytoneRequestFrame::Type::Invalid;
+}
+
+bool
+AnytoneRequestDecoder::decode(FrameBuffer &buffer, AnytoneRequestFrame &frame) {
+  typedef AnytoneRequestFrame::Type Type;
+
+  const char *data = buffer.constData();
+  qsizetype size = buffer.size();
+
+  while (_pos < size) {
+    switch (_state) {
+    case State::Idle:
+      _address = 0; _length = 0; _checksum = 0;
+      switch (data[0]) {
+      case 'P':
+        _state = State::Keyword; _type = Type::Program;
+        _keyword = "PROGRAM"; _keywordLength = 7; _pos = 1;
+        break;
+      case 'E':
+        _state = State::Keyword; _type = Type::End;
+        _keyword = "END"; _keywordLength = 3; _pos = 1;
+        break;
+      case '\x02':
+        _type = Type::DeviceInfo;
+        return complete(buffer, frame, 1);
+      case 'R':
+        _state = State::ReadHeader; _type = Type::Read; _pos = 1;
+        break;
+      case 'W':
+        _state = State::WriteHeader; _type = Type::Write; _pos = 1;
+        break;
+      default:
+        // Skip unknown byte.
+        logDebug() << "Skip unexpected byte " << Qt::hex << (int)(uint8_t)data[0] << "h.";
+        buffer.consume(1);
+        data++; size--;
+        break;
+      }
+      break;
+
+    case State::Keyword:
+      if (_keyword[_pos] != data[_pos]) {
+        // Not a keyword, skip first byte and resynchronize.
+        logDebug() << "Skip unexpected byte " << Qt::hex << (int)(uint8_t)data[0] << "h.";
+        buffer.consume(1);
+        reset();
+        data++; size--;
+        break;
+      }
+      if (_keywordLength == ++_pos)
+        return complete(buffer, frame, _pos);
+      break;
+
+    case State::ReadHeader:
+    case State::WriteHeader: {
+      uint8_t b = data[_pos];
+      if (_pos < 5)
+        _address = (_address << 8) | b;
+      else
+        _length = b;
+      _checksum += b;
+      if (6 == ++_pos) {
+        if (State::ReadHeader == _state)
+          return complete(buffer, frame, _pos);
+        _state = _length ? State::WritePayload : State::WriteChecksum;
+      }
+      break;
+    }
+
+    case State::WritePayload: {
+      // Process all payload bytes received so far at once.
+      qsizetype n = std::min(size, qsizetype(6+_length)) - _pos;
+      _checksum += Checksum::sum8(data+_pos, n);
+      _pos += n;
+      if ((6+_length) == _pos)
+        _state = State::WriteChecksum;
+      break;
+    }
+
+    case State::WriteChecksum:
+      _checksumValid = (_checksum == (uint8_t)data[_pos]);
+      if (! _checksumValid)
+        logWarn() << "CRC mismatch!";
+      _state = State::WriteTail;
+      _pos++;
+      break;
+
+    case State::WriteTail:
+      // Final byte (ACK) is not checked.
+      return complete(buffer, frame, ++_pos);
+    }
+  }
+
+  return false;
+}
+
+bool
+AnytoneRequestDecoder::complete(FrameBuffer &buffer, AnytoneRequestFrame &frame, qsizetype size) {
+  frame.type = _type;
+  frame.address = _address;
+  frame.length = _length;
+  if (AnytoneRequestFrame::Type::Write == _type)
+    frame.payload = buffer.raw(6, _length);
+  else
+    frame.payload = QByteArray();
+  // Consuming just advances the head, the payload view remains valid.
+  buffer.consume(size);
+  reset();
+  return true;
+}
+
+
+/* ********************************************************************************************* *
+ * AnytoneResponseFrame implementation
+ * ********************************************************************************************* */
+bool
+AnytoneResponseFrame::serialize(QByteArray &buffer) const {
+  switch (type) {
+  case Type::None:
+    return false;
+  case Type::Program:
+    buffer.append("QX\x06");
+    return true;
+  case Type::ACK:
+  case Type::Write:
+    buffer.append('\x06');
+    return true;
+  case Type::DeviceInfo:
+    buffer.append("ID");
+    buffer.append(payload.constData(), std::min(payload.size(), qsizetype(6)));
+    buffer.append(band);
+    buffer.append(revision.constData(), std::min(revision.size(), qsizetype(6)));
+    buffer.append('\x06');
+    return true;
+  case Type::Read: {
+    qsizetype start = buffer.size();
+    uint32_t addr = qToBigEndian(address);
+    buffer.append('W');
+    buffer.append((const char *) &addr, 4);
+    buffer.append((char)payload.length());
+    buffer.append(payload);
+    buffer.append(Checksum::sum8(buffer.constData()+start+1, 5+payload.length()));
+    buffer.append('\x06');
+    return true;
+  }
+  }
+
+  return false;
+}
+
+AnytoneResponseFrame
+AnytoneResponseFrame::program() {
+  AnytoneResponseFrame frame;
+  frame.type = Type::Program;
+  return frame;
+}
+
+AnytoneResponseFrame
+AnytoneResponseFrame::ack() {
+  AnytoneResponseFrame frame;
+  frame.type = Type::ACK;
+  return frame;
+}
+
+AnytoneResponseFrame
+AnytoneResponseFrame::deviceInfo(const QByteArray &model, uint8_t band, const QByteArray &revision) {
+  AnytoneResponseFrame frame;
+  frame.type = Type::DeviceInfo;
+  frame.payload = model;
+  frame.band = band;
+  frame.revision = revision;
+  return frame;
+}
+
+AnytoneResponseFrame
+AnytoneResponseFrame::read(uint32_t address, const QByteArray &payload) {
+  AnytoneResponseFrame frame;
+  frame.type = Type::Read;
+  frame.address = address;
+  frame.payload = payload;
+  return frame;
+}
+
+AnytoneResponseFrame
+AnytoneResponseFrame::write(uint32_t address, uint8_t length) {
+  AnytoneResponseFrame frame;
+  frame.type = Type::Write;
+  frame.address = address;
+  frame.length = length;
+  return frame;
 }
 
 
@@ -25,35 +252,28 @@ AnytoneRequest::~AnytoneRequest()
 }
 
 AnytoneRequest *
-AnytoneRequest::fromBuffer(QByteArray &buffer) {
-  if (buffer.startsWith("PROGRAM")) {
-    buffer.remove(0, 7); // Remove request
+AnytoneRequest::fromBuffer(FrameBuffer &buffer) {
+  AnytoneRequestFrame frame;
+  if (! AnytoneRequestFrame::decode(buffer, frame))
+    return nullptr;
+  return fromFrame(frame);
+}
+
+AnytoneRequest *
+AnytoneRequest::fromFrame(const AnytoneRequestFrame &frame) {
+  switch (frame.type) {
+  case AnytoneRequestFrame::Type::Program:
     return new AnytoneProgramRequest();
-  } else if (buffer.startsWith("END")) {
-    buffer.remove(0, 3); // Remove request
+  case AnytoneRequestFrame::Type::End:
     return new AnytoneEndRequest();
-  } else if ((buffer.size()>=1) && (0x02 == buffer.front())) {
-    buffer.remove(0, 7); // Remove request
+  case AnytoneRequestFrame::Type::DeviceInfo:
     return new AnytoneDeviceInfoRequest();
-  } else if ((buffer.size()>=6) && ('R' == buffer.front())) {
-    uint32_t address = qFromBigEndian(*(uint32_t*)buffer.mid(1,4).constData());
-    uint8_t  length  = buffer[5];
-    buffer.remove(0,6);
-    return new AnytoneReadRequest(address, length);
-  } else if ((buffer.size()>=8) && ('W' == buffer.front())) {
-    uint32_t address = qFromBigEndian(*(uint32_t*)buffer.mid(1,4).constData());
-    uint8_t  length  = buffer[5];
-    // Continue, if sufficient data is there
-    if (buffer.size()<(length+8))
-      return nullptr;
-    // Get payload
-    QByteArray payload = buffer.mid(6, length);
-    // check CRC
-    if ((uint8_t)buffer[6+length] != crc8(buffer.mid(1, 5+length))) {
-      logWarn() << "CRC mismatch!";
-    }
-    buffer.remove(0,8+length);
-    return new AnytoneWriteRequest(address, payload);
+  case AnytoneRequestFrame::Type::Read:
+    return new AnytoneReadRequest(frame.address, frame.length);
+  case AnytoneRequestFrame::Type::Write:
+    return new AnytoneWriteRequest(frame.address, frame.payload);
+  case AnytoneRequestFrame::Type::Invalid:
+    break;
   }
 
   return nullptr;
@@ -134,8 +354,7 @@ AnytoneProgramResponse::AnytoneProgramResponse()
 
 bool
 AnytoneProgramResponse::serialize(QByteArray &buffer) {
-  buffer.append("QX\x06");
-  return true;
+  return AnytoneResponseFrame::program().serialize(buffer);
 }
 
 
@@ -150,8 +369,7 @@ AnytoneACKResponse::AnytoneACKResponse()
 
 bool
 AnytoneACKResponse::serialize(QByteArray &buffer) {
-  buffer.append("\x06");
-  return true;
+  return AnytoneResponseFrame::ack().serialize(buffer);
 }
 
 
@@ -166,12 +384,7 @@ AnytoneDeviceInfoResponse::AnytoneDeviceInfoResponse(const QByteArray &model, ui
 
 bool
 AnytoneDeviceInfoResponse::serialize(QByteArray &buffer) {
-  buffer.append("ID");
-  buffer.append(_model.left(6));
-  buffer.append(_band);
-  buffer.append(_hwVersion.left(6));
-  buffer.append("\x06");
-  return true;
+  return AnytoneResponseFrame::deviceInfo(_model, _band, _hwVersion).serialize(buffer);
 }
 
 
@@ -186,14 +399,7 @@ AnytoneReadResponse::AnytoneReadResponse(uint32_t addr, const QByteArray payload
 
 bool
 AnytoneReadResponse::serialize(QByteArray &buffer) {
-  uint32_t addr = qToBigEndian(_address);
-  buffer.append("W");
-  buffer.append(QByteArray::fromRawData((char*) &addr, 4));
-  buffer.append((char)_payload.length());
-  buffer.append(_payload);
-  buffer.append(crc8(buffer.right(5+_payload.length())));
-  buffer.append("\x06");
-  return true;
+  return AnytoneResponseFrame::read(_address, _payload).serialize(buffer);
 }
 
 
@@ -208,7 +414,6 @@ AnytoneWriteResponse::AnytoneWriteResponse(uint32_t addr, uint8_t len)
 
 bool
 AnytoneWriteResponse::serialize(QByteArray &buffer) {
-  buffer.append("\x06");
-  return true;
+  return AnytoneResponseFrame::write(_address, _length).serialize(buffer);
 }
 
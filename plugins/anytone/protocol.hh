@@ -9,8 +9,144 @@
 
 #include <QByteArray>
 
+class FrameBuffer;
+
+
+/** Tagged by-value representation of a decoded request to an AnyTone device.
+ *
+ * In contrast to the @c AnytoneRequest class hierarchy, frames are decoded into a (reusable)
+ * instance on the stack. Hence, no heap allocation is needed per request. The payload of write
+ * requests is a non-owning view into the receive buffer.
+ * @ingroup interface */
+struct AnytoneRequestFrame
+{
+  /** Possible request types. */
+  enum class Type {
+    Invalid, Program, End, DeviceInfo, Read, Write
+  };
+
+  /** The request type. */
+  Type type = Type::Invalid;
+  /** The address to read from or write to. */
+  uint32_t address = 0;
+  /** The amount to read or write. */
+  uint8_t length = 0;
+  /** The payload of a write request. Refers to the receive buffer. */
+  QByteArray payload;
+
+  /** Decodes the next request from the buffer into the given frame.
+   * Returns @c false if there is no complete request in the buffer. This is a stateless
+   * convenience function, partially received requests are scanned again on the next call. Use
+   * @c AnytoneRequestDecoder to decode a stream of requests. */
+  static bool decode(FrameBuffer &buffer, AnytoneRequestFrame &frame);
+  /** Returns a static name for the given request type. */
+  static const char *typeName(Type type);
+};
+
+
+/** Resumable decoder for a stream of requests to an AnyTone device.
+ *
+ * The decoder is a byte-driven state machine that keeps its progress across partial reads. That
+ * is, every received byte is examined exactly once and the checksum of write requests is
+ * accumulated while the payload streams in. The bytes of a request are only consumed from the
+ * receive buffer once the request is complete. Hence, the payload of a decoded write request is
+ * a view into the receive buffer. Bytes that do not start a known request are skipped.
+ * @ingroup interface */
+class AnytoneRequestDecoder
+{
+public:
+  /** Constructs a decoder in its initial state. */
+  AnytoneRequestDecoder();
+
+  /** Continues decoding the data in the given buffer. Returns @c true and consumes the request
+   * from the buffer, once a complete request has been decoded into @c frame. The buffer must
+   * not be modified between calls, except for appending data. */
+  bool decode(FrameBuffer &buffer, AnytoneRequestFrame &frame);
+  /** Resets the decoder into its initial state, e.g., after the buffer has been cleared. */
+  void reset();
+
+  /** Returns @c true if the checksum of the last decoded write request matched. */
+  inline bool checksumValid() const { return _checksumValid; }
+
+protected:
+  /** Completes the current request of the given size. */
+  bool complete(FrameBuffer &buffer, AnytoneRequestFrame &frame, qsizetype size);
+
+protected:
+  /** Decoder states. */
+  enum class State {
+    Idle,         ///< Waiting for the first byte of a request.
+    Keyword,      ///< Matching a keyword request (@c PROGRAM, @c END).
+    ReadHeader,   ///< Receiving the address and length of a read request.
+    WriteHeader,  ///< Receiving the address and length of a write request.
+    WritePayload, ///< Receiving the payload of a write request.
+    WriteChecksum,///< Receiving the checksum of a write request.
+    WriteTail     ///< Receiving the final ACK of a write request.
+  };
+
+  /** The current state. */
+  State _state;
+  /** Number of bytes of the current request already examined. */
+  qsizetype _pos;
+  /** The type of the current request. */
+  AnytoneRequestFrame::Type _type;
+  /** The keyword to match. */
+  const char *_keyword;
+  /** The length of the keyword. */
+  qsizetype _keywordLength;
+  /** The address of the current request. */
+  uint32_t _address;
+  /** The length of the current request. */
+  uint8_t _length;
+  /** The running checksum of the current write request. */
+  uint8_t _checksum;
+  /** Result of the last checksum check. */
+  bool _checksumValid;
+};
+
+
+/** Tagged by-value representation of a response of an AnyTone device.
+ * @ingroup interface */
+struct AnytoneResponseFrame
+{
+  /** Possible response types. */
+  enum class Type {
+    None, Program, ACK, DeviceInfo, Read, Write
+  };
+
+  /** The response type, @c None indicates that there is no response. */
+  Type type = Type::None;
+  /** The address read from or written to. */
+  uint32_t address = 0;
+  /** The amount of data written. */
+  uint8_t length = 0;
+  /** The band enum value of device-info responses. */
+  uint8_t band = 0;
+  /** The data read or the model ID for device-info responses. */
+  QByteArray payload;
+  /** The hardware version for device-info responses. */
+  QByteArray revision;
+
+  /** Serializes the response into the given buffer. */
+  bool serialize(QByteArray &buffer) const;
+
+  /** Constructs a response to a program request. */
+  static AnytoneResponseFrame program();
+  /** Constructs a simple ACK response. */
+  static AnytoneResponseFrame ack();
+  /** Constructs a response to a device-info request. */
+  static AnytoneResponseFrame deviceInfo(const QByteArray &model, uint8_t band,
+                                         const QByteArray &revision);
+  /** Constructs a response to a read request. */
+  static AnytoneResponseFrame read(uint32_t address, const QByteArray &payload);
+  /** Constructs a response to a write request. */
+  static AnytoneResponseFrame write(uint32_t address, uint8_t length);
+};
+
 
 /** Baseclass of a request to an AnyTone device.
+ * This class hierarchy is kept for compatibility, the device itself uses
+ * @c AnytoneRequestFrame.
  * @ingroup interface */
 class AnytoneRequest
 {
@@ -41,8 +177,12 @@ public:
   }
 
 public:
-  /** Decodes the given request. */
-  static AnytoneRequest *fromBuffer(QByteArray &buffer);
+  /** Decodes the given request.
+   * The payload of write requests refers to the given buffer and is only valid until new data
+   * is appended to it. */
+  static AnytoneRequest *fromBuffer(FrameBuffer &buffer);
+  /** Constructs a request object from the given frame. */
+  static AnytoneRequest *fromFrame(const AnytoneRequestFrame &frame);
 };
 
 
@@ -115,6 +255,8 @@ protected:
 
 
 /** Base class of all AnyTone device responses.
+ * This class hierarchy is kept for compatibility, the device itself uses
+ * @c AnytoneResponseFrame.
  * @ingroup interface */
 class AnytoneResponse
 {
@@ -45,7 +45,7 @@ constexpr char meta_flags_sorted[] =
 MD32UVDevice::MD32UVDevice(
   QIODevice *interface, const DM32UVFirmwareProperties &properties, CodeplugPattern *pattern,
   ImageCollector *handler, QObject *parent)
-  : GenericDevice{interface, pattern, handler, parent}, _timer(), _properties(properties)
+  : GenericDevice{interface, pattern, handler, parent}, _timer(this), _properties(properties)
 {
   // IO time-out handling
   _timer.setInterval(2000);
@@ -61,7 +61,7 @@ MD32UVDevice::MD32UVDevice(
 
 
 GenericRequest *
-MD32UVDevice::parse(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+MD32UVDevice::parse(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   return MD32UVRequest::fromBuffer(buffer, ok, err);
 }
 
@@ -29,7 +29,7 @@ public:
                         QObject *parent = nullptr);
 
 protected:
-  GenericRequest *parse(QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack()) override;
+  GenericRequest *parse(FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack()) override;
   GenericResponse *handle(GenericRequest *request) override;
 
   virtual bool getValue(uint8_t field, uint8_t length, QByteArray &payload);
@@ -14,39 +14,39 @@ MD32UVRequest::MD32UVRequest()
 
 
 MD32UVRequest *
-MD32UVRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+MD32UVRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   ok = true;
 
   if ((buffer.size() >= 1) && (0x06 == buffer.front())) {
     logDebug() << "Ping.";
-    buffer = buffer.sliced(1);
+    buffer.consume(1);
     return new MD32UVPingRequest();
   } else if ((buffer.size() >= 7) && buffer.startsWith("PSEARCH")) {
     logDebug() << "Detect device.";
-    buffer = buffer.sliced(7);
+    buffer.consume(7);
     return new MD32UVSearchRequest();
   } else if ((buffer.size() >= 7) && buffer.startsWith("PASSSTA")) {
     logDebug() << "Check password.";
-    buffer = buffer.sliced(7);
+    buffer.consume(7);
     return new MD32UVPasswordRequest();
   } else if ((buffer.size() >= 7) && buffer.startsWith("SYSINFO")) {
     logDebug() << "Enter system info mode.";
-    buffer = buffer.sliced(7);
+    buffer.consume(7);
     return new MD32UVStartSystemInfoRequest();
   } else if ((buffer.size() >= 7) && buffer.startsWith("PROGRAM")) {
     logDebug() << "Enter programming mode.";
-    buffer = buffer.sliced(7);
+    buffer.consume(7);
     return new MD32UVStartProgramRequest();
   } else if ((buffer.size() >= 1) && buffer.startsWith("\x02")) {
     logDebug() << "Some unknown 02h request.";
-    buffer = buffer.sliced(1);
+    buffer.consume(1);
     return new MD32UVUnknown02Request();
   } else if ((buffer.size() >= 5) && buffer.startsWith("V")) {
     auto flags = qFromLittleEndian(*(uint16_t *)(buffer.constData()+1));
     auto len   = qFromLittleEndian(*(uint8_t *)(buffer.constData()+3));
     auto field = qFromLittleEndian(*(uint8_t *)(buffer.constData()+4));
     logDebug() << "Request " << len << "b from value " << field << ".";
-    buffer = buffer.sliced(5);
+    buffer.consume(5);
     return new MD32UVValueRequest(flags, len, field);
   } else if ((buffer.size() >= 6) && buffer.startsWith('G')) {
     auto addr  = ((uint32_t)((uint8_t)buffer.at(1)) << 0) +
@@ -55,7 +55,7 @@ MD32UVRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
     auto len   = qFromLittleEndian(*(uint16_t *)(buffer.constData()+4));
     logDebug() << "Read " << len << "b from value at address "
                << Qt::hex << addr << ".";
-    buffer = buffer.sliced(6);
+    buffer.consume(6);
     return new MD32UVReadInfoRequest(addr, len);
   } else if ((buffer.size() >= 6) && buffer.startsWith('R')) {
     auto address = ((uint32_t)((uint8_t)buffer.at(1)) << 0) +
@@ -64,7 +64,7 @@ MD32UVRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
     auto len = qFromLittleEndian(*(uint16_t *)(buffer.constData()+4));
     logDebug() << "Read " << len << "b from memory at address "
                << Qt::hex << address << ".";
-    buffer = buffer.sliced(6);
+    buffer.consume(6);
     return new MD32UVReadRequest(address, len);
   } else if ((buffer.size() >= 6) && buffer.startsWith('W')) {
     uint32_t address = uint32_t(uint8_t(buffer.at(1)))
@@ -76,16 +76,16 @@ MD32UVRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
       return nullptr;
     }
     logDebug() << "Complete write " << len << "b to " << Qt::hex << address << ".";
-    auto payload = buffer.mid(6, len);
-    buffer = buffer.sliced(6+len);
+    auto payload = buffer.raw(6, len);
+    buffer.consume(6+len);
     return new MD32UVWriteRequest(address, payload);
-  } else if ((buffer.size() >= 5) && buffer.startsWith(QByteArray("\xff\xff\xff\xff\x0c", 5))) {
-    logDebug() << "Ignore unknown data " << buffer.first(5).toHex(' ') << ".";
-    buffer = buffer.sliced(5);
+  } else if ((buffer.size() >= 5) && buffer.startsWith(QByteArrayView("\xff\xff\xff\xff\x0c", 5))) {
+    logDebug() << "Ignore unknown data " << buffer.view(0, 5).toByteArray().toHex(' ') << ".";
+    buffer.consume(5);
   }
 
   if (0 != buffer.size()) {
-    logDebug() << "Some left-over bytes: " << buffer.toHex(' ') << ".";
+    logDebug() << "Some left-over bytes: " << buffer.view().toByteArray().toHex(' ') << ".";
   }
 
   return nullptr;
@@ -16,7 +16,7 @@ protected:
 public:
   /** Decodes the given request. */
   static MD32UVRequest *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err = ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err = ErrorStack());
 };
 
 
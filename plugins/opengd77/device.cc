@@ -1,6 +1,7 @@
 #include "device.hh"
 
 #include <QIODevice>
+#include <typeinfo>
 
 #include "logger.hh"
 #include "protocol.hh"
@@ -28,19 +29,25 @@ OpenGD77Device::OpenGD77Device(
 
 void
 OpenGD77Device::onBytesAvailable() {
-  _in_buffer.append(_interface->readAll());
+  _statistics.received(_in_buffer.readFrom(_interface));
 
   bool ok = true;
   ErrorStack err;
+  int64_t start = DeviceStatistics::now();
   while (auto req = OpenGD77Request::fromBuffer(_in_buffer, ok, err)) {
+    const char *type = typeid(*req).name();
     auto resp = this->handle(req);
     delete req;
     if (resp) {
-      if (resp->serialize(_out_buffer)) {
+      if (resp->serialize(_out_buffer.buffer())) {
+        _statistics.buffered(_out_buffer.size());
         onBytesWritten();
       }
       delete resp;
     }
+    int64_t end = DeviceStatistics::now();
+    _statistics.handled(type, end-start);
+    start = end;
   }
 
   if (! ok) {
@@ -52,11 +59,7 @@ OpenGD77Device::onBytesAvailable() {
 
 void
 OpenGD77Device::onBytesWritten() {
-  if (0 == _out_buffer.size())
-    return;
-
-  qint64 nbytes = _interface->write(_out_buffer);
-  _out_buffer.remove(0, nbytes);
+  _statistics.sent(_out_buffer.writeTo(_interface));
 }
 
 
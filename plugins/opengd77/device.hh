@@ -2,6 +2,7 @@
 #define OPENGD77DEVICE_HH
 
 #include <device.hh>
+#include <framebuffer.hh>
 
 
 class OpenGD77Request;
@@ -30,8 +31,8 @@ protected slots:
 
 protected:
   QIODevice *_interface;
-  QByteArray _in_buffer;
-  QByteArray _out_buffer;
+  FrameBuffer _in_buffer;
+  FrameBuffer _out_buffer;
 };
 
 #endif // OPENGD77DEVICE_HH
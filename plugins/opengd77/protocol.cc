@@ -1,6 +1,7 @@
 #include "protocol.hh"
 #include <QtEndian>
 #include "logger.hh"
+#include "framebuffer.hh"
 
 
 /* ********************************************************************************************* *
@@ -17,7 +18,7 @@ OpenGD77Request::~OpenGD77Request()
 }
 
 OpenGD77Request *
-OpenGD77Request::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77Request::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   if (0 == buffer.size())
     return nullptr;
 
@@ -48,7 +49,7 @@ OpenGD77CommandRequest::OpenGD77CommandRequest()
 }
 
 OpenGD77Request *
-OpenGD77CommandRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77CommandRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
 
   if (buffer.size() < 2) {
     ok = true;
@@ -88,9 +89,9 @@ OpenGD77PingRequest::OpenGD77PingRequest()
 }
 
 OpenGD77Request *
-OpenGD77PingRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77PingRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   Q_UNUSED(err);
-  buffer.remove(0, 2);
+  buffer.consume(2);
   return new OpenGD77PingRequest();
 }
 
@@ -105,9 +106,9 @@ OpenGD77ShowCPSScreenRequest::OpenGD77ShowCPSScreenRequest()
 }
 
 OpenGD77Request *
-OpenGD77ShowCPSScreenRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77ShowCPSScreenRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   Q_UNUSED(err);
-  buffer.remove(0, 2);
+  buffer.consume(2);
   return new OpenGD77ShowCPSScreenRequest();
 }
 
@@ -122,9 +123,9 @@ OpenGD77ClearScreenRequest::OpenGD77ClearScreenRequest()
 }
 
 OpenGD77Request *
-OpenGD77ClearScreenRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77ClearScreenRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   Q_UNUSED(err);
-  buffer.remove(0, 2);
+  buffer.consume(2);
   return new OpenGD77ClearScreenRequest();
 }
 
@@ -142,11 +143,11 @@ OpenGD77DisplayRequest::OpenGD77DisplayRequest(uint8_t x, uint8_t y, uint8_t fon
 }
 
 OpenGD77Request *
-OpenGD77DisplayRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77DisplayRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   uint8_t x = buffer.at(2), y = buffer.at(3), font = buffer.at(4), alignment = buffer.at(5);
   bool inverted = buffer.at(6);
 
-  QByteArray text = buffer.mid(7);
+  QByteArray text = buffer.view(7, buffer.size()-7).toByteArray();
 
   buffer.clear();
 
@@ -164,9 +165,9 @@ OpenGD77RenderScreenRequest::OpenGD77RenderScreenRequest()
 }
 
 OpenGD77Request *
-OpenGD77RenderScreenRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77RenderScreenRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   Q_UNUSED(err);
-  buffer.remove(0, 2);
+  buffer.consume(2);
   return new OpenGD77RenderScreenRequest();
 }
 
@@ -181,9 +182,9 @@ OpenGD77ResetScreenRequest::OpenGD77ResetScreenRequest()
 }
 
 OpenGD77Request *
-OpenGD77ResetScreenRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77ResetScreenRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   Q_UNUSED(err);
-  buffer.remove(0, 2);
+  buffer.consume(2);
   return new OpenGD77ResetScreenRequest();
 }
 
@@ -203,7 +204,7 @@ OpenGD77ControlRequest::option() const {
 }
 
 OpenGD77Request *
-OpenGD77ControlRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77ControlRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   Q_UNUSED(err);
   Option opt = (Option) buffer.at(2);
   logDebug() << "Control request " << opt << ".";
@@ -238,7 +239,7 @@ OpenGD77ReadRequest::length() const {
 }
 
 OpenGD77Request *
-OpenGD77ReadRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77ReadRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   if (buffer.size() < size()) {
     ok = true;
     return nullptr;
@@ -247,10 +248,10 @@ OpenGD77ReadRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &
   ok = true;
 
   Section sec      = (Section) buffer.at(1);
-  uint32_t address = qFromBigEndian(*(uint32_t *)buffer.mid(2,4).constData());
-  uint16_t length  = qFromBigEndian(*(uint16_t *)buffer.mid(6,2).constData());
+  uint32_t address = qFromBigEndian<uint32_t>(buffer.constData()+2);
+  uint16_t length  = qFromBigEndian<uint16_t>(buffer.constData()+6);
 
-  buffer.remove(0, size());
+  buffer.consume(size());
 
   return new OpenGD77ReadRequest{sec, address, length};
 }
@@ -276,7 +277,7 @@ OpenGD77WriteRequest::section() const {
 }
 
 OpenGD77Request *
-OpenGD77WriteRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77WriteRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   if (buffer.size() < 2) {
     ok = true;
     return nullptr;
@@ -316,7 +317,7 @@ OpenGD77SetSectorRequest::OpenGD77SetSectorRequest(Type type, uint32_t sector)
 
 
 OpenGD77Request *
-OpenGD77SetSectorRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77SetSectorRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
 
   ok = true;
 
@@ -325,7 +326,7 @@ OpenGD77SetSectorRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorSt
                       (((uint32_t)buffer.at(3)) <<  8) +
                       (((uint32_t)buffer.at(4)) <<  0) );
 
-  buffer.remove(0, 5);
+  buffer.consume(5);
 
   return new OpenGD77SetSectorRequest(type, sector);
 }
@@ -341,10 +342,10 @@ OpenGD77WriteSectorRequest::OpenGD77WriteSectorRequest(Type type)
 }
 
 OpenGD77Request *
-OpenGD77WriteSectorRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77WriteSectorRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   ok = true;
   Type type = ('W' == buffer.at(0)) ? Type::W_REQUEST : Type::X_REQUEST;
-  buffer.remove(0, 2);
+  buffer.consume(2);
   return new OpenGD77WriteSectorRequest(type);
 }
 
@@ -370,15 +371,20 @@ OpenGD77WriteDataRequest::data() const {
 }
 
 OpenGD77Request *
-OpenGD77WriteDataRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+OpenGD77WriteDataRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
+  ok = true;
+  if (buffer.size() < 8)
+    return nullptr;
+
   Type type = ('W' == buffer.at(0)) ? Type::W_REQUEST : Type::X_REQUEST;
   Section section = (Section) buffer.at(1);
-  uint32_t address = qFromBigEndian(*((uint32_t *)buffer.mid(2,4).constData()));
-  uint16_t length  = qFromBigEndian(*((uint16_t *)buffer.mid(6,2).constData()));
-  QByteArray data  = buffer.mid(8, length);
+  uint32_t address = qFromBigEndian<uint32_t>(buffer.constData()+2);
+  uint16_t length  = qFromBigEndian<uint16_t>(buffer.constData()+6);
+  if (buffer.size() < (8+length))
+    return nullptr;
+  QByteArray data  = buffer.raw(8, length);
 
-  ok = true;
-  buffer.remove(0, 8+length);
+  buffer.consume(8+length);
   return new OpenGD77WriteDataRequest(type, section, address, data);
 }
 
@@ -5,6 +5,8 @@
 
 #include "errorstack.hh"
 
+class FrameBuffer;
+
 
 class OpenGD77Request
 {
@@ -37,7 +39,7 @@ public:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err = ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err = ErrorStack());
 };
 
 
@@ -81,7 +83,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 };
 
 
@@ -91,7 +93,7 @@ protected:
   OpenGD77PingRequest();
 
 public:
-  static OpenGD77Request *fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+  static OpenGD77Request *fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 };
 
 
@@ -103,7 +105,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 };
 
 
@@ -115,7 +117,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 };
 
 
@@ -128,7 +130,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 
 protected:
   uint8_t _x, _y;
@@ -148,7 +150,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 };
 
 
@@ -161,7 +163,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 };
 
 
@@ -188,7 +190,7 @@ protected:
 public:
   /** Decodes the given request. */
   static OpenGD77Request *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err=ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err=ErrorStack());
 
   Option option() const;
 protected:
@@ -232,7 +234,7 @@ public:
 public:
   static constexpr unsigned int size() { return 0x0008; }
 
-  static OpenGD77Request *fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err = ErrorStack());
+  static OpenGD77Request *fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err = ErrorStack());
 
 protected:
   Section _section;
@@ -277,7 +279,7 @@ public:
   Section section() const;
 
 public:
-  static OpenGD77Request *fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err = ErrorStack());
+  static OpenGD77Request *fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err = ErrorStack());
 
 protected:
   Type _type;
@@ -304,7 +306,7 @@ protected:
   OpenGD77SetSectorRequest(OpenGD77WriteRequest::Type type, uint32_t sector);
 
 public:
-  static OpenGD77Request *fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err);
+  static OpenGD77Request *fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err);
 
 protected:
   uint32_t _sector;
@@ -317,7 +319,7 @@ protected:
   OpenGD77WriteSectorRequest(OpenGD77WriteRequest::Type type);
 
 public:
-  static OpenGD77Request *fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err);
+  static OpenGD77Request *fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err);
 };
 
 
@@ -331,7 +333,7 @@ public:
   const QByteArray &data() const;
 
 public:
-  static OpenGD77Request *fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err);
+  static OpenGD77Request *fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err);
 
 protected:
   uint32_t _address;
@@ -2,6 +2,7 @@
 
 
 #include <QIODevice>
+#include <typeinfo>
 
 #include "logger.hh"
 #include "protocol.hh"
@@ -28,19 +29,25 @@ RadtelDevice::RadtelDevice(
 
 void
 RadtelDevice::onBytesAvailable() {
-  _in_buffer.append(_interface->readAll());
+  _statistics.received(_in_buffer.readFrom(_interface));
 
   bool ok = true;
   ErrorStack err;
+  int64_t start = DeviceStatistics::now();
   while (auto req = RadtelRequest::fromBuffer(_in_buffer, ok, err)) {
+    const char *type = typeid(*req).name();
     auto resp = this->handle(req);
     delete req;
     if (resp) {
-      if (resp->serialize(_out_buffer)) {
+      if (resp->serialize(_out_buffer.buffer())) {
+        _statistics.buffered(_out_buffer.size());
         onBytesWritten();
       }
       delete resp;
     }
+    int64_t end = DeviceStatistics::now();
+    _statistics.handled(type, end-start);
+    start = end;
   }
 
   if (! ok) {
@@ -52,11 +59,8 @@ RadtelDevice::onBytesAvailable() {
 
 void
 RadtelDevice::onBytesWritten() {
-  if (0 == _out_buffer.size())
-    return;
-
-  qint64 nbytes = _interface->write(_out_buffer);
-  _out_buffer.remove(0, nbytes);
+  qint64 nbytes = _out_buffer.writeTo(_interface);
+  _statistics.sent(nbytes);
   logDebug() << "Send " << Qt::hex << nbytes
              << "h bytes," << Qt::hex << _out_buffer.size() << "h bytes left.";
 }
@@ -2,6 +2,7 @@
 #define RADTELDEVICE_HH
 
 #include <device.hh>
+#include <framebuffer.hh>
 
 class RadtelRequest;
 class RadtelResponse;
@@ -29,8 +30,8 @@ protected slots:
 
 protected:
   QIODevice *_interface;
-  QByteArray _in_buffer;
-  QByteArray _out_buffer;
+  FrameBuffer _in_buffer;
+  FrameBuffer _out_buffer;
 };
 
 #endif // RADTELDEVICE_HH
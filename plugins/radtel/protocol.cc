@@ -1,14 +1,13 @@
 #include "protocol.hh"
 #include <QtEndian>
 #include "logger.hh"
+#include "framebuffer.hh"
+#include "checksum.hh"
 
 
 // CRC
-inline bool checkCRC(const QByteArray &buffer) {
-  uint8_t b = 0;
-  for (qsizetype i=0; i<(buffer.size()-1); i++)
-    b += (uint8_t)buffer.at(i);
-  return b == (uint8_t)buffer.at(buffer.size()-1);
+inline bool checkCRC(const char *buffer, qsizetype size) {
+  return Checksum::sum8(buffer, size-1) == (uint8_t)buffer[size-1];
 }
 
 
@@ -26,7 +25,7 @@ RadtelRequest::~RadtelRequest() {
 
 
 RadtelRequest *
-RadtelRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
+RadtelRequest::fromBuffer(FrameBuffer &buffer, bool &ok, const ErrorStack &err) {
   ok = true;
   if (1 > buffer.size())
     return nullptr;
@@ -34,46 +33,46 @@ RadtelRequest::fromBuffer(QByteArray &buffer, bool &ok, const ErrorStack &err) {
   if (0x34 == buffer.at(0)) {
     if (5 > buffer.size())
       return nullptr;
-    if (! checkCRC(buffer.first(5))) {
+    if (! checkCRC(buffer.constData(), 5)) {
       errMsg(err) << "Cannot parse request: invalid CRC.";
       ok = false;
       return nullptr;
     }
     uint8_t f1 = buffer.at(2), f2 = buffer.at(3);
     if ((0x05 == f1) && (0x10==f2)) {
-      buffer = buffer.sliced(5);
+      buffer.consume(5);
       return new RadtelCommandRequest(RadtelCommandRequest::EnterProgrammingMode);
     } else if ((0x05 == f1) && (0xee==f2)) {
-      buffer = buffer.sliced(5);
+      buffer.consume(5);
       return new RadtelCommandRequest(RadtelCommandRequest::LeaveProgrammingMode);
     }
   } else if (0x52 == buffer.at(0)) {
     if (4 > buffer.size())
       return nullptr;
-    if (! checkCRC(buffer.first(4))) {
+    if (! checkCRC(buffer.constData(), 4)) {
       errMsg(err) << "Cannot parse request: invalid CRC.";
       ok = false;
       return nullptr;
     }
     auto page = qFromBigEndian(*(uint16_t *)(buffer.constData()+1));
-    buffer = buffer.sliced(4);
+    buffer.consume(4);
     return new RadtelReadRequest(page);
   } else if (0x90 == (0xf0 & buffer.at(0))) {
     if (1028 > buffer.size())
       return nullptr;
-    if (! checkCRC(buffer.first(1028))) {
+    if (! checkCRC(buffer.constData(), 1028)) {
       errMsg(err) << "Cannot parse request: invalid CRC.";
       ok = false;
       return nullptr;
     }
     auto segment = 0x0f & (uint8_t)buffer.at(0);
     auto page = qFromBigEndian(*(uint16_t *)(buffer.constData()+1));
-    auto payload = buffer.mid(3, 1024);
-    buffer = buffer.sliced(1028);
+    auto payload = buffer.raw(3, 1024);
+    buffer.consume(1028);
     return new RadtelWriteRequest(segment, page, payload);
   }
 
-  errMsg(err) << "Unexpected request: " << buffer.toHex(' ') << ". Ignore.";
+  errMsg(err) << "Unexpected request: " << buffer.view().toByteArray().toHex(' ') << ". Ignore.";
   ok = true;
   buffer.clear();
 
@@ -215,7 +214,6 @@ RadtelReadResonse::serialize(QByteArray &buffer) {
   auto startIdx = buffer.size(), endIdx = startIdx+1027;
   buffer.append('R'); buffer.append((char*)&page, 2);
   buffer.append(_payload);
-  uint8_t crc = 0; for (auto i=startIdx; i<endIdx; i++) crc += (uint8_t)buffer.at(i);
-  buffer.append(crc);
+  buffer.append(Checksum::sum8(buffer.constData()+startIdx, endIdx-startIdx));
   return true;
  }
@@ -3,6 +3,8 @@
 
 #include "errorstack.hh"
 
+class FrameBuffer;
+
 
 /** Base class of all requests. */
 class RadtelRequest
@@ -36,7 +38,7 @@ public:
 public:
   /** Decodes the given request. */
   static RadtelRequest *fromBuffer(
-      QByteArray &buffer, bool &ok, const ErrorStack &err = ErrorStack());
+      FrameBuffer &buffer, bool &ok, const ErrorStack &err = ErrorStack());
 };
 
 
@@ -2,13 +2,14 @@
 #include "config.hh"
 #include "image.hh"
 #include "device.hh"
+#include "emulationthread.hh"
 #include "spellchecker.hh"
 #include <QIcon>
 
 
 Application::Application(int &argc, char *argv[])
   : QApplication(argc, argv), _collection(new Collection(this)), _catalog(), _device(nullptr),
-  _spellChecker(nullptr)
+  _thread(nullptr), _spellChecker(nullptr)
 {
   setApplicationDisplayName("AnyTone emulator");
   setOrganizationName("DMRTools");
@@ -44,15 +45,24 @@ Application::spellChecker() {
 
 
 void
-Application::setDevice(Device *device) {
-  if (_device)
+Application::setDevice(Device *device, bool threaded) {
+  if (_thread) {
+    // Stops the thread and deletes the device.
+    delete _thread;
+    _thread = nullptr;
+  } else if (_device) {
     _device->deleteLater();
+  }
   _device = device;
   if (_device->pattern()) {
     connect(_device->pattern(), &CodeplugPattern::modified, this, &Application::patternModified);
     connect(_device->pattern(), &CodeplugPattern::added, this, &Application::patternModified);
     connect(_device->pattern(), &CodeplugPattern::removed, this, &Application::patternModified);
   }
+  if (threaded) {
+    _thread = new EmulationThread(_device, this);
+    _thread->start();
+  }
 }
 
 const Device *
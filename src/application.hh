@@ -5,6 +5,7 @@
 #include <QWidget>
 
 class Device;
+class EmulationThread;
 class Collection;
 class SpellChecker;
 
@@ -22,7 +23,8 @@ public:
   void setCatalog(const QString &filename);
   const QString &catalog() const;
 
-  void setDevice(Device *device);
+  /** Sets the device. If @c threaded is set, the device is run within a dedicated thread. */
+  void setDevice(Device *device, bool threaded=false);
   const Device *device() const;
 
   template <class T>
@@ -42,6 +44,7 @@ signals:
 protected:
   QString _catalog;
   Device *_device;
+  EmulationThread *_thread;
   Collection *_collection;
   SpellChecker *_spellChecker;
 };
@@ -1,14 +1,17 @@
 #include "heximagedocument.hh"
 #include "hexdump.hh"
+#include "hexformat.hh"
+#include "changemap.hh"
 
 #include <QTextFrame>
 #include <QTextCursor>
 #include <QTextDocumentFragment>
+#include <cstring>
 
 HexDocument::HexDocument(bool darkMode, QObject *parent)
   : QTextDocument{parent}, _elementFormat(), _elementTitleFormat(), _lineFormat(), _baseFormat(),
     _addressFormat(), _offsetFormat(), _valueFormat(), _keepValueFormat(), _addValueFormat(),
-    _remValueFormat(), _unusedValueFormat(), _charsFormat(), _separatorFormat()
+    _remValueFormat(), _unusedValueFormat(), _heatColor(Qt::red), _charsFormat(), _separatorFormat()
 {
   clear();
   setDocumentMargin(4);
@@ -87,41 +90,108 @@ HexDocument::putElementTitle(const HexElement &element, QTextCursor &cursor) {
 
 void
 HexDocument::putAddress(uint32_t address, QTextCursor &cursor) {
-  cursor.insertText(QString("%1 ").arg(address, 8, 16, QChar('0')), _addressFormat);
+  char text[HexFormat::AddressLength+1];
+  HexFormat::formatAddress(address, text);
+  text[HexFormat::AddressLength] = ' ';
+  cursor.insertText(QString::fromLatin1(text, sizeof(text)), _addressFormat);
+}
+
+const QTextCharFormat &
+HexDocument::valueFormat(HexLine::Byte::Type type) const {
+  switch (type) {
+  case HexLine::Byte::Modified:
+  case HexLine::Byte::Keep: return _keepValueFormat;
+  case HexLine::Byte::Add: return _addValueFormat;
+  case HexLine::Byte::Remove: return _remValueFormat;
+  case HexLine::Byte::Unused: break;
+  }
+  return _unusedValueFormat;
 }
 
 void
 HexDocument::putValues(const QVector<HexLine::Byte> &values, QTextCursor &cursor) {
-  for (unsigned int i=0; i<values.size(); i++) {
+  int count = std::min(int(values.size()), HexFormat::LineSize);
+  uint8_t bytes[HexFormat::LineSize] = {0};
+  for (int i=0; i<count; i++)
+    bytes[i] = values[i].value;
+  char text[HexFormat::ValuesLength];
+  HexFormat::formatLine(bytes, text, nullptr);
+  for (int i=0; i<count; i++) {
+    if (HexLine::Byte::Unused == values[i].type)
+      std::memcpy(text + 3*i, ".. ", 3);
+  }
+
+  // Consecutive values with the same format are inserted at once.
+  for (int i=0; i<count;) {
     if (8 == i)
       cursor.insertText(QString(" "), _baseFormat);
-    switch(values[i].type) {
-    case HexLine::Byte::Modified:
-    case HexLine::Byte::Keep:
-      cursor.insertText(QString("%1 ").arg(values[i].value, 2, 16, QChar('0')), _keepValueFormat);
-      break;
-    case HexLine::Byte::Add:
-      cursor.insertText(QString("%1 ").arg(values[i].value, 2, 16, QChar('0')), _addValueFormat);
-      break;
-    case HexLine::Byte::Remove:
-      cursor.insertText(QString("%1 ").arg(values[i].value, 2, 16, QChar('0')), _remValueFormat);
-      break;
-    case HexLine::Byte::Unused:
-      cursor.insertText(QString(".. "), _unusedValueFormat);
-      break;
-    }
+    const QTextCharFormat &format = valueFormat(values[i].type);
+    int end = i+1;
+    while ((end < count) && (8 != end) && (&format == &valueFormat(values[end].type)))
+      end++;
+    cursor.insertText(QString::fromLatin1(text + 3*i, 3*(end-i)), format);
+    i = end;
   }
 }
 
+QTextCharFormat
+HexDocument::heatFormat(uint16_t count, uint16_t maxCount) const {
+  QTextCharFormat format = _valueFormat;
+  if ((0 == count) || (0 == maxCount))
+    return format;
+  // The more often a byte changed, the more opaque its background.
+  QColor color = _heatColor;
+  color.setAlpha(48 + (207*int(count))/maxCount);
+  format.setBackground(color);
+  return format;
+}
+
 void
-HexDocument::putChars(const QVector<HexLine::Byte> &values, QTextCursor &cursor)
+HexDocument::putHeatValues(uint32_t address, const QVector<HexLine::Byte> &values,
+                           const ChangeMap &heatmap, uint16_t maxCount, QTextCursor &cursor)
 {
-  for (unsigned int i=0; i<values.size(); i++) {
-    if (values[i].value>=0x20 && values[i].value<0x7f)
-      cursor.insertText(QString("%1").arg((char)values[i].value), _charsFormat);
-    else
-      cursor.insertText(".", _charsFormat);
+  int count = std::min(int(values.size()), HexFormat::LineSize);
+  uint8_t bytes[HexFormat::LineSize] = {0};
+  uint16_t counts[HexFormat::LineSize] = {0};
+  for (int i=0; i<count; i++) {
+    bytes[i] = values[i].value;
+    if (HexLine::Byte::Unused != values[i].type)
+      counts[i] = heatmap.count(address+i);
+  }
+  char text[HexFormat::ValuesLength];
+  HexFormat::formatLine(bytes, text, nullptr);
+  for (int i=0; i<count; i++) {
+    if (HexLine::Byte::Unused == values[i].type)
+      std::memcpy(text + 3*i, ".. ", 3);
   }
+
+  // Consecutive values with the same count are inserted at once.
+  for (int i=0; i<count;) {
+    if (8 == i)
+      cursor.insertText(QString(" "), _baseFormat);
+    bool unused = (HexLine::Byte::Unused == values[i].type);
+    int end = i+1;
+    while ((end < count) && (8 != end) && (counts[end] == counts[i])
+           && (unused == (HexLine::Byte::Unused == values[end].type)))
+      end++;
+    QTextCharFormat format = unused ? _unusedValueFormat : heatFormat(counts[i], maxCount);
+    // Only the values get highlighted, not the separating space.
+    cursor.insertText(QString::fromLatin1(text + 3*i, 3*(end-i)-1), format);
+    cursor.insertText(QString(" "), _valueFormat);
+    i = end;
+  }
+}
+
+void
+HexDocument::putChars(const QVector<HexLine::Byte> &values, QTextCursor &cursor)
+{
+  int count = std::min(int(values.size()), HexFormat::LineSize);
+  uint8_t bytes[HexFormat::LineSize] = {0};
+  for (int i=0; i<count; i++)
+    bytes[i] = values[i].value;
+  char text[HexFormat::CharsLength];
+  HexFormat::formatLine(bytes, nullptr, text, '.');
+  cursor.insertText(QString::fromLatin1(text, count), _charsFormat);
 }
 
 void
@@ -8,6 +8,8 @@
 
 #include "hexdump.hh"
 
+class ChangeMap;
+
 class HexDocument: public QTextDocument
 {
   Q_OBJECT
@@ -28,6 +30,13 @@ protected:
   virtual void putAddress(uint32_t address, QTextCursor &cursor);
   virtual void putValues(const QVector<HexLine::Byte> &values, QTextCursor &cursor);
   virtual void putChars(const QVector<HexLine::Byte> &values, QTextCursor &cursor);
+  /** Puts the values of the line at the given address, their background shows how often each
+   * byte changed according to the heatmap, relative to @c maxCount. */
+  virtual void putHeatValues(uint32_t address, const QVector<HexLine::Byte> &values,
+                             const ChangeMap &heatmap, uint16_t maxCount, QTextCursor &cursor);
+
+  const QTextCharFormat &valueFormat(HexLine::Byte::Type type) const;
+  QTextCharFormat heatFormat(uint16_t count, uint16_t maxCount) const;
 
 protected:
   QTextFrameFormat _elementFormat;
@@ -41,6 +50,7 @@ protected:
   QTextCharFormat  _addValueFormat;
   QTextCharFormat  _remValueFormat;
   QTextCharFormat  _unusedValueFormat;
+  QColor           _heatColor;
   QTextCharFormat  _charsFormat;
   QTextCharFormat  _separatorFormat;
 };
@@ -6,7 +6,14 @@
 #include <QTextDocumentFragment>
 
 HexImageDumpDocument::HexImageDumpDocument(bool darkMode, const HexImage &img, QObject *parent)
-  : HexDocument{darkMode, parent}
+  : HexImageDumpDocument{darkMode, img, ChangeMap(), parent}
+{
+  // pass...
+}
+
+HexImageDumpDocument::HexImageDumpDocument(bool darkMode, const HexImage &img,
+                                           const ChangeMap &heatmap, QObject *parent)
+  : HexDocument{darkMode, parent}, _heatmap(heatmap), _maxCount(heatmap.maxCount())
 {
   QTextCursor cursor = this->rootFrame()->firstCursorPosition();
   for (unsigned int ei=0; ei<img.size(); ei++) {
@@ -33,7 +40,10 @@ HexImageDumpDocument::putLine(const HexLine &line, QTextCursor &cursor) {
 
   putAddress(line.address(), cursor);
 
-  putValues(line.left(), cursor);
+  if (0 == _maxCount)
+    putValues(line.left(), cursor);
+  else
+    putHeatValues(line.address(), line.left(), _heatmap, _maxCount, cursor);
 
   cursor.insertText(QString(" "), _separatorFormat);
 
@@ -2,6 +2,7 @@
 #define HEXIMAGEDUMPDOCUMENT_HH
 
 #include "heximagedocument.hh"
+#include "changemap.hh"
 
 class HexImageDumpDocument: public HexDocument
 {
@@ -9,11 +10,20 @@ class HexImageDumpDocument: public HexDocument
 
 public:
   HexImageDumpDocument(bool darkMode, const HexImage &img, QObject *parent = nullptr);
+  /** Dumps the image, highlighting how often each byte changed according to the heatmap. */
+  HexImageDumpDocument(bool darkMode, const HexImage &img, const ChangeMap &heatmap,
+                       QObject *parent = nullptr);
 
 protected:
   void putElement(const HexElement &element, QTextCursor &cursor);
   void putLine(const HexLine &line, QTextCursor &cursor);
   void putOffsets(QTextCursor &cursor);
+
+protected:
+  /** The heatmap, empty if the plain dump is shown. */
+  ChangeMap _heatmap;
+  /** Maximum count of the heatmap, 0 if nothing changed. */
+  uint16_t _maxCount;
 };
 
 #endif // HEXIMAGEDUMPDOCUMENT_HH
@@ -4,7 +4,8 @@
 
 
 ImageCollectionAdapter::ImageCollectionAdapter(Collection *collection, QObject *parent)
-  : ImageCollector{parent}, _image(nullptr), _collection(collection)
+  : ImageCollector{parent}, _image(nullptr), _collection(collection),
+    _count(collection->count())
 {
   // pass...
 }
@@ -15,26 +16,40 @@ ImageCollectionAdapter::write(uint32_t address, const QByteArray &payload) {
     logError() << "No image created yet.";
     return false;
   }
-  _image->append(address, payload);
+  if (_journaling)
+    _journal.record(address, payload);
+  else
+    _image->append(address, payload);
   return true;
 }
 
 void
 ImageCollectionAdapter::startProgram() {
+  if (nullptr != _image) {
+    applyJournal(_image);
+    if (_image->updating())
+      _image->endUpdate();
+  }
+
   if ((nullptr == _image) || (0 != _image->count())) {
     logInfo() << "Create new image.";
-    _image = new Image(QString("Codeplug %1").arg(_collection->count()), this);
+    _image = new Image(QString("Codeplug %1").arg(_count), this);
+    _image->setSizeHints(_sizeHints);
   } else {
     logInfo() << "Reuse last image.";
   }
+  _image->beginUpdate();
 }
 
 void
 ImageCollectionAdapter::endProgram() {
   if (nullptr != _image) {
+    applyJournal(_image);
+    _image->endUpdate();
     logInfo() << "Image received.";
-    _collection->append(_image);
+    _collection->appendLater(_image);
     _image = nullptr;
+    _count++;
   }
 }
 
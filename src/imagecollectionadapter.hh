@@ -23,7 +23,10 @@ public slots:
 protected:
   /** The current image (owned). */
   Image *_image;
+  /** The collection, may live within another thread. */
   Collection *_collection;
+  /** Number of images handed to the collection so far. */
+  unsigned int _count;
 };
 
 #endif // IMAGECOLLECTIONADAPTER_HH
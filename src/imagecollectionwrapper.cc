@@ -130,6 +130,8 @@ CollectionWrapper::formatTypeName(const QObject *obj) const {
     return QVariant();
 
   if (auto img = qobject_cast<const Image *>(obj)) {
+    if (img->duplicateOf())
+      return tr("Image (%1), duplicate of '%2'").arg(img->count()).arg(img->duplicateOf()->label());
     return tr("Image (%1)").arg(img->count());
   } else if (auto el = qobject_cast<const Element *>(obj)) {
     if (0 == el->numAnnotations())
@@ -5,12 +5,15 @@
 #include <QActionGroup>
 #include <QToolBar>
 #include <QMessageBox>
+#include <QFileDialog>
 
 #include "device.hh"
 #include "application.hh"
 #include "image.hh"
 #include "logger.hh"
 #include "imagecollectionwrapper.hh"
+#include "imagearchive.hh"
+#include "changemap.hh"
 
 
 
@@ -64,6 +67,8 @@ ImageWidget::ImageWidget(QWidget *parent)
   toolBar->addAction(ui->actionShowHexDiff);
   ui->actionShowHexDump->setIcon(QIcon::fromTheme("show-hexdump"));
   toolBar->addAction(ui->actionShowHexDump);
+  ui->actionShowHeatmap->setIcon(QIcon::fromTheme("show-hexdump"));
+  toolBar->addAction(ui->actionShowHeatmap);
   toolBar->addSeparator();
 
   ui->actionAnnotate->setIcon(QIcon::fromTheme("edit-annotate"));
@@ -74,6 +79,11 @@ ImageWidget::ImageWidget(QWidget *parent)
   toolBar->addSeparator();
 
   toolBar->addAction(ui->actionDeleteImage);
+  toolBar->addSeparator();
+
+  toolBar->addAction(ui->actionOpenArchive);
+  toolBar->addAction(ui->actionSaveArchive);
+  toolBar->addAction(ui->actionExportHeatmap);
 
   qobject_cast<QVBoxLayout*>(layout())->insertWidget(0, toolBar);
 
@@ -84,13 +94,18 @@ ImageWidget::ImageWidget(QWidget *parent)
   connect(this, &ImageWidget::canClearAnnotation, ui->actionClearAnnotation, &QAction::setEnabled);
   connect(this, &ImageWidget::canShowHexDump, ui->actionShowHexDump, &QAction::setEnabled);
   connect(this, &ImageWidget::canShowHexDiff, ui->actionShowHexDiff, &QAction::setEnabled);
+  connect(this, &ImageWidget::canShowHeatmap, ui->actionShowHeatmap, &QAction::setEnabled);
   connect(this, &ImageWidget::canDeleteImage, ui->actionDeleteImage, &QAction::setEnabled);
 
   connect(ui->actionShowHexDump, &QAction::triggered, this, &ImageWidget::onShowHexDump);
   connect(ui->actionShowHexDiff, &QAction::triggered, this, &ImageWidget::onShowHexDiff);
+  connect(ui->actionShowHeatmap, &QAction::triggered, this, &ImageWidget::onShowHeatmap);
   connect(ui->actionAnnotate, &QAction::triggered, this, &ImageWidget::onAnnotate);
   connect(ui->actionClearAnnotation, &QAction::triggered, this, &ImageWidget::onClearAnnotations);
   connect(ui->actionDeleteImage, &QAction::triggered, this, &ImageWidget::onDeleteImage);
+  connect(ui->actionOpenArchive, &QAction::triggered, this, &ImageWidget::onOpenArchive);
+  connect(ui->actionSaveArchive, &QAction::triggered, this, &ImageWidget::onSaveArchive);
+  connect(ui->actionExportHeatmap, &QAction::triggered, this, &ImageWidget::onExportHeatmap);
   connect(app->collection(), &Collection::imageAdded, this, &ImageWidget::onImageReceived);
 }
 
@@ -138,6 +153,7 @@ ImageWidget::onSelectionChanged() {
   emit canAnnotate(countImages > 0);
   emit canShowHexDump((countImages > 0) | (countElements > 0));
   emit canShowHexDiff(countImages > 1);
+  emit canShowHeatmap(countImages > 0);
   emit canClearAnnotation(countImages > 0);
   emit canDeleteImage(countImages > 0);
 }
@@ -195,6 +211,14 @@ ImageWidget::onShowHexDiff() {
 }
 
 
+void
+ImageWidget::onShowHeatmap() {
+  QList<Image *> images = getSelectedImages();
+  for (auto img: images)
+    emit showHeatmap(img);
+}
+
+
 void
 ImageWidget::onImageReceived(unsigned int idx) {
   if (ui->actionOnNewImageShowNone->isChecked())
@@ -244,6 +268,7 @@ ImageWidget::onAnnotate() {
     wrapper->clearAnnotation(idx);
 
     logDebug() << "Annotate image '" << img->label() << "'.";
+    collection->touch(img);
     if (! img->annotate(app->device()->pattern())) {
       logError() << "Annotation failed.";
     }
@@ -283,6 +308,67 @@ ImageWidget::onDeleteImage() {
 }
 
 
+void
+ImageWidget::onOpenArchive() {
+  QSettings settings;
+  QString filename = QFileDialog::getOpenFileName(
+        nullptr, tr("Open archive"), settings.value("archiveFile").toString(),
+        tr("Image archives (*.aea);;All files (*)"));
+  if (filename.isEmpty())
+    return;
+  settings.setValue("archiveFile", filename);
+
+  // Do not show the loaded images, like received ones.
+  Application *app = qobject_cast<Application*>(Application::instance());
+  disconnect(app->collection(), &Collection::imageAdded, this, &ImageWidget::onImageReceived);
+  ErrorStack err;
+  bool ok = ImageArchive::load(filename, app->collection(), err);
+  connect(app->collection(), &Collection::imageAdded, this, &ImageWidget::onImageReceived);
+
+  if (! ok)
+    QMessageBox::critical(nullptr, tr("Cannot open archive"),
+                          tr("Cannot open archive: %1").arg(err.format()));
+}
+
+
+void
+ImageWidget::onSaveArchive() {
+  QSettings settings;
+  QString filename = QFileDialog::getSaveFileName(
+        nullptr, tr("Save archive"), settings.value("archiveFile").toString(),
+        tr("Image archives (*.aea);;All files (*)"));
+  if (filename.isEmpty())
+    return;
+  settings.setValue("archiveFile", filename);
+
+  Application *app = qobject_cast<Application*>(Application::instance());
+  ErrorStack err;
+  if (! ImageArchive::save(filename, app->collection(), true, err))
+    QMessageBox::critical(nullptr, tr("Cannot save archive"),
+                          tr("Cannot save archive: %1").arg(err.format()));
+}
+
+
+void
+ImageWidget::onExportHeatmap() {
+  QSettings settings;
+  QString filename = QFileDialog::getSaveFileName(
+        nullptr, tr("Export heatmap"), settings.value("heatmapFile").toString(),
+        tr("CSV files (*.csv);;All files (*)"));
+  if (filename.isEmpty())
+    return;
+  settings.setValue("heatmapFile", filename);
+
+  // Each image is compared with its predecessor.
+  Application *app = qobject_cast<Application*>(Application::instance());
+  ChangeMap heatmap(app->collection());
+  ErrorStack err;
+  if (! heatmap.save(filename, err))
+    QMessageBox::critical(nullptr, tr("Cannot export heatmap"),
+                          tr("Cannot export heatmap: %1").arg(err.format()));
+}
+
+
 QList<Image *>
 ImageWidget::getSelectedImages() {
   QList<Image *> images;
@@ -23,9 +23,11 @@ signals:
   void showHexImage(const Image *img);
   void showHexElement(const Element *element);
   void showHexDiff(const Image *left, const Image *right);
+  void showHeatmap(const Image *img);
 
   void canShowHexDiff(bool enable);
   void canShowHexDump(bool enable);
+  void canShowHeatmap(bool enable);
   void canAnnotate(bool enable);
   void canClearAnnotation(bool enable);
   void canDeleteImage(bool enable);
@@ -35,10 +37,14 @@ protected slots:
 
   void onShowHexDump();
   void onShowHexDiff();
+  void onShowHeatmap();
   void onImageReceived(unsigned int idx);
   void onAnnotate();
   void onClearAnnotations();
   void onDeleteImage();
+  void onOpenArchive();
+  void onSaveArchive();
+  void onExportHeatmap();
 
 protected:
   QList<Image *> getSelectedImages();
@@ -69,8 +69,13 @@ LogMessageList::headerData(int section, Qt::Orientation orientation, int role) c
 
 void
 LogMessageList::addMessage(const LogMessage &message) {
+  addItem(LogItem(message));
+}
+
+void
+LogMessageList::addItem(const LogItem &item) {
   beginInsertRows(QModelIndex(), 0, 0);
-  _messages.insert(0, LogItem(message));
+  _messages.insert(0, item);
   endInsertRows();
 }
 
@@ -86,8 +91,12 @@ LogHandlerAdapter::LogHandlerAdapter(LogMessageList *list, QObject *parent)
 
 void
 LogHandlerAdapter::handle(const LogMessage &message) {
-  if (_list)
-    _list->addMessage(message);
+  if (nullptr == _list)
+    return;
+  // Messages may originate from the emulation thread, the list is updated within its own thread.
+  LogItem item(message);
+  LogMessageList *list = _list;
+  QMetaObject::invokeMethod(_list, [list, item]() { list->addItem(item); });
 }
 
 void
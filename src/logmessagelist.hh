@@ -31,6 +31,7 @@ public:
 
 public slots:
   void addMessage(const LogMessage &message);
+  void addItem(const LogItem &item);
 
 protected:
   QVector<LogItem> _messages;
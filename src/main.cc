@@ -5,6 +5,7 @@
 #include "device.hh"
 
 #include "imagecollectionadapter.hh"
+#include "image.hh"
 
 #include <QSerialPort>
 #include <QXmlStreamReader>
@@ -49,9 +50,12 @@ main(int argc, char *argv[])
       continue;
     }
 
-    device->setHandler(new ImageCollectionAdapter(app.collection()));
+    auto adapter = new ImageCollectionAdapter(app.collection());
+    adapter->setJournaling(setup.journaling());
+    device->setHandler(adapter);
     app.setCatalog(setup.catalog());
-    app.setDevice(device);
+    app.collection()->setMemoryBudget(setup.memoryBudget());
+    app.setDevice(device, setup.emulationThread());
 
     MainWindow  mainwindow;
     mainwindow.show();
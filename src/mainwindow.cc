@@ -4,6 +4,7 @@
 #include "device.hh"
 #include "image.hh"
 #include "hexdump.hh"
+#include "changemap.hh"
 #include "heximagedumpdocument.hh"
 #include "hexelementdumpdocument.hh"
 #include "heximagediffdocument.hh"
@@ -16,6 +17,7 @@
 #include <QScrollArea>
 #include <QStyleHints>
 #include <QClipboard>
+#include <QThreadPool>
 #include "aboutdialog.hh"
 #include "patternwidget.hh"
 #include "elementpatterneditor.hh"
@@ -66,6 +68,7 @@ MainWindow::MainWindow(QWidget *parent)
   connect(ui->imageWidget, &ImageWidget::showHexImage, this, &MainWindow::onShowHexImage);
   connect(ui->imageWidget, &ImageWidget::showHexElement, this, &MainWindow::onShowHexElement);
   connect(ui->imageWidget, &ImageWidget::showHexDiff, this, &MainWindow::onShowHexDiff);
+  connect(ui->imageWidget, &ImageWidget::showHeatmap, this, &MainWindow::onShowHeatmap);
   connect(ui->patternPage, &PatternWidget::viewPattern, this, &MainWindow::onViewPattern);
   connect(ui->tabs, &QTabWidget::tabCloseRequested, this, &MainWindow::onCloseTab);
   connect(ui->actionAbout, &QAction::triggered, this, &MainWindow::onShowAboutDialog);
@@ -134,6 +137,7 @@ MainWindow::isDarkMode() const {
 
 void
 MainWindow::onShowHexImage(const Image *img) {
+  Application::instance()->collection()->touch(img);
   QTextBrowser *view = new QTextBrowser();
   auto document = new HexImageDumpDocument(isDarkMode(), HexImage(img));
   document->enableDarkMode(isDarkMode());
@@ -143,6 +147,7 @@ MainWindow::onShowHexImage(const Image *img) {
 
 void
 MainWindow::onShowHexElement(const Element *el) {
+  Application::instance()->collection()->touch(qobject_cast<const Image *>(el->parent()));
   QTextBrowser *view = new QTextBrowser();
   auto document = new HexElementDumpDocument(isDarkMode(), HexElement(el));
   document->enableDarkMode(isDarkMode());
@@ -152,12 +157,31 @@ MainWindow::onShowHexElement(const Element *el) {
 
 void
 MainWindow::onShowHexDiff(const Image *left, const Image *right) {
+  Application::instance()->collection()->touch(left);
+  Application::instance()->collection()->touch(right);
   QTextBrowser *view = new QTextBrowser();
-  auto document = new HexImageDiffDocument(isDarkMode(), HexImage(left, right));
+  auto document = new HexImageDiffDocument(isDarkMode(),
+                                           HexImage(left, right, QThreadPool::globalInstance()));
+  // Both images were read back for the diff, this may exceed the memory budget again.
+  Application::instance()->collection()->touch(right);
   view->setDocument(document);
   ui->tabs->addTab(view, QString("%1 vs. %2").arg(left->label()).arg(right->label()));
 }
 
+void
+MainWindow::onShowHeatmap(const Image *img) {
+  // Each image is compared with its predecessor.
+  ChangeMap heatmap(Application::instance()->collection());
+  Application::instance()->collection()->touch(img);
+  QTextBrowser *view = new QTextBrowser();
+  auto document = new HexImageDumpDocument(isDarkMode(), HexImage(img), heatmap);
+  document->enableDarkMode(isDarkMode());
+  view->setDocument(document);
+  ui->tabs->addTab(view, QString("Heatmap of %1").arg(img->label()));
+  logInfo() << "Heatmap of " << heatmap.comparisons() << " comparisons, "
+            << heatmap.changedBytes() << " bytes changed at least once.";
+}
+
 
 void
 MainWindow::onCloseTab(int index) {
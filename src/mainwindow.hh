@@ -29,6 +29,7 @@ private slots:
   void onShowHexImage(const Image *img);
   void onShowHexElement(const Element *element);
   void onShowHexDiff(const Image *left, const Image *right);
+  void onShowHeatmap(const Image *img);
   void onCloseTab(int index=-1);
   void onShowAboutDialog();
   void onViewPattern(ElementPattern *element);
@@ -5,6 +5,7 @@
 #include <QSettings>
 #include <QSerialPortInfo>
 #include <QFileDialog>
+#include <QSpinBox>
 #include "logger.hh"
 
 
@@ -64,6 +65,20 @@ SetupDialog::SetupDialog(QWidget *parent) :
       ui->portSelection->setCurrentIndex(idx);
   }
 
+  ui->emulationThread->setChecked(settings.value("emulationThread", true).toBool());
+  connect(ui->emulationThread, &QCheckBox::toggled, [](bool enabled) {
+    QSettings().setValue("emulationThread", enabled);
+  });
+
+  ui->memoryBudget->setValue(settings.value("memoryBudget", 0).toInt());
+  connect(ui->memoryBudget, &QSpinBox::valueChanged, [](int megabytes) {
+    QSettings().setValue("memoryBudget", megabytes);
+  });
+
+  ui->journaling->setChecked(settings.value("journaling", false).toBool());
+  connect(ui->journaling, &QCheckBox::toggled, [](bool enabled) {
+    QSettings().setValue("journaling", enabled);
+  });
 }
 
 
@@ -86,6 +101,22 @@ SetupDialog::catalog() const {
 }
 
 
+bool
+SetupDialog::emulationThread() const {
+  return ui->emulationThread->isChecked();
+}
+
+qsizetype
+SetupDialog::memoryBudget() const {
+  return qsizetype(ui->memoryBudget->value())*1024*1024;
+}
+
+bool
+SetupDialog::journaling() const {
+  return ui->journaling->isChecked();
+}
+
+
 Device *
 SetupDialog::createDevice(const ErrorStack &err) {
 
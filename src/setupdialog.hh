@@ -25,6 +25,12 @@ public:
   ~SetupDialog() override;
 
   QString catalog() const;
+  /** Returns @c true if the device should be emulated within a dedicated thread. */
+  bool emulationThread() const;
+  /** Returns the memory budget for received codeplugs in bytes, 0 if unlimited. */
+  qsizetype memoryBudget() const;
+  /** Returns @c true if the writes should be recorded into a journal. */
+  bool journaling() const;
   Device *createDevice(const ErrorStack &err=ErrorStack());
 
 public slots:
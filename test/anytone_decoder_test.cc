@@ -0,0 +1,105 @@
+#include "anytone_decoder_test.hh"
+
+#include "framebuffer.hh"
+#include "../plugins/anytone/protocol.hh"
+
+
+/* Write request of 2 bytes to 0x00000100, with valid checksum. */
+static const char writeRequest[] = "W\x00\x00\x01\x00\x02\xab\xcd\x7b\x06";
+static const qsizetype writeRequestLength = 10;
+
+
+AnytoneDecoderTest::AnytoneDecoderTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+AnytoneDecoderTest::keywordTest() {
+  FrameBuffer buffer;
+  AnytoneRequestDecoder decoder;
+  AnytoneRequestFrame frame;
+
+  buffer.append("PROGRAM\x02" "END", 11);
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::Program);
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::DeviceInfo);
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::End);
+  QVERIFY(buffer.isEmpty());
+  QVERIFY(! decoder.decode(buffer, frame));
+}
+
+
+void
+AnytoneDecoderTest::writeTest() {
+  FrameBuffer buffer;
+  AnytoneRequestDecoder decoder;
+  AnytoneRequestFrame frame;
+
+  buffer.append(writeRequest, writeRequestLength);
+  buffer.append("R\x00\x00\x02\x00\x10", 6);
+
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::Write);
+  QCOMPARE(frame.address, 0x00000100U);
+  QCOMPARE(frame.length, uint8_t(2));
+  QCOMPARE(frame.payload, QByteArray("\xab\xcd", 2));
+  QVERIFY(decoder.checksumValid());
+
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::Read);
+  QCOMPARE(frame.address, 0x00000200U);
+  QCOMPARE(frame.length, uint8_t(16));
+  QVERIFY(buffer.isEmpty());
+}
+
+
+void
+AnytoneDecoderTest::partialTest() {
+  FrameBuffer buffer;
+  AnytoneRequestDecoder decoder;
+  AnytoneRequestFrame frame;
+
+  // Feed request byte-by-byte, frame gets completed with the last byte only
+  for (qsizetype i=0; i<(writeRequestLength-1); i++) {
+    buffer.append(writeRequest+i, 1);
+    QVERIFY(! decoder.decode(buffer, frame));
+  }
+  buffer.append(writeRequest+writeRequestLength-1, 1);
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::Write);
+  QCOMPARE(frame.address, 0x00000100U);
+  QCOMPARE(frame.payload, QByteArray("\xab\xcd", 2));
+  QVERIFY(decoder.checksumValid());
+  QVERIFY(buffer.isEmpty());
+}
+
+
+void
+AnytoneDecoderTest::resyncTest() {
+  FrameBuffer buffer;
+  AnytoneRequestDecoder decoder;
+  AnytoneRequestFrame frame;
+
+  // Garbage and broken keywords are skipped
+  buffer.append("\xff" "PX" "ENEND", 8);
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::End);
+  QVERIFY(buffer.isEmpty());
+
+  // Checksum mismatch is reported, but frame is decoded
+  QByteArray broken(writeRequest, writeRequestLength);
+  broken[8] = 0x00;
+  buffer.append(broken);
+  QVERIFY(decoder.decode(buffer, frame));
+  QCOMPARE(frame.type, AnytoneRequestFrame::Type::Write);
+  QVERIFY(! decoder.checksumValid());
+}
+
+
+QTEST_MAIN(AnytoneDecoderTest)
+#include "anytone_decoder_test.moc"
@@ -0,0 +1,20 @@
+#ifndef ANYTONEDECODERTEST_HH
+#define ANYTONEDECODERTEST_HH
+
+#include <QTest>
+
+class AnytoneDecoderTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit AnytoneDecoderTest(QObject *parent = nullptr);
+
+private slots:
+  void keywordTest();
+  void writeTest();
+  void partialTest();
+  void resyncTest();
+};
+
+#endif // ANYTONEDECODERTEST_HH
@@ -0,0 +1,61 @@
+#include "blockcompare_test.hh"
+
+#include "blockcompare.hh"
+
+
+BlockCompareTest::BlockCompareTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+BlockCompareTest::knownTest() {
+  QByteArray left(0x50, 'a'), right = left;
+  right[0x00] = 'b';
+  right[0x3f] = 'b';
+  right[0x4f] = 'b';
+
+  uint64_t bitmap[BlockCompare::bitmapSize(0x50)];
+  QCOMPARE(BlockCompare::compare(left.constData(), right.constData(), left.size(), bitmap),
+           qsizetype(3));
+  QCOMPARE(bitmap[0], uint64_t(0x19));
+
+  // Identical ranges and a shorter last block
+  QCOMPARE(BlockCompare::compare(left.constData(), left.constData(), left.size(), bitmap),
+           qsizetype(0));
+  QCOMPARE(bitmap[0], uint64_t(0));
+  QCOMPARE(BlockCompare::compare(left.constData(), right.constData(), 0x45, bitmap), qsizetype(2));
+  QCOMPARE(bitmap[0], uint64_t(0x09));
+}
+
+
+void
+BlockCompareTest::kernelTest() {
+  QByteArray left(0x1100, '\0');
+  for (int i=0; i<left.size(); i++)
+    left[i] = char(i*37 + (i>>3));
+  QByteArray right = left;
+  for (int i=5; i<right.size(); i+=97)
+    right[i] = ~right[i];
+
+  const BlockCompare::Kernel kernels[] = {
+    BlockCompare::Kernel::Scalar, BlockCompare::Kernel::SSE2, BlockCompare::Kernel::AVX2 };
+  // All kernels must agree for any length
+  for (qsizetype len=0; len<left.size(); len+=29) {
+    QVector<uint64_t> expected(BlockCompare::bitmapSize(len));
+    qsizetype count = BlockCompare::compare(left.constData(), right.constData(), len,
+                                            expected.data(), BlockCompare::Kernel::Scalar);
+    for (auto kernel: kernels) {
+      QVector<uint64_t> bitmap(BlockCompare::bitmapSize(len), ~uint64_t(0));
+      QCOMPARE(BlockCompare::compare(left.constData(), right.constData(), len, bitmap.data(),
+                                     kernel), count);
+      QCOMPARE(bitmap, expected);
+    }
+  }
+}
+
+
+QTEST_MAIN(BlockCompareTest)
+#include "blockcompare_test.moc"
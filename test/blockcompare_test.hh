@@ -0,0 +1,18 @@
+#ifndef BLOCKCOMPARETEST_HH
+#define BLOCKCOMPARETEST_HH
+
+#include <QTest>
+
+class BlockCompareTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit BlockCompareTest(QObject *parent = nullptr);
+
+private slots:
+  void knownTest();
+  void kernelTest();
+};
+
+#endif // BLOCKCOMPARETEST_HH
@@ -0,0 +1,167 @@
+#include "changemap_test.hh"
+
+#include "changemap.hh"
+#include "image.hh"
+#include <QTextStream>
+
+
+/** Returns some content, that is not constant. */
+static QByteArray
+content(qsizetype size) {
+  QByteArray data(size, '\0');
+  for (qsizetype i=0; i<size; i++)
+    data[i] = char(i*37 + (i>>3));
+  return data;
+}
+
+/** Fills the collection with three images. The second one changes the byte at 0x1005, the third
+ * one additionally changes the byte at 0x1010 and adds an element at 0x2000. */
+static void
+series(Collection &collection) {
+  QByteArray data = content(0x20);
+  Image *first = new Image(), *second = new Image(), *third = new Image();
+  first->append(0x1000, data);
+  data[0x05] = ~data[0x05];
+  second->append(0x1000, data);
+  data[0x10] = ~data[0x10];
+  third->append(0x1000, data);
+  third->append(0x2000, content(4));
+  collection.append(first);
+  collection.append(second);
+  collection.append(third);
+}
+
+
+ChangeMapTest::ChangeMapTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+ChangeMapTest::previousTest() {
+  Collection collection;
+  series(collection);
+
+  ChangeMap map(&collection);
+  QCOMPARE(map.comparisons(), 2U);
+  QVERIFY(! map.isEmpty());
+  QCOMPARE(map.count(0x1004), uint16_t(0));
+  QCOMPARE(map.count(0x1005), uint16_t(1));
+  QCOMPARE(map.count(0x1010), uint16_t(1));
+  QCOMPARE(map.count(0x2003), uint16_t(1));
+  QCOMPARE(map.count(0x2004), uint16_t(0));
+  QCOMPARE(map.maxCount(), uint16_t(1));
+  QCOMPARE(map.changedBytes(), qsizetype(6));
+
+  map.clear();
+  QVERIFY(map.isEmpty());
+  QCOMPARE(map.comparisons(), 0U);
+}
+
+
+void
+ChangeMapTest::firstTest() {
+  Collection collection;
+  series(collection);
+
+  ChangeMap map(&collection, ChangeMap::Mode::First);
+  QCOMPARE(map.comparisons(), 2U);
+  QCOMPARE(map.count(0x1005), uint16_t(2));
+  QCOMPARE(map.count(0x1010), uint16_t(1));
+  QCOMPARE(map.count(0x2000), uint16_t(1));
+  QCOMPARE(map.maxCount(), uint16_t(2));
+  QCOMPARE(map.changedBytes(), qsizetype(6));
+
+  // Comparing an image with itself changes nothing
+  ChangeMap same(QVector<const Image *>{ collection.image(1), collection.image(1) });
+  QCOMPARE(same.comparisons(), 1U);
+  QVERIFY(same.isEmpty());
+}
+
+
+void
+ChangeMapTest::pageTest() {
+  // Element spanning several pages, only one byte differs
+  QByteArray data = content(0x3000);
+  Image left, right;
+  left.append(0x10000, data);
+  data[0x1800] = ~data[0x1800];
+  right.append(0x10000, data);
+  // Shorter element crossing a page of counters, the tail of the longer one counts as changed
+  left.append(0x20ff8, content(0x10));
+  right.append(0x20ff8, content(0x20));
+
+  ChangeMap map;
+  map.add(&left, &right);
+  QCOMPARE(map.count(0x11800), uint16_t(1));
+  QCOMPARE(map.count(0x21007), uint16_t(0));
+  QCOMPARE(map.count(0x21008), uint16_t(1));
+  QCOMPARE(map.count(0x21017), uint16_t(1));
+  QCOMPARE(map.changedBytes(), qsizetype(0x11));
+}
+
+
+void
+ChangeMapTest::budgetTest() {
+  Collection collection;
+  collection.setMemoryBudget(3*0x10000);
+  for (int n=0; n<5; n++) {
+    Image *image = new Image();
+    image->append(0x1000, QByteArray(0x10000, char(n)));
+    collection.append(image);
+  }
+  QVERIFY(! collection.image(0)->element(0)->loaded());
+
+  // Evicted images are read back for the analysis and evicted again
+  ChangeMap map(&collection);
+  QCOMPARE(map.count(0x1000), uint16_t(4));
+  QCOMPARE(map.changedBytes(), qsizetype(0x10000));
+  QVERIFY(collection.memoryUsage() <= 3*0x10000);
+}
+
+
+void
+ChangeMapTest::exportTest() {
+  Collection collection;
+  series(collection);
+
+  QString csv;
+  QTextStream stream(&csv);
+  ChangeMap(&collection, ChangeMap::Mode::First).write(stream);
+  stream.flush();
+  QCOMPARE(csv, QString(
+             "address,+0,+1,+2,+3,+4,+5,+6,+7,+8,+9,+a,+b,+c,+d,+e,+f\n"
+             "00001000,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0\n"
+             "00001010,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\n"
+             "00002000,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0\n"));
+}
+
+
+void
+ChangeMapTest::kernelTest() {
+  QByteArray left = content(0x1100), right = left;
+  for (int i=5; i<right.size(); i+=7)
+    right[i] = ~right[i];
+
+  const ChangeMap::Kernel kernels[] = {
+    ChangeMap::Kernel::Scalar, ChangeMap::Kernel::SSE2, ChangeMap::Kernel::AVX2 };
+  // All kernels must agree for any length, counters saturate
+  for (qsizetype len=0; len<left.size(); len+=29) {
+    QVector<uint16_t> expected(len);
+    for (qsizetype i=0; i<len; i++)
+      expected[i] = (0 == (i % 11)) ? 0xffff : uint16_t(i);
+    QVector<uint16_t> initial = expected;
+    ChangeMap::accumulate(left.constData(), right.constData(), len, expected.data(),
+                          ChangeMap::Kernel::Scalar);
+    for (auto kernel: kernels) {
+      QVector<uint16_t> counters = initial;
+      ChangeMap::accumulate(left.constData(), right.constData(), len, counters.data(), kernel);
+      QCOMPARE(counters, expected);
+    }
+  }
+}
+
+
+QTEST_MAIN(ChangeMapTest)
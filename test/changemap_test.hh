@@ -0,0 +1,22 @@
+#ifndef CHANGEMAPTEST_HH
+#define CHANGEMAPTEST_HH
+
+#include <QTest>
+
+class ChangeMapTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ChangeMapTest(QObject *parent = nullptr);
+
+private slots:
+  void previousTest();
+  void firstTest();
+  void pageTest();
+  void budgetTest();
+  void exportTest();
+  void kernelTest();
+};
+
+#endif // CHANGEMAPTEST_HH
@@ -0,0 +1,52 @@
+#include "checksum_test.hh"
+
+#include "checksum.hh"
+
+
+ChecksumTest::ChecksumTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+ChecksumTest::knownTest() {
+  QCOMPARE(Checksum::sum8(nullptr, 0), uint8_t(0));
+  QCOMPARE(Checksum::sum8("\x00\x00\x01\x00\x02\xab\xcd", 7), uint8_t(0x7b));
+  QCOMPARE(Checksum::xor8("\x0f\xf0\x01", 3), uint8_t(0xfe));
+
+  // Sum wraps around
+  QByteArray ones(1028, '\x01');
+  QCOMPARE(Checksum::sum8(ones.constData(), ones.size()), uint8_t(1028 % 256));
+  QCOMPARE(Checksum::xor8(ones.constData(), ones.size()), uint8_t(0));
+}
+
+
+void
+ChecksumTest::kernelTest() {
+  QByteArray data(1100, '\0');
+  for (int i=0; i<data.size(); i++)
+    data[i] = char(i*37 + (i>>3));
+
+  const Checksum::Kernel kernels[] = {
+    Checksum::Kernel::Scalar, Checksum::Kernel::SSE2, Checksum::Kernel::AVX2 };
+  // All kernels must agree for any length and alignment
+  for (qsizetype offset=0; offset<4; offset++) {
+    for (qsizetype len=0; len<(data.size()-offset); len+=13) {
+      const char *ptr = data.constData() + offset;
+      uint8_t sum = Checksum::sum8(ptr, len, Checksum::Kernel::Scalar);
+      uint8_t x = Checksum::xor8(ptr, len, Checksum::Kernel::Scalar);
+      QCOMPARE(Checksum::sum8(ptr, len), sum);
+      QCOMPARE(Checksum::xor8(ptr, len), x);
+      for (auto kernel: kernels) {
+        QCOMPARE(Checksum::sum8(ptr, len, kernel), sum);
+        QCOMPARE(Checksum::xor8(ptr, len, kernel), x);
+      }
+    }
+  }
+}
+
+
+QTEST_MAIN(ChecksumTest)
+#include "checksum_test.moc"
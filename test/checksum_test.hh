@@ -0,0 +1,18 @@
+#ifndef CHECKSUMTEST_HH
+#define CHECKSUMTEST_HH
+
+#include <QTest>
+
+class ChecksumTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ChecksumTest(QObject *parent = nullptr);
+
+private slots:
+  void knownTest();
+  void kernelTest();
+};
+
+#endif // CHECKSUMTEST_HH
@@ -0,0 +1,75 @@
+#include "framebuffer_test.hh"
+
+#include "framebuffer.hh"
+
+
+FrameBufferTest::FrameBufferTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+FrameBufferTest::consumeTest() {
+  FrameBuffer buffer;
+  QVERIFY(buffer.isEmpty());
+
+  buffer.append("PROGRAM", 7);
+  QCOMPARE(buffer.size(), qsizetype(7));
+  QVERIFY(buffer.startsWith("PROG"));
+  QVERIFY(buffer.startsWith('P'));
+
+  buffer.consume(4);
+  QCOMPARE(buffer.size(), qsizetype(3));
+  QVERIFY(buffer.startsWith("RAM"));
+  QCOMPARE(buffer.front(), 'R');
+
+  // Consuming more than available just empties the buffer
+  buffer.consume(10);
+  QVERIFY(buffer.isEmpty());
+  QVERIFY(! buffer.startsWith('R'));
+}
+
+
+void
+FrameBufferTest::viewTest() {
+  FrameBuffer buffer;
+  buffer.append("W\x00\x00\x01\x00\x02\xab\xcd", 8);
+  buffer.consume(1);
+
+  QCOMPARE(buffer.view(0, 4).toByteArray(), QByteArray("\x00\x00\x01\x00", 4));
+  QCOMPARE(buffer.raw(5, 2), QByteArray("\xab\xcd", 2));
+  QCOMPARE(buffer.view().size(), qsizetype(7));
+  // Views refer to the buffer
+  QVERIFY(buffer.raw(5, 2).constData() == (buffer.constData()+5));
+}
+
+
+void
+FrameBufferTest::compactTest() {
+  FrameBuffer buffer;
+
+  // Append a frame and a half, consume the frame
+  buffer.append("0123456789abcdef", 16);
+  buffer.append("01234567", 8);
+  buffer.consume(16);
+  QCOMPARE(buffer.size(), qsizetype(8));
+
+  // Appending reclaims the consumed space but keeps the left-over
+  buffer.append("89abcdef", 8);
+  QCOMPARE(buffer.size(), qsizetype(16));
+  QVERIFY(buffer.startsWith("0123456789abcdef"));
+
+  // Serializing into the storage appends to left-over
+  buffer.consume(12);
+  buffer.buffer().append("XY");
+  QCOMPARE(buffer.view().toByteArray(), QByteArray("cdefXY"));
+
+  buffer.clear();
+  QVERIFY(buffer.isEmpty());
+}
+
+
+QTEST_MAIN(FrameBufferTest)
+#include "framebuffer_test.moc"
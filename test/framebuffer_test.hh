@@ -0,0 +1,19 @@
+#ifndef FRAMEBUFFERTEST_HH
+#define FRAMEBUFFERTEST_HH
+
+#include <QTest>
+
+class FrameBufferTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit FrameBufferTest(QObject *parent = nullptr);
+
+private slots:
+  void consumeTest();
+  void viewTest();
+  void compactTest();
+};
+
+#endif // FRAMEBUFFERTEST_HH
@@ -0,0 +1,234 @@
+#include "hexdump_test.hh"
+
+#include "hexdump.hh"
+#include "image.hh"
+#include <QTextStream>
+#include <QThreadPool>
+
+
+static QByteArray
+pattern(qsizetype size) {
+  QByteArray data(size, '\0');
+  for (qsizetype i=0; i<size; i++)
+    data[i] = char(i*13 + (i>>8));
+  return data;
+}
+
+
+HexDumpTest::HexDumpTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+HexDumpTest::dumpTest() {
+  Element element(Address::fromByte(0x1008), pattern(0x20));
+  HexElement hex(&element);
+
+  QVERIFY(! hex.isDiff());
+  QCOMPARE(hex.size(), 3U);
+  QCOMPARE(hex.line(0).address(), 0x1000U);
+  QCOMPARE(hex.line(0).consumed(), 8U);
+  QCOMPARE(hex.line(0).left(7).type, HexLine::Byte::Unused);
+  QCOMPARE(hex.line(0).left(8).value, uint8_t(0));
+  QCOMPARE(hex.line(2).address(), 0x1020U);
+  QCOMPARE(hex.line(2).consumed(), 8U);
+}
+
+
+void
+HexDumpTest::diffTest() {
+  QByteArray content = pattern(0x40);
+  Element left(Address::fromByte(0x1000), content);
+  content[0x21] = 0;
+  content.append(4, 'x');
+  Element right(Address::fromByte(0x1000), content);
+
+  HexElement hex(&left, &right);
+  QVERIFY(hex.isDiff());
+  QVERIFY(hex.hasDiff());
+
+  QList<uint32_t> changed;
+  for (unsigned int i=0; i<hex.size(); i++) {
+    if (hex.line(i).hasDiff())
+      changed.append(hex.line(i).address());
+  }
+  QCOMPARE(changed, QList<uint32_t>({0x1020, 0x1040}));
+
+  // Removed elements
+  HexElement removed(&left, nullptr);
+  QVERIFY(removed.hasDiff());
+  QCOMPARE(removed.size(), 4U);
+  QCOMPARE(removed.line(0).left(0).type, HexLine::Byte::Remove);
+  QCOMPARE(removed.line(0).right(0).type, HexLine::Byte::Unused);
+}
+
+
+void
+HexDumpTest::pageSkipTest() {
+  QByteArray content = pattern(0x100000);
+  Image left, right;
+  left.append(0x800000, content);
+  content[0x54321] = ~content[0x54321];
+  right.append(0x800000, content);
+
+  HexImage hex(&left, &right);
+  QVERIFY(hex.hasDiff());
+  QCOMPARE(hex.size(), 1U);
+
+  // Only the modified line is created
+  const HexElement &element = hex.element(0);
+  QCOMPARE(element.size(), 1U);
+  QCOMPARE(element.line(0).address(), 0x854320U);
+  QVERIFY(element.line(0).hasDiff());
+
+  // Identical images
+  Image copy;
+  copy.append(0x800000, content);
+  HexImage same(&right, &copy);
+  QVERIFY(! same.hasDiff());
+  QCOMPARE(same.element(0).size(), 0U);
+}
+
+
+void
+HexDumpTest::unalignedDiffTest() {
+  // Lines span page boundaries if the element is not aligned.
+  QByteArray content = pattern(3*Element::PageSize);
+  Element left(Address::fromByte(0x2004), content);
+  content[Element::PageSize-2] = ~content[Element::PageSize-2];
+  content[2*Element::PageSize+1] = ~content[2*Element::PageSize+1];
+  content.append(2, 'x');
+  Element right(Address::fromByte(0x2004), content);
+
+  HexElement hex(&left, &right);
+  QVERIFY(hex.hasDiff());
+
+  QList<uint32_t> changed;
+  for (unsigned int i=0; i<hex.size(); i++) {
+    if (hex.line(i).hasDiff())
+      changed.append(hex.line(i).address());
+  }
+  QCOMPARE(changed, QList<uint32_t>({0x3000, 0x4000, 0x5000}));
+  // Only lines with differences are created
+  QCOMPARE(hex.size(), 3U);
+  // The line at the end of the first page holds bytes of both pages
+  QCOMPARE(hex.line(0).consumed(), 16U);
+}
+
+
+void
+HexDumpTest::streamDumpTest() {
+  Image image;
+  image.append(0x1008, pattern(0x20));
+  image.append(0x2000, pattern(3*Element::PageSize+5));
+
+  QString expected, streamed;
+  QTextStream expectedStream(&expected), streamedStream(&streamed);
+  hexdump(HexImage(&image), expectedStream);
+  hexdump(&image, streamedStream);
+  expectedStream.flush(); streamedStream.flush();
+  QCOMPARE(streamed, expected);
+
+  QStringList lines = streamed.split('\n');
+  QCOMPARE(lines.at(0), "\033[0m00001000 :  " + QString(24, ' ') + "00 0d 1a 27 34 41 4e 5b "
+           + " | " + QString(11, ' ') + "'4AN[");
+  // Elements are separated by an empty line
+  QCOMPARE(lines.at(3), QString());
+  QVERIFY(lines.at(4).startsWith("00002000 :  00 0d 1a "));
+}
+
+void
+HexDumpTest::streamDiffTest() {
+  QByteArray content = pattern(4*Element::PageSize);
+  Image left, right, copy;
+  left.append(0x1000, content);
+  left.append(0x8000, pattern(0x10));
+  content[0x2345] = ~content[0x2345];
+  content.append(3, 'x');
+  right.append(0x1000, content);
+  right.append(0x9004, pattern(0x10));
+  copy.append(0x1000, content);
+  copy.append(0x9004, pattern(0x10));
+
+  QString expected, streamed;
+  QTextStream expectedStream(&expected), streamedStream(&streamed);
+  hexdump(HexImage(&left, &right), expectedStream);
+  QVERIFY(hexdiff(&left, &right, streamedStream, "header:\n"));
+  expectedStream.flush(); streamedStream.flush();
+  QCOMPARE(streamed, "header:\n" + expected);
+
+  QStringList lines = streamed.split('\n');
+  QVERIFY(lines.at(1).startsWith("\033[0m00003340: "));
+  QVERIFY(lines.at(2).startsWith("00005000: "));
+
+  // Nothing is written without any difference
+  QString empty;
+  QTextStream emptyStream(&empty);
+  QVERIFY(! hexdiff(&right, &copy, emptyStream, "header:\n"));
+  emptyStream.flush();
+  QVERIFY(empty.isEmpty());
+}
+
+
+void
+HexDumpTest::parallelDiffTest() {
+  Image left, right;
+  for (uint32_t i=0; i<64; i++) {
+    QByteArray content = pattern(0x100 + 0x40*i);
+    left.append(0x10000*i, content);
+    if (0 == (i % 3))
+      content[0x13] = ~content[0x13];
+    if (5 != i)
+      right.append(0x10000*i + ((7 == i) ? 4 : 0), content);
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  HexImage serial(&left, &right), parallel(&left, &right, &pool);
+  QVERIFY(parallel.hasDiff());
+  QCOMPARE(parallel.size(), serial.size());
+  for (unsigned int i=0; i<serial.size(); i++) {
+    QCOMPARE(parallel.element(i).address(), serial.element(i).address());
+    QCOMPARE(parallel.element(i).size(), serial.element(i).size());
+  }
+
+  QString expected, streamed;
+  QTextStream expectedStream(&expected), streamedStream(&streamed);
+  hexdump(serial, expectedStream);
+  QVERIFY(hexdiff(&left, &right, streamedStream, QString(), &pool));
+  expectedStream.flush(); streamedStream.flush();
+  QCOMPARE(streamed, expected);
+}
+
+
+void
+HexDumpTest::parallelPageDiffTest() {
+  // A single unaligned element of several pages, diffed page-wise in parallel
+  QByteArray content = pattern(8*Element::PageSize + 0x23);
+  Image left, right;
+  left.append(0x10004, content);
+  for (qsizetype offset: {qsizetype(0x0), qsizetype(0xffb), qsizetype(0x1000),
+                          qsizetype(0x3ffc), qsizetype(0x5123), qsizetype(0x7fff)})
+    content[offset] = ~content[offset];
+  // Every byte of a page differs
+  for (qsizetype offset=0x6000; offset<0x7000; offset++)
+    content[offset] = ~content[offset];
+  content.append(pattern(0x15));
+  right.append(0x10004, content);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  QString expected, streamed;
+  QTextStream expectedStream(&expected), streamedStream(&streamed);
+  QVERIFY(hexdiff(&left, &right, expectedStream, "header:\n"));
+  QVERIFY(hexdiff(&left, &right, streamedStream, "header:\n", &pool));
+  expectedStream.flush(); streamedStream.flush();
+  QCOMPARE(streamed, expected);
+}
+
+
+QTEST_MAIN(HexDumpTest)
+#include "hexdump_test.moc"
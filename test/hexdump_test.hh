@@ -0,0 +1,24 @@
+#ifndef HEXDUMPTEST_HH
+#define HEXDUMPTEST_HH
+
+#include <QTest>
+
+class HexDumpTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit HexDumpTest(QObject *parent = nullptr);
+
+private slots:
+  void dumpTest();
+  void diffTest();
+  void pageSkipTest();
+  void unalignedDiffTest();
+  void streamDumpTest();
+  void streamDiffTest();
+  void parallelDiffTest();
+  void parallelPageDiffTest();
+};
+
+#endif // HEXDUMPTEST_HH
@@ -0,0 +1,52 @@
+#include "hexformat_test.hh"
+
+#include "hexformat.hh"
+
+
+HexFormatTest::HexFormatTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+HexFormatTest::formatTest() {
+  const uint8_t bytes[16] = {0x00, 0x0a, 0x1f, 0x20, 0x41, 0x7e, 0x7f, 0x80,
+                             0x9c, 0xab, 0xff, 0x30, 0x39, 0x61, 0x7a, 0x5c};
+  char values[HexFormat::ValuesLength], chars[HexFormat::CharsLength];
+  HexFormat::formatLine(bytes, values, chars, '.');
+  QCOMPARE(QByteArray(values, sizeof(values)),
+           QByteArray("00 0a 1f 20 41 7e 7f 80 9c ab ff 30 39 61 7a 5c "));
+  QCOMPARE(QByteArray(chars, sizeof(chars)), QByteArray("... A~.....09az\\"));
+
+  QCOMPARE(QByteArray(HexFormat::hex(0xc3), 2), QByteArray("c3"));
+  char address[HexFormat::AddressLength];
+  HexFormat::formatAddress(0x0012abcf, address);
+  QCOMPARE(QByteArray(address, sizeof(address)), QByteArray("0012abcf"));
+}
+
+
+void
+HexFormatTest::kernelTest() {
+  const HexFormat::Kernel kernels[] = {
+    HexFormat::Kernel::Scalar, HexFormat::Kernel::SSSE3, HexFormat::Kernel::AVX2 };
+  // All kernels must agree for every byte value at every position
+  for (int round=0; round<256; round++) {
+    uint8_t bytes[16];
+    for (int i=0; i<16; i++)
+      bytes[i] = uint8_t(round + i*17);
+    char refValues[HexFormat::ValuesLength], refChars[HexFormat::CharsLength];
+    HexFormat::formatLine(bytes, refValues, refChars, ' ', HexFormat::Kernel::Scalar);
+    for (auto kernel: kernels) {
+      char values[HexFormat::ValuesLength], chars[HexFormat::CharsLength];
+      HexFormat::formatLine(bytes, values, chars, ' ', kernel);
+      QCOMPARE(QByteArray(values, sizeof(values)), QByteArray(refValues, sizeof(refValues)));
+      QCOMPARE(QByteArray(chars, sizeof(chars)), QByteArray(refChars, sizeof(refChars)));
+    }
+  }
+}
+
+
+QTEST_MAIN(HexFormatTest)
+#include "hexformat_test.moc"
@@ -0,0 +1,18 @@
+#ifndef HEXFORMATTEST_HH
+#define HEXFORMATTEST_HH
+
+#include <QTest>
+
+class HexFormatTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit HexFormatTest(QObject *parent = nullptr);
+
+private slots:
+  void formatTest();
+  void kernelTest();
+};
+
+#endif // HEXFORMATTEST_HH
@@ -0,0 +1,327 @@
+#include "image_test.hh"
+
+#include "image.hh"
+#include "model.hh"
+#include "pagestore.hh"
+#include "hexdump.hh"
+#include "dirtyset.hh"
+#include <QSignalSpy>
+
+
+ImageTest::ImageTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+ImageTest::pageTest() {
+  Image image;
+  QByteArray expected;
+  // Append more than two pages in frames of 16 bytes
+  for (uint32_t address=0; address<(2*Element::PageSize + 0x100); address+=16) {
+    QByteArray frame(16, char(address >> 4));
+    image.append(address, frame);
+    expected.append(frame);
+  }
+
+  QCOMPARE(image.count(), 1U);
+  Element *el = image.element(0);
+  QCOMPARE(el->size(), Size::fromByte(expected.size()));
+  QCOMPARE(el->pageCount(), 3U);
+
+  // Pages cover the content in order
+  QByteArray joined;
+  for (unsigned int i=0; i<el->pageCount(); i++) {
+    joined.append(el->page(i));
+    QCOMPARE(el->pageHash(i), PageStore::hash(el->page(i).data(), el->page(i).size()));
+  }
+  QCOMPARE(joined, expected);
+
+  // Bounded reads span pages without assembling the content
+  QCOMPARE(el->read(Element::PageSize-4, 8), expected.mid(Element::PageSize-4, 8));
+  QCOMPARE(el->read(expected.size()-4, 8), expected.right(4));
+  QCOMPARE(el->read(expected.size(), 8), QByteArray());
+  QCOMPARE(el->at(0x1234), char(0x23));
+  QCOMPARE(el->copySize(), qsizetype(0));
+
+  // Access assembles the content
+  QCOMPARE(el->data(), expected);
+  QCOMPARE(*el->data(Address::fromByte(0x1234)), uint8_t(0x23));
+  QVERIFY(el->copySize() >= expected.size());
+  // Appending releases the assembled content
+  el->append(QByteArray(16, 'x'));
+  expected.append(QByteArray(16, 'x'));
+  QCOMPARE(el->copySize(), qsizetype(0));
+  QCOMPARE(el->data(), expected);
+  el->squeeze();
+  QCOMPARE(el->copySize(), qsizetype(0));
+  QCOMPARE(el->data(), expected);
+}
+
+
+void
+ImageTest::sizeHintTest() {
+  Image image;
+  QMap<uint32_t, uint32_t> hints;
+  hints.insert(0x1000, 0x400);
+  image.setSizeHints(hints);
+  QCOMPARE(image.sizeHint(0x0fff), 0U);
+  QCOMPARE(image.sizeHint(0x1100), 0x300U);
+  QCOMPARE(image.sizeHint(0x1400), 0U);
+
+  // Appending within the hinted block
+  for (uint32_t address=0x1000; address<0x1400; address+=16)
+    image.append(address, QByteArray(16, 'x'));
+  QCOMPARE(image.count(), 1U);
+  QCOMPARE(image.element(0)->pageCount(), 1U);
+  QCOMPARE(image.element(0)->size(), Size::fromByte(0x400));
+}
+
+
+void
+ImageTest::appendOrderTest() {
+  Image image;
+  image.append(0x100, "0123");
+  image.append(0x000, "abcd");
+  // Extends the last touched element, not the last one
+  image.append(0x004, "efgh");
+  // Falls back to search for out-of-order writes
+  image.append(0x0fc, "wxyz");
+  image.append(0x104, "4567");
+
+  QCOMPARE(image.count(), 3U);
+  QCOMPARE(image.element(0)->address(), Address::fromByte(0x000));
+  QCOMPARE(image.element(0)->data(), QByteArray("abcdefgh"));
+  QCOMPARE(image.element(1)->address(), Address::fromByte(0x0fc));
+  QCOMPARE(image.element(2)->address(), Address::fromByte(0x100));
+  QCOMPARE(image.element(2)->data(), QByteArray("01234567"));
+
+  QVERIFY(image.find(Address::fromByte(0x106)) == image.element(2));
+  QVERIFY(image.findPred(Address::fromByte(0x080)) == image.element(0));
+  QVERIFY(nullptr == image.find(Address::fromByte(0x080)));
+}
+
+
+void
+ImageTest::journalTest() {
+  ImageCollector collector;
+  collector.setJournaling(true);
+  collector.setKeepJournal(true);
+  collector.startProgram();
+  QVERIFY(collector.write(0x104, "4567"));
+  QVERIFY(collector.write(0x100, "0123"));
+  QVERIFY(collector.write(0x200, "abcd"));
+  // Rewrite, last write wins
+  QVERIFY(collector.write(0x102, "XY"));
+  // Nothing is assembled while programming
+  QCOMPARE(collector.last()->count(), 0U);
+  collector.endProgram();
+
+  const Image *image = collector.last();
+  QCOMPARE(image->count(), 2U);
+  QCOMPARE(image->element(0)->address(), Address::fromByte(0x100));
+  QCOMPARE(image->element(0)->data(), QByteArray("01XY4567"));
+  QCOMPARE(image->element(1)->data(), QByteArray("abcd"));
+
+  // Journal keeps order and rewrites
+  const WriteJournal &journal = image->journal();
+  QCOMPARE(journal.count(), qsizetype(4));
+  QCOMPARE(journal.entry(0).address, 0x104U);
+  QCOMPARE(journal.entry(3).address, 0x102U);
+  QCOMPARE(journal.payload(journal.entry(3)).toByteArray(), QByteArray("XY"));
+
+  // The journal is dropped by default
+  collector.setKeepJournal(false);
+  collector.startProgram();
+  QVERIFY(collector.write(0x100, "0123"));
+  collector.endProgram();
+  QCOMPARE(collector.last()->element(0)->data(), QByteArray("0123"));
+  QVERIFY(collector.last()->journal().isEmpty());
+}
+
+
+void
+ImageTest::shareTest() {
+  QByteArray content(16*Element::PageSize, '\0');
+  for (int i=0; i<content.size(); i++)
+    content[i] = char(i*7);
+
+  Collection collection;
+  for (int n=0; n<10; n++) {
+    // Captures differ in one byte
+    QByteArray capture(content);
+    capture[5*Element::PageSize + 0x10] = char(n);
+    Image *image = new Image();
+    image->append(0x1000, capture);
+    collection.append(image);
+  }
+
+  const Element *first = collection.image(0)->element(0), *last = collection.image(9)->element(0);
+  // Identical pages are shared
+  QVERIFY(first->page(0).data() == last->page(0).data());
+  QVERIFY(first->page(15).data() == last->page(15).data());
+  QVERIFY(first->page(5).data() != last->page(5).data());
+  QVERIFY(! (*first == *last));
+  QCOMPARE(last->data().at(5*Element::PageSize + 0x10), char(9));
+  QCOMPARE(first->data().left(0x10), content.left(0x10));
+}
+
+
+void
+ImageTest::evictTest() {
+  Collection collection;
+  collection.setMemoryBudget(3*0x10000);
+
+  QVector<QByteArray> contents;
+  for (int n=0; n<5; n++) {
+    // Distinct content, nothing is shared
+    QByteArray content(0x10000, char(n));
+    content[0] = 'x';
+    contents.append(content);
+    Image *image = new Image(QString("image %1").arg(n));
+    image->append(0x1000, content);
+    collection.append(image);
+  }
+
+  QVERIFY(collection.memoryUsage() <= 3*0x10000);
+  // Least recently used are evicted
+  QVERIFY(! collection.image(0)->element(0)->loaded());
+  QVERIFY(! collection.image(1)->element(0)->loaded());
+  QVERIFY(collection.image(4)->element(0)->loaded());
+
+  // Evicted content is read back on access
+  collection.touch(collection.image(0));
+  QCOMPARE(collection.image(0)->element(0)->read(0, 0x10000), contents.at(0));
+  QVERIFY(collection.image(0)->element(0)->loaded());
+
+  // Used recently, others get evicted next
+  collection.touch(collection.image(1));
+  QVERIFY(collection.image(0)->element(0)->loaded());
+  QVERIFY(! collection.image(2)->element(0)->loaded());
+  for (unsigned int i=0; i<collection.count(); i++)
+    QCOMPARE(collection.image(i)->element(0)->read(0, 0x10000), contents.at(i));
+
+  // Unlimited
+  collection.setMemoryBudget(0);
+  QCOMPARE(collection.memoryUsage(), qsizetype(5*0x10000));
+  // Contiguous copies are accounted for
+  collection.image(0)->element(0)->data();
+  QVERIFY(collection.memoryUsage() >= qsizetype(6*0x10000));
+}
+
+
+void
+ImageTest::duplicateTest() {
+  QByteArray content(3*Element::PageSize + 0x20, 'a');
+  Collection collection;
+  for (int n=0; n<3; n++) {
+    Image *image = new Image(QString("image %1").arg(n));
+    image->append(0x1000, content);
+    image->append(0x8000, QByteArray(0x10, char(n/2)));
+    collection.append(image);
+  }
+
+  const Image *first = collection.image(0), *second = collection.image(1),
+      *third = collection.image(2);
+  QCOMPARE(first->digest(), second->digest());
+  QVERIFY(first->digest() != third->digest());
+  QVERIFY(nullptr == first->duplicateOf());
+  QVERIFY(first == second->duplicateOf());
+  QVERIFY(nullptr == third->duplicateOf());
+  // Duplicates are not compared
+  QCOMPARE(HexImage(first, second).size(), 0U);
+  QVERIFY(HexImage(second, third).hasDiff());
+
+  // Further duplicates refer to the original
+  Image *fourth = new Image("image 3");
+  fourth->append(0x1000, content);
+  fourth->append(0x8000, QByteArray(0x10, 0));
+  collection.append(fourth);
+  QVERIFY(first == fourth->duplicateOf());
+
+  // Once the original is deleted, the oldest duplicate takes its place
+  collection.deleteImage(0);
+  QVERIFY(nullptr == second->duplicateOf());
+  QVERIFY(second == fourth->duplicateOf());
+
+  // Deleting a duplicate keeps the original
+  collection.deleteImage(collection.indexOf(fourth));
+  Image *fifth = new Image("image 4");
+  fifth->append(0x1000, content);
+  fifth->append(0x8000, QByteArray(0x10, 0));
+  collection.append(fifth);
+  QVERIFY(second == fifth->duplicateOf());
+}
+
+
+void
+ImageTest::dirtySetTest() {
+  DirtySet set;
+  QVERIFY(set.isEmpty());
+
+  // Sequential ranges coalesce
+  for (uint32_t address=0x1000; address<0x2000; address+=0x10)
+    set.add(address, 0x10);
+  QCOMPARE(set.count(), qsizetype(1));
+  QCOMPARE(set.range(0).address, 0x1000U);
+  QCOMPARE(set.range(0).size, 0x1000U);
+
+  // Disjoint ranges are kept sorted
+  set.add(0x3000, 0x10);
+  set.add(0x0100, 0x10);
+  QCOMPARE(set.count(), qsizetype(3));
+  QCOMPARE(set.range(0).address, 0x0100U);
+  QCOMPARE(set.range(2).address, 0x3000U);
+  QVERIFY(set.contains(0x3008));
+  QVERIFY(! set.contains(0x3010));
+  QVERIFY(! set.contains(0x2000));
+
+  // Bridging range merges all touched ranges
+  set.add(0x0110, 0x2ef0);
+  QCOMPARE(set.count(), qsizetype(1));
+  QCOMPARE(set.range(0).address, 0x0100U);
+  QCOMPARE(set.range(0).end(), uint64_t(0x3010));
+  QCOMPARE(set.bytes(), uint64_t(0x2f10));
+}
+
+
+void
+ImageTest::updateTest() {
+  Image image;
+  QSignalSpy updated(&image, &Image::updated);
+  QSignalSpy added(&image, &Image::modified);
+
+  // Outside of an update scope, every modification is announced
+  image.append(0x1000, QByteArray(0x10, 'a'));
+  image.append(0x1010, QByteArray(0x10, 'a'));
+  QCOMPARE(updated.count(), 2);
+  QCOMPARE(added.count(), 1);
+
+  updated.clear(); added.clear();
+  QSignalSpy elementModified(image.element(0), &Element::modified);
+  image.beginUpdate();
+  QVERIFY(image.updating());
+  for (uint32_t address=0x1020; address<0x3000; address+=0x10)
+    image.append(address, QByteArray(0x10, 'b'));
+  image.append(0x8000, QByteArray(0x10, 'c'));
+  QCOMPARE(updated.count(), 0);
+  QCOMPARE(added.count(), 0);
+  QCOMPARE(elementModified.count(), 0);
+  image.endUpdate();
+  QVERIFY(! image.updating());
+
+  // Single, coalesced notification
+  QCOMPARE(updated.count(), 1);
+  QCOMPARE(elementModified.count(), 1);
+  DirtySet ranges = updated.at(0).at(0).value<DirtySet>();
+  QCOMPARE(ranges.count(), qsizetype(2));
+  QCOMPARE(ranges.range(0).address, 0x1020U);
+  QCOMPARE(ranges.range(0).end(), uint64_t(0x3000));
+  QCOMPARE(ranges.range(1).address, 0x8000U);
+}
+
+
+QTEST_MAIN(ImageTest)
+#include "image_test.moc"
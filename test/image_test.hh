@@ -0,0 +1,25 @@
+#ifndef IMAGETEST_HH
+#define IMAGETEST_HH
+
+#include <QTest>
+
+class ImageTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ImageTest(QObject *parent = nullptr);
+
+private slots:
+  void pageTest();
+  void sizeHintTest();
+  void appendOrderTest();
+  void journalTest();
+  void shareTest();
+  void evictTest();
+  void duplicateTest();
+  void dirtySetTest();
+  void updateTest();
+};
+
+#endif // IMAGETEST_HH
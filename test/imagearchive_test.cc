@@ -0,0 +1,177 @@
+#include "imagearchive_test.hh"
+
+#include "imagearchive.hh"
+#include "image.hh"
+#include <QTemporaryDir>
+#include <QFile>
+#include <QtEndian>
+
+
+static Image *
+createImage(const QString &label, char fill) {
+  Image *image = new Image(label);
+  QByteArray content(3*Element::PageSize + 0x10, fill);
+  for (int i=0; i<content.size(); i+=0x100)
+    content[i] = char(i >> 8);
+  image->append(0x00800000, content);
+  image->append(0x02fa0000, QByteArray(0x40, 'x'));
+  return image;
+}
+
+template <typename T>
+static void
+appendLE(QByteArray &buffer, T value) {
+  uchar bytes[sizeof(T)];
+  qToLittleEndian<T>(value, bytes);
+  buffer.append((const char *)bytes, sizeof(T));
+}
+
+
+ImageArchiveTest::ImageArchiveTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+ImageArchiveTest::roundTripTest_data() {
+  QTest::addColumn<bool>("compress");
+  QTest::newRow("plain") << false;
+  QTest::newRow("compressed") << true;
+}
+
+void
+ImageArchiveTest::roundTripTest() {
+  QFETCH(bool, compress);
+  QTemporaryDir dir;
+  QString filename = dir.filePath("images.aea");
+
+  Image *first = createImage("first", 'a'), *second = createImage("second", 'b');
+  ErrorStack err;
+  QVERIFY2(ImageArchive::save(filename, {first, second}, compress, err), err.format().toLocal8Bit());
+
+  QVector<Image *> images;
+  QVERIFY2(ImageArchive::load(filename, images, err), err.format().toLocal8Bit());
+  QCOMPARE(images.size(), 2);
+  QCOMPARE(images.at(0)->label(), QString("first"));
+  QCOMPARE(images.at(1)->label(), QString("second"));
+  QCOMPARE(images.at(1)->count(), 2U);
+  for (unsigned int i=0; i<2; i++) {
+    QVERIFY(*images.at(0)->element(i) == *first->element(i));
+    QVERIFY(*images.at(1)->element(i) == *second->element(i));
+  }
+
+  qDeleteAll(images);
+  delete first; delete second;
+}
+
+
+void
+ImageArchiveTest::lazyLoadTest() {
+  QTemporaryDir dir;
+  QString filename = dir.filePath("images.aea");
+  Image *image = createImage("image", 'c');
+  ErrorStack err;
+  QVERIFY(ImageArchive::save(filename, {image}, false, err));
+
+  Collection collection;
+  QVERIFY(ImageArchive::load(filename, &collection, err));
+  QCOMPARE(collection.count(), 1U);
+
+  // Only the index is read
+  const Image *loaded = collection.image(0);
+  QCOMPARE(loaded->count(), 2U);
+  QCOMPARE(loaded->element(0)->address(), Address::fromByte(0x00800000));
+  QCOMPARE(loaded->element(0)->size(), image->element(0)->size());
+  QVERIFY(! loaded->element(0)->loaded());
+  QVERIFY(! loaded->element(1)->loaded());
+
+  // Content is read on access
+  QCOMPARE(*loaded->data(0x02fa0010), uint8_t('x'));
+  QVERIFY(loaded->element(1)->loaded());
+  QVERIFY(! loaded->element(0)->loaded());
+  QCOMPARE(loaded->element(0)->data(), image->element(0)->data());
+
+  delete image;
+}
+
+
+void
+ImageArchiveTest::overwriteTest() {
+  QTemporaryDir dir;
+  QString filename = dir.filePath("images.aea");
+  Image *image = createImage("image", 'd');
+  ErrorStack err;
+  QVERIFY(ImageArchive::save(filename, {image}, false, err));
+
+  // Save over the mapped archive, before its content was read
+  QVector<Image *> images;
+  QVERIFY(ImageArchive::load(filename, images, err));
+  Image *other = createImage("other", 'e');
+  QVERIFY(ImageArchive::save(filename, {other}, false, err));
+  QCOMPARE(images.at(0)->element(0)->data(), image->element(0)->data());
+
+  // Archive loaded images again
+  QVERIFY(ImageArchive::save(filename, {images.at(0), other}, true, err));
+  QVector<Image *> reloaded;
+  QVERIFY(ImageArchive::load(filename, reloaded, err));
+  QCOMPARE(reloaded.size(), 2);
+  QCOMPARE(reloaded.at(0)->element(0)->data(), image->element(0)->data());
+  QCOMPARE(reloaded.at(1)->label(), QString("other"));
+
+  qDeleteAll(images); qDeleteAll(reloaded);
+  delete image; delete other;
+}
+
+
+void
+ImageArchiveTest::invalidTest() {
+  QTemporaryDir dir;
+  QVector<Image *> images;
+
+  QVERIFY(! ImageArchive::load(dir.filePath("missing.aea"), images));
+
+  QFile garbage(dir.filePath("garbage.aea"));
+  QVERIFY(garbage.open(QIODevice::WriteOnly));
+  garbage.write(QByteArray(64, 'x'));
+  garbage.close();
+  QVERIFY(! ImageArchive::load(garbage.fileName(), images));
+
+  // Truncated archive
+  QString filename = dir.filePath("images.aea");
+  Image *image = createImage("image", 'f');
+  QVERIFY(ImageArchive::save(filename, {image}, false));
+  QFile truncated(filename);
+  QVERIFY(truncated.resize(truncated.size() - 20));
+  QVERIFY(! ImageArchive::load(filename, images));
+  QVERIFY(images.isEmpty());
+
+  // Payload offset wrapping around beyond the index
+  QByteArray archive("AEIMAGES", 8);
+  appendLE<quint16>(archive, 1);
+  appendLE<quint16>(archive, ImageArchive::None);
+  archive.append(QByteArray(0x20, 'p'));
+  quint64 indexOffset = archive.size();
+  appendLE<quint32>(archive, 1);
+  appendLE<quint16>(archive, 1);
+  archive.append('x');
+  appendLE<quint32>(archive, 1);
+  appendLE<quint32>(archive, 0x1000);
+  appendLE<quint32>(archive, 0x20);
+  appendLE<quint64>(archive, 0xfffffffffffffff0ULL);
+  appendLE<quint32>(archive, 0x20);
+  appendLE<quint64>(archive, indexOffset);
+  QFile corrupt(dir.filePath("corrupt.aea"));
+  QVERIFY(corrupt.open(QIODevice::WriteOnly));
+  corrupt.write(archive);
+  corrupt.close();
+  QVERIFY(! ImageArchive::load(corrupt.fileName(), images));
+  QVERIFY(images.isEmpty());
+
+  delete image;
+}
+
+
+QTEST_MAIN(ImageArchiveTest)
+#include "imagearchive_test.moc"
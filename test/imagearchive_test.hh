@@ -0,0 +1,21 @@
+#ifndef IMAGEARCHIVETEST_HH
+#define IMAGEARCHIVETEST_HH
+
+#include <QTest>
+
+class ImageArchiveTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ImageArchiveTest(QObject *parent = nullptr);
+
+private slots:
+  void roundTripTest_data();
+  void roundTripTest();
+  void lazyLoadTest();
+  void overwriteTest();
+  void invalidTest();
+};
+
+#endif // IMAGEARCHIVETEST_HH
@@ -0,0 +1,114 @@
+#include "modelrom_test.hh"
+
+#include "modelrom.hh"
+#include <QRandomGenerator>
+
+
+ModelRomTest::ModelRomTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+ModelRomTest::readTest() {
+  ModelRom rom;
+  rom.write(0x100, "0123456789abcdef");
+
+  QByteArray data;
+  QVERIFY(rom.read(0x104, 4, data));
+  QCOMPARE(data, QByteArray("4567"));
+  // Reads are views into the ROM
+  QByteArray other;
+  QVERIFY(rom.read(0x104, 2, other));
+  QVERIFY(data.constData() == other.constData());
+
+  // Unmapped or partially mapped memory cannot be read
+  QVERIFY(! rom.read(0x0fc, 8, data));
+  QVERIFY(! rom.read(0x10c, 8, data));
+  QVERIFY(! rom.read(0x200, 1, data));
+}
+
+
+void
+ModelRomTest::coalesceTest() {
+  ModelRom rom;
+  rom.write(0x100, "0123");
+  rom.write(0x108, "89ab");
+  QCOMPARE(rom.segmentCount(), 2U);
+
+  // Filling the gap merges all segments, reads across former segments work
+  rom.write(0x104, "4567");
+  QCOMPARE(rom.segmentCount(), 1U);
+  QByteArray data;
+  QVERIFY(rom.read(0x102, 8, data));
+  QCOMPARE(data, QByteArray("23456789"));
+
+  // Overlapping writes override and extend
+  rom.write(0x0fe, "XY01");
+  rom.write(0x10a, "ABCD");
+  QCOMPARE(rom.segmentCount(), 1U);
+  QVERIFY(rom.read(0x0fe, 16, data));
+  QCOMPARE(data, QByteArray("XY0123456789ABCD"));
+
+  // Copies are not affected by writes
+  ModelRom copy(rom);
+  rom.write(0x100, "zz");
+  QVERIFY(copy.read(0x100, 2, data));
+  QCOMPARE(data, QByteArray("01"));
+}
+
+
+void
+ModelRomTest::pageTest() {
+  ModelRom rom;
+  // Many small segments, one per page (like MD-32UV meta flags)
+  for (uint32_t page=0; page<0x10; page++)
+    rom.write(page*ModelRom::PageSize + ModelRom::PageSize-1, QByteArray(1, char(page)));
+  // Segment spanning several pages
+  rom.write(0x20000 - 2, QByteArray(3*ModelRom::PageSize, 'x'));
+  QCOMPARE(rom.segmentCount(), 17U);
+
+  QByteArray data;
+  for (uint32_t page=0; page<0x10; page++) {
+    QVERIFY(rom.read(page*ModelRom::PageSize + ModelRom::PageSize-1, 1, data));
+    QCOMPARE(data.at(0), char(page));
+    QVERIFY(! rom.read(page*ModelRom::PageSize, 1, data));
+  }
+  QVERIFY(rom.read(0x20000 - 2, 4, data));
+  QVERIFY(rom.read(0x21ffe, 4, data));
+  QCOMPARE(data, QByteArray("xxxx"));
+}
+
+
+void
+ModelRomTest::randomWriteTest() {
+  // The page index is updated incrementally, compare all reads against a flat reference.
+  ModelRom rom;
+  QByteArray reference(0x40000 + 0x3000, '\0');
+  QByteArray mapped(reference.size(), '\0');
+  QRandomGenerator rng(1);
+  for (int w=0; w<500; w++) {
+    uint32_t address = rng.bounded(0x40000);
+    int length = 1 + ((0 == rng.bounded(4)) ? rng.bounded(0x3000) : rng.bounded(64));
+    QByteArray data(length, char('a' + (w % 26)));
+    rom.write(address, data);
+    reference.replace(address, length, data);
+    mapped.replace(address, length, QByteArray(length, '\1'));
+  }
+
+  QByteArray data;
+  for (uint32_t address=0; address<uint32_t(reference.size()); address+=7) {
+    if (mapped.at(address)) {
+      QVERIFY(rom.read(address, 1, data));
+      QCOMPARE(data.at(0), reference.at(address));
+    } else {
+      QVERIFY(! rom.read(address, 1, data));
+    }
+  }
+}
+
+
+QTEST_MAIN(ModelRomTest)
+#include "modelrom_test.moc"
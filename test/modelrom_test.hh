@@ -0,0 +1,20 @@
+#ifndef MODELROMTEST_HH
+#define MODELROMTEST_HH
+
+#include <QTest>
+
+class ModelRomTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ModelRomTest(QObject *parent = nullptr);
+
+private slots:
+  void readTest();
+  void coalesceTest();
+  void pageTest();
+  void randomWriteTest();
+};
+
+#endif // MODELROMTEST_HH
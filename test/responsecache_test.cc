@@ -0,0 +1,67 @@
+#include "responsecache_test.hh"
+
+#include "responsecache.hh"
+#include "modelrom.hh"
+
+
+ResponseCacheTest::ResponseCacheTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+ResponseCacheTest::hitTest() {
+  ModelRom rom;
+  rom.write(0x100, QByteArray(16, 'a'));
+  ResponseCache cache;
+
+  QVERIFY(nullptr == cache.find(rom, 0x100, 16));
+  cache.insert(rom, 0x100, 16, "response");
+  QVERIFY(nullptr != cache.find(rom, 0x100, 16));
+  QCOMPARE(*cache.find(rom, 0x100, 16), QByteArray("response"));
+  // Key includes the length
+  QVERIFY(nullptr == cache.find(rom, 0x100, 8));
+  QCOMPARE(cache.hits(), uint64_t(2));
+  QCOMPARE(cache.misses(), uint64_t(2));
+}
+
+
+void
+ResponseCacheTest::invalidateTest() {
+  ModelRom rom;
+  rom.write(0x100, QByteArray(16, 'a'));
+  ResponseCache cache;
+  cache.insert(rom, 0x100, 16, "response");
+
+  // Copies share the content stamp
+  ModelRom copy(rom);
+  QCOMPARE(copy.generation(), rom.generation());
+  QVERIFY(nullptr != cache.find(copy, 0x100, 16));
+
+  // Writing to the ROM drops the cached responses
+  rom.write(0x200, QByteArray(16, 'b'));
+  QVERIFY(copy.generation() != rom.generation());
+  QVERIFY(nullptr == cache.find(rom, 0x100, 16));
+}
+
+
+void
+ResponseCacheTest::capacityTest() {
+  ModelRom rom;
+  ResponseCache cache(16);
+
+  cache.insert(rom, 0x000, 10, QByteArray(10, 'x'));
+  cache.insert(rom, 0x010, 10, QByteArray(10, 'y'));
+  // Cache got cleared before inserting the second response
+  QVERIFY(nullptr == cache.find(rom, 0x000, 10));
+  QVERIFY(nullptr != cache.find(rom, 0x010, 10));
+  // Responses exceeding the capacity are not cached
+  cache.insert(rom, 0x020, 32, QByteArray(32, 'z'));
+  QVERIFY(nullptr == cache.find(rom, 0x020, 32));
+}
+
+
+QTEST_MAIN(ResponseCacheTest)
+#include "responsecache_test.moc"
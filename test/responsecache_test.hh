@@ -0,0 +1,19 @@
+#ifndef RESPONSECACHETEST_HH
+#define RESPONSECACHETEST_HH
+
+#include <QTest>
+
+class ResponseCacheTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ResponseCacheTest(QObject *parent = nullptr);
+
+private slots:
+  void hitTest();
+  void invalidateTest();
+  void capacityTest();
+};
+
+#endif // RESPONSECACHETEST_HH
@@ -0,0 +1,94 @@
+#include "sessiontrace_test.hh"
+
+#include "sessiontrace.hh"
+#include "sessionreplay.hh"
+#include <QBuffer>
+
+
+SessionTraceTest::SessionTraceTest(QObject *parent)
+  : QObject{parent}
+{
+  // pass...
+}
+
+
+void
+SessionTraceTest::roundTripTest() {
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  QVERIFY(SessionTrace::writeHeader(&buffer, "d878uv", "V1.00"));
+  QVERIFY(SessionTrace::writeRecord(&buffer, SessionTrace::Direction::Request, 10, "PROGRAM", 7));
+  QVERIFY(SessionTrace::writeRecord(&buffer, SessionTrace::Direction::Response, 5, "QX\x06", 3));
+  buffer.close();
+
+  buffer.open(QIODevice::ReadOnly);
+  SessionTrace trace;
+  ErrorStack err;
+  if (! trace.read(&buffer, err))
+    QFAIL(err.format().toLocal8Bit().constData());
+
+  QCOMPARE(trace.model(), QString("d878uv"));
+  QCOMPARE(trace.firmware(), QString("V1.00"));
+  QCOMPARE(trace.count(), qsizetype(2));
+  QVERIFY(SessionTrace::Direction::Request == trace.record(0).direction);
+  QCOMPARE(trace.record(0).timestamp, qint64(10));
+  QCOMPARE(trace.record(0).data, QByteArray("PROGRAM"));
+  QVERIFY(SessionTrace::Direction::Response == trace.record(1).direction);
+  QCOMPARE(trace.record(1).timestamp, qint64(15));
+  QCOMPARE(trace.record(1).data, QByteArray("QX\x06"));
+}
+
+
+void
+SessionTraceTest::recorderTest() {
+  auto interface = new ReplayInterface();
+  auto traceBuffer = new QBuffer();
+  traceBuffer->open(QIODevice::WriteOnly);
+
+  SessionRecorder recorder(interface, traceBuffer, "md32uv", "latest");
+  QVERIFY(recorder.open(QIODevice::ReadWrite));
+
+  interface->feed("PSEARCH");
+  QCOMPARE(recorder.bytesAvailable(), qint64(7));
+  QCOMPARE(recorder.readAll(), QByteArray("PSEARCH"));
+  QCOMPARE(recorder.write("\x06", 1), qint64(1));
+  QCOMPARE(interface->take(), QByteArray("\x06"));
+
+  QBuffer buffer;
+  buffer.setData(traceBuffer->data());
+  buffer.open(QIODevice::ReadOnly);
+  SessionTrace trace;
+  QVERIFY(trace.read(&buffer));
+  QCOMPARE(trace.model(), QString("md32uv"));
+  QCOMPARE(trace.count(), qsizetype(2));
+  QVERIFY(SessionTrace::Direction::Request == trace.record(0).direction);
+  QCOMPARE(trace.record(0).data, QByteArray("PSEARCH"));
+  QVERIFY(SessionTrace::Direction::Response == trace.record(1).direction);
+  QCOMPARE(trace.record(1).data, QByteArray("\x06"));
+}
+
+
+void
+SessionTraceTest::invalidTest() {
+  QBuffer buffer;
+  buffer.setData(QByteArray("NOTATRACE"));
+  buffer.open(QIODevice::ReadOnly);
+  SessionTrace trace;
+  QVERIFY(! trace.read(&buffer));
+
+  // Truncated record
+  QBuffer truncated;
+  truncated.open(QIODevice::WriteOnly);
+  SessionTrace::writeHeader(&truncated, "d878uv", "V1.00");
+  SessionTrace::writeRecord(&truncated, SessionTrace::Direction::Request, 0, "PROGRAM", 7);
+  truncated.close();
+  QByteArray data = truncated.data();
+  data.chop(3);
+  truncated.setData(data);
+  truncated.open(QIODevice::ReadOnly);
+  QVERIFY(! trace.read(&truncated));
+}
+
+
+QTEST_MAIN(SessionTraceTest)
+#include "sessiontrace_test.moc"
@@ -0,0 +1,19 @@
+#ifndef SESSIONTRACETEST_HH
+#define SESSIONTRACETEST_HH
+
+#include <QTest>
+
+class SessionTraceTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit SessionTraceTest(QObject *parent = nullptr);
+
+private slots:
+  void roundTripTest();
+  void recorderTest();
+  void invalidTest();
+};
+
+#endif // SESSIONTRACETEST_HH